@@ -89,6 +89,42 @@ asio::awaitable<void> system_role_example(openai::Client& client) {
             fmt::print("Exception: {}\n", e.what());
         }
     }
+    
+    // Example 4: Cached classification template
+    fmt::print("\n--- Cached Classification ---\n");
+    {
+        // Deterministic prompts can be answered from a cache after the first call
+        auto cache = std::make_shared<openai::ResponseCache>();
+        client.set_response_cache(cache);
+        
+        openai::ChatCompletionRequest request;
+        request.model = "gpt-3.5-turbo";
+        request.max_tokens = 5;
+        request.temperature = 0.0f;
+        
+        openai::Message system_msg;
+        system_msg.role = openai::MessageRole::System;
+        system_msg.content = "Classify the sentiment of the text as positive, negative or neutral. Reply with one word.";
+        request.messages.push_back(system_msg);
+        
+        openai::Message user_msg;
+        user_msg.role = openai::MessageRole::User;
+        user_msg.content = "The service was quick and the staff were lovely.";
+        request.messages.push_back(user_msg);
+        
+        try {
+            for (int i = 0; i < 3; ++i) {
+                auto response = co_await client.create_chat_completion(request);
+                if (response.has_value() && !response.value().choices.empty()) {
+                    fmt::print("Sentiment: {}\n", response.value().choices[0].message.content);
+                }
+            }
+            fmt::print("Cache hit rate: {:.0f}%\n", cache->metrics().hit_rate() * 100.0);
+        } catch (const std::exception& e) {
+            fmt::print("Exception: {}\n", e.what());
+        }
+        client.set_response_cache(nullptr);
+    }
 }
 
 int main() {
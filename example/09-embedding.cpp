@@ -49,7 +49,73 @@ asio::awaitable<void> embedding_example(openai::Client& client) {
         
         fmt::print("Usage:\n");
         fmt::print("  Total tokens: {}\n\n", response.value().usage.total_tokens);
+
+        // Compact transfer: base64 float32 is ~4x smaller than decimal text
+        // and decodes straight into the same std::vector<float>
+        fmt::print("--- base64 Encoding with Reduced Dimensions ---\n");
+        openai::EmbeddingRequest compact;
+        compact.model = "text-embedding-3-small";
+        compact.input = request.input;
+        compact.encoding_format = "base64";
+        compact.dimensions = 256;
+
+        auto compact_response = co_await client.create_embedding(compact);
+        if (!compact_response.has_value()) {
+            fmt::print("Error: {}\n\n", compact_response.error().to_string());
+        } else if (!compact_response.value().data.empty()) {
+            fmt::print("  Dimensions: {}\n\n", compact_response.value().data[0].embedding.size());
+        }
         
+        // Array input: one request, one embedding per text (matched by index)
+        fmt::print("--- Batch Input ---\n");
+        openai::EmbeddingRequest batch;
+        batch.model = "text-embedding-3-small";
+        batch.input = {"first document", "second document", "third document"};
+
+        auto batch_response = co_await client.create_embedding(batch);
+        if (!batch_response.has_value()) {
+            fmt::print("Error: {}\n\n", batch_response.error().to_string());
+        } else {
+            for (const auto& item : batch_response.value().data) {
+                fmt::print("  [{}] \"{}\": {} dimensions\n",
+                    item.index, batch.input.texts[item.index], item.embedding.size());
+            }
+            fmt::print("\n");
+        }
+
+        // Contiguous matrix result, optionally quantized for resident caches
+        fmt::print("--- Matrix Result ---\n");
+        auto matrix_response = co_await client.create_embedding_matrix(batch);
+        if (!matrix_response.has_value()) {
+            fmt::print("Error: {}\n\n", matrix_response.error().to_string());
+        } else {
+            auto& matrix = matrix_response.value().matrix;
+            matrix.normalize();
+            openai::QuantizedEmbeddingMatrix compact_matrix(matrix, openai::EmbeddingPrecision::Int8);
+            fmt::print("  {} x {} float32: {} bytes, int8: {} bytes\n",
+                matrix.rows(), matrix.dimensions(), matrix.bytes(), compact_matrix.bytes());
+            float cosine = std::inner_product(matrix[0].begin(), matrix[0].end(), matrix[1].begin(), 0.0f);
+            fmt::print("  cosine(first, second) = {:.4f} (int8: {:.4f})\n\n",
+                cosine, compact_matrix.dot(1, matrix[0]));
+        }
+
+        // Content-addressed cache: repeated texts are answered without a request
+        fmt::print("--- Cached Embeddings ---\n");
+        auto cache = std::make_shared<openai::EmbeddingCache>(openai::EmbeddingCacheOptions{
+            .path = (std::filesystem::temp_directory_path() / "openai-embeddings.cache").string()});
+        client.set_embedding_cache(cache);
+        for (int pass = 1; pass <= 2; ++pass) {
+            auto cached = co_await client.create_embedding(batch);
+            if (cached.has_value()) {
+                fmt::print("  pass {}: {} vectors, {} tokens billed\n",
+                    pass, cached.value().data.size(), cached.value().usage.total_tokens);
+            }
+        }
+        const auto& stats = cache->metrics();
+        fmt::print("  hits: {} memory, {} disk; misses: {}; store: {} bytes\n\n",
+            stats.memory_hits.load(), stats.disk_hits.load(), stats.misses.load(), stats.disk_bytes.load());
+        client.set_embedding_cache(nullptr);
+
         fmt::print(R"(
 Use cases:
   1. Semantic Search: Find similar documents
@@ -77,6 +143,11 @@ int main() {
     
     asio::io_context io_context;
     openai::Client client(api_key, io_context);
+
+    // Concurrent single-text calls issued within 5 ms are merged into one request
+    openai::EmbeddingCoalescingOptions coalescing;
+    coalescing.enabled = true;
+    client.set_embedding_coalescing(coalescing);
     
     asio::co_spawn(io_context, embedding_example(client), asio::detached);
     io_context.run();
@@ -64,6 +64,8 @@ asio::awaitable<void> files_example(openai::Client& client) {
         fmt::print("  - client.list_files()            // List all files\n");
         fmt::print("  - client.retrieve_file(file_id)  // Get file info\n");
         fmt::print("  - client.delete_file(file_id)    // Delete a file\n");
+        fmt::print("  - client.download_file_content(file_id, path, on_progress)  // Stream to disk\n");
+        fmt::print("  - client.read_file_lines(file_id, on_line)                  // Stream JSONL records\n");
         
     } catch (const std::exception& e) {
         fmt::print("Exception: {}\n", e.what());
@@ -0,0 +1,103 @@
+// Example 14: Streaming Chat Completion
+// Demonstrates token streaming over Server-Sent Events and tool call assembly
+
+import asio;
+import fmt;
+import openai;
+import std;
+
+asio::awaitable<void> stream_example(openai::Client& client) {
+    fmt::print("=== Streaming Chat Completion Example ===\n\n");
+
+    openai::ChatCompletionRequest request;
+    request.model = "gpt-4o-mini";
+    request.max_tokens = 200;
+    request.stream_include_usage = true;
+
+    openai::Message msg;
+    msg.role = openai::MessageRole::User;
+    msg.content = "Write a haiku about asynchronous I/O";
+    request.messages.push_back(msg);
+
+    auto start = std::chrono::steady_clock::now();
+    bool first_token = true;
+
+    fmt::print("Assistant: ");
+    auto response = co_await client.create_chat_completion_stream(request,
+        [&](const openai::ChatCompletionChunk& chunk) {
+            for (const auto& choice : chunk.choices) {
+                if (choice.delta.content.empty()) {
+                    continue;
+                }
+                if (first_token) {
+                    auto elapsed = std::chrono::steady_clock::now() - start;
+                    fmt::print("[first token after {} ms] ",
+                        std::chrono::duration_cast<std::chrono::milliseconds>(elapsed).count());
+                    first_token = false;
+                }
+                fmt::print("{}", choice.delta.content);
+                std::fflush(stdout);
+            }
+        });
+    fmt::print("\n\n");
+
+    if (!response) {
+        fmt::print("Error: {}\n", response.error().to_string());
+        co_return;
+    }
+
+    fmt::print("Total tokens: {}\n\n", response->usage.total_tokens);
+
+    // Tool calls stream as argument fragments; the returned response has them assembled
+    fmt::print("=== Streaming Tool Call Example ===\n\n");
+
+    openai::Tool weather;
+    weather.function.name = "get_weather";
+    weather.function.description = "Get the current weather for a city";
+    weather.function.parameters =
+        R"({"type":"object","properties":{"city":{"type":"string"}},"required":["city"]})";
+
+    request.messages.clear();
+    msg.content = "What is the weather in Paris?";
+    request.messages.push_back(msg);
+    request.tools = std::vector<openai::Tool>{weather};
+
+    std::size_t fragments = 0;
+    response = co_await client.create_chat_completion_stream(request,
+        [&](const openai::ChatCompletionChunk& chunk) {
+            for (const auto& choice : chunk.choices) {
+                fragments += choice.delta.tool_calls.size();
+            }
+        });
+
+    if (!response) {
+        fmt::print("Error: {}\n", response.error().to_string());
+        co_return;
+    }
+
+    fmt::print("Received {} tool call fragments\n", fragments);
+    for (const auto& choice : response->choices) {
+        if (!choice.message.tool_calls) {
+            continue;
+        }
+        for (const auto& call : *choice.message.tool_calls) {
+            fmt::print("  {}({}) id={}\n", call.function.name, call.function.arguments, call.id);
+        }
+    }
+}
+
+int main() {
+    const char* api_key = std::getenv("OPENAI_API_KEY");
+    if (!api_key) {
+        fmt::print("Error: OPENAI_API_KEY environment variable not set\n");
+        return 1;
+    }
+
+    asio::io_context io_context;
+    openai::Client client(api_key, io_context);
+
+    asio::co_spawn(io_context, stream_example(client), asio::detached);
+    io_context.run();
+
+    return 0;
+}
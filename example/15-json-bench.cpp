@@ -0,0 +1,127 @@
+// Example 15: JSON Decoding Benchmark
+// Measures single-pass response decoding throughput (no API key needed)
+
+import fmt;
+import openai;
+import std;
+
+// Synthetic chat completion with a long, escape-heavy answer
+std::string make_chat_body(std::size_t content_bytes) {
+    std::string content;
+    const std::string_view sentence = R"(Asynchronous I/O lets one thread serve \"many\" sockets.\n)";
+    while (content.size() < content_bytes) {
+        content += sentence;
+    }
+    return fmt::format(
+        R"({{"id":"chatcmpl-123","object":"chat.completion","created":1700000000,"model":"gpt-4o-mini",)"
+        R"("choices":[{{"index":0,"message":{{"role":"assistant","content":"{}"}},"logprobs":null,"finish_reason":"stop"}}],)"
+        R"("usage":{{"prompt_tokens":42,"completion_tokens":4096,"total_tokens":4138}}}})",
+        content);
+}
+
+// Synthetic embedding response: count vectors of the given dimension
+std::string make_embedding_body(std::size_t count, std::size_t dimensions) {
+    std::mt19937 rng(42);
+    std::uniform_real_distribution<float> dist(-0.1f, 0.1f);
+
+    std::string body = R"({"object":"list","data":[)";
+    for (std::size_t i = 0; i < count; ++i) {
+        if (i > 0) body += ',';
+        body += fmt::format(R"({{"object":"embedding","index":{},"embedding":[)", i);
+        for (std::size_t d = 0; d < dimensions; ++d) {
+            if (d > 0) body += ',';
+            body += fmt::format("{}", dist(rng));
+        }
+        body += "]}";
+    }
+    body += R"(],"model":"text-embedding-3-small","usage":{"prompt_tokens":8,"total_tokens":8}})";
+    return body;
+}
+
+// Same vectors as encoding_format "base64" returns them: packed little-endian float32
+std::string make_base64_embedding_body(std::size_t count, std::size_t dimensions) {
+    constexpr std::string_view alphabet = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+    std::mt19937 rng(42);
+    std::uniform_real_distribution<float> dist(-0.1f, 0.1f);
+
+    std::string body = R"({"object":"list","data":[)";
+    for (std::size_t i = 0; i < count; ++i) {
+        std::vector<unsigned char> bytes(dimensions * sizeof(float));
+        for (std::size_t d = 0; d < dimensions; ++d) {
+            auto bits = std::bit_cast<std::uint32_t>(dist(rng));
+            for (int b = 0; b < 4; ++b) {
+                bytes[d * 4 + b] = static_cast<unsigned char>(bits >> (8 * b));
+            }
+        }
+        std::string encoded;
+        for (std::size_t j = 0; j < bytes.size(); j += 3) {
+            std::uint32_t triple = bytes[j] << 16;
+            if (j + 1 < bytes.size()) triple |= bytes[j + 1] << 8;
+            if (j + 2 < bytes.size()) triple |= bytes[j + 2];
+            encoded += alphabet[(triple >> 18) & 0x3F];
+            encoded += alphabet[(triple >> 12) & 0x3F];
+            encoded += j + 1 < bytes.size() ? alphabet[(triple >> 6) & 0x3F] : '=';
+            encoded += j + 2 < bytes.size() ? alphabet[triple & 0x3F] : '=';
+        }
+        if (i > 0) body += ',';
+        body += fmt::format(R"({{"object":"embedding","index":{},"embedding":"{}"}})", i, encoded);
+    }
+    body += R"(],"model":"text-embedding-3-small","usage":{"prompt_tokens":8,"total_tokens":8}})";
+    return body;
+}
+
+// Synthetic list response (files)
+std::string make_list_body(std::size_t count) {
+    std::string body = R"({"object":"list","data":[)";
+    for (std::size_t i = 0; i < count; ++i) {
+        if (i > 0) body += ',';
+        body += fmt::format(
+            R"({{"id":"file-{:08}","object":"file","bytes":{},"created_at":1700000000,)"
+            R"("filename":"training-{}.jsonl","purpose":"fine-tune","status":"processed","status_details":null}})",
+            i, 1000 + i, i);
+    }
+    body += R"(],"has_more":false})";
+    return body;
+}
+
+// Decode body repeatedly and report time per MB; count() checks the result is used
+template <typename T, typename Count>
+void bench(const char* name, const std::string& body, int iterations, Count count) {
+    std::size_t items = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; ++i) {
+        items += count(openai::decode_json<T>(body));
+    }
+    auto elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    double megabytes = static_cast<double>(body.size()) * iterations / (1024.0 * 1024.0);
+    fmt::print("{:<10} {:>9.1f} KB {:>9.2f} ms/MB {:>9.1f} MB/s  ({} items)\n",
+        name, body.size() / 1024.0, elapsed * 1000.0 / megabytes, megabytes / elapsed, items / iterations);
+}
+
+int main() {
+    fmt::print("=== JSON Decoding Benchmark ===\n\n");
+
+    auto chat = make_chat_body(256 * 1024);
+    auto embeddings = make_embedding_body(64, 1536);
+    auto base64_embeddings = make_base64_embedding_body(64, 1536);
+    auto files = make_list_body(5000);
+
+    bench<openai::ChatCompletionResponse>("chat", chat, 200,
+        [](const auto& response) { return response.choices.front().message.content.size(); });
+    bench<openai::EmbeddingResponse>("embedding", embeddings, 20,
+        [](const auto& response) { return response.data.size(); });
+    bench<openai::EmbeddingResponse>("base64", base64_embeddings, 200,
+        [](const auto& response) { return response.data.size(); });
+    bench<openai::FileListResponse>("file list", files, 50,
+        [](const auto& response) { return response.data.size(); });
+
+    // Malformed bodies are reported rather than half-decoded
+    try {
+        openai::decode_json<openai::ChatCompletionResponse>(chat.substr(0, chat.size() / 2));
+    } catch (const openai::JsonError& e) {
+        fmt::print("\nTruncated body: {}\n", e.what());
+    }
+
+    return 0;
+}
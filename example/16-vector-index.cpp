@@ -0,0 +1,119 @@
+// Example 16: Vector Index Benchmark
+// Recall vs. queries per second for the flat and HNSW indexes (no API key needed)
+
+import fmt;
+import openai;
+import std;
+
+// Clustered synthetic embeddings, roughly like real text embeddings
+openai::EmbeddingMatrix make_vectors(std::size_t count, std::size_t dimensions, std::uint64_t seed) {
+    std::mt19937_64 rng(42);
+    std::normal_distribution<float> center_dist(0.0f, 1.0f);
+    openai::EmbeddingMatrix centers(64, dimensions);
+    for (std::size_t c = 0; c < centers.rows(); ++c) {
+        for (float& value : centers.row(c)) {
+            value = center_dist(rng);
+        }
+    }
+
+    rng.seed(seed);
+    std::normal_distribution<float> noise(0.0f, 0.6f);
+    std::uniform_int_distribution<std::size_t> pick(0, centers.rows() - 1);
+    openai::EmbeddingMatrix vectors(count, dimensions);
+    for (std::size_t i = 0; i < count; ++i) {
+        auto center = centers[pick(rng)];
+        auto row = vectors.row(i);
+        for (std::size_t d = 0; d < dimensions; ++d) {
+            row[d] = center[d] + noise(rng);
+        }
+    }
+    return vectors;
+}
+
+double seconds_since(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+// Fraction of the exact top-k ids that the approximate results found
+double recall(const std::vector<std::vector<openai::SearchResult>>& exact,
+              const std::vector<std::vector<openai::SearchResult>>& approximate) {
+    std::size_t found = 0;
+    std::size_t total = 0;
+    for (std::size_t q = 0; q < exact.size(); ++q) {
+        for (const auto& truth : exact[q]) {
+            ++total;
+            for (const auto& result : approximate[q]) {
+                if (result.id == truth.id) {
+                    ++found;
+                    break;
+                }
+            }
+        }
+    }
+    return total == 0 ? 1.0 : static_cast<double>(found) / total;
+}
+
+int main() {
+    constexpr std::size_t count = 50000;
+    constexpr std::size_t dimensions = 256;
+    constexpr std::size_t queries_count = 1000;
+    constexpr std::size_t k = 10;
+
+    fmt::print("=== Vector Index Benchmark ===\n\n");
+    fmt::print("{} vectors x {} dimensions, {} queries, top-{}\n\n", count, dimensions, queries_count, k);
+
+    auto vectors = make_vectors(count, dimensions, 1);
+    auto queries = make_vectors(queries_count, dimensions, 2);
+
+    // Flat index: exact results, used as ground truth
+    openai::FlatIndex flat(dimensions);
+    flat.add(vectors);
+
+    auto start = std::chrono::steady_clock::now();
+    auto exact = flat.search(queries, k, 1);
+    auto flat_seconds = seconds_since(start);
+
+    start = std::chrono::steady_clock::now();
+    flat.search(queries, k);
+    auto flat_parallel_seconds = seconds_since(start);
+
+    fmt::print("{:<24} {:>8} {:>12}\n", "index", "recall", "QPS");
+    fmt::print("{:<24} {:>8.3f} {:>12.0f}\n", "flat (1 thread)", 1.0, queries_count / flat_seconds);
+    fmt::print("{:<24} {:>8.3f} {:>12.0f}\n", "flat (all threads)", 1.0, queries_count / flat_parallel_seconds);
+
+    // HNSW: build on all cores, then sweep ef_search on one thread
+    openai::HnswIndex hnsw(dimensions);
+    start = std::chrono::steady_clock::now();
+    hnsw.add(vectors);
+    auto build_seconds = seconds_since(start);
+
+    for (std::size_t ef : {10, 20, 40, 80, 160, 320}) {
+        hnsw.set_ef_search(ef);
+        start = std::chrono::steady_clock::now();
+        auto approximate = hnsw.search(queries, k, 1);
+        auto seconds = seconds_since(start);
+        fmt::print("{:<24} {:>8.3f} {:>12.0f}\n", fmt::format("hnsw (ef={})", ef),
+            recall(exact, approximate), queries_count / seconds);
+    }
+    fmt::print("\nHNSW build: {:.2f} s ({:.0f} inserts/s)\n", build_seconds, count / build_seconds);
+
+    // Round trip through a memory-mapped index file
+    auto path = (std::filesystem::temp_directory_path() / "openai-hnsw-bench.idx").string();
+    start = std::chrono::steady_clock::now();
+    hnsw.save(path);
+    auto save_seconds = seconds_since(start);
+
+    start = std::chrono::steady_clock::now();
+    auto loaded = openai::HnswIndex::load(path);
+    auto load_seconds = seconds_since(start);
+    loaded.set_ef_search(80);
+    hnsw.set_ef_search(80);
+    bool same = hnsw.search(queries[0], k).front().id == loaded.search(queries[0], k).front().id;
+
+    fmt::print("Index file: {:.1f} MB, save {:.0f} ms, load {:.1f} ms, results match: {}\n",
+        std::filesystem::file_size(path) / (1024.0 * 1024.0), save_seconds * 1000.0, load_seconds * 1000.0,
+        same ? "yes" : "no");
+    std::filesystem::remove(path);
+
+    return 0;
+}
@@ -0,0 +1,72 @@
+// Example 17: Blocking Calls from Worker Threads
+// Demonstrates SyncClient: plain threads make blocking API calls that run
+// concurrently on the client's background io_context threads
+
+import asio;
+import fmt;
+import openai;
+import std;
+
+int main() {
+    const char* api_key = std::getenv("OPENAI_API_KEY");
+    if (!api_key) {
+        fmt::print("Error: OPENAI_API_KEY environment variable not set\n");
+        return 1;
+    }
+
+    fmt::print("=== Blocking Calls from Worker Threads ===\n\n");
+
+    // Two threads drive the client; eight workers call it
+    openai::SyncClient client(api_key, 2);
+
+    const std::vector<std::string> questions = {
+        "What is the capital of France?", "What is 12 * 12?",
+        "Name a prime number above 100.", "What color is the sky on a clear day?",
+        "Who wrote Hamlet?", "What is the boiling point of water in Celsius?",
+        "How many continents are there?", "What is the largest planet?",
+    };
+
+    std::mutex print_mutex;
+    std::vector<std::thread> workers;
+    const auto start = std::chrono::steady_clock::now();
+
+    for (const auto& question : questions) {
+        workers.emplace_back([&, question] {
+            openai::ChatCompletionRequest request;
+            request.model = "gpt-3.5-turbo";
+            request.max_tokens = 30;
+            request.temperature = 0.0f;
+
+            openai::Message msg;
+            msg.role = openai::MessageRole::User;
+            msg.content = question;
+            request.messages.push_back(msg);
+
+            auto response = client.create_chat_completion(request);
+
+            std::lock_guard lock(print_mutex);
+            if (!response) {
+                fmt::print("Q: {}\nError: {}\n\n", question, response.error().to_string());
+            } else if (!response->choices.empty()) {
+                fmt::print("Q: {}\nA: {}\n\n", question, response->choices[0].message.content);
+            }
+        });
+    }
+
+    for (auto& worker : workers) {
+        worker.join();
+    }
+
+    auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start);
+    fmt::print("{} calls finished in {} ms\n", questions.size(), elapsed.count());
+
+    // Any other call can be wrapped the same way
+    openai::ModerationRequest moderation;
+    moderation.input = "I love programming!";
+    auto result = client.call([&](openai::Client& c) { return c.create_moderation(moderation); });
+    if (result && !result->results.empty()) {
+        fmt::print("Moderation flagged: {}\n", result->results[0].flagged);
+    }
+
+    return 0;
+}
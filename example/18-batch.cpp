@@ -0,0 +1,112 @@
+// Example 18: Batch API
+// Submit many chat requests as one asynchronous batch and collect the results
+
+import asio;
+import fmt;
+import openai;
+import std;
+
+asio::awaitable<void> batch_example(openai::Client& client) {
+    fmt::print("=== Batch API Example ===\n\n");
+
+    const std::vector<std::string> questions = {
+        "What is the capital of France?",
+        "What is 12 * 12?",
+        "Name a primary color.",
+    };
+
+    // Build the JSONL input; pass a path to BatchInput to spill large inputs to disk
+    openai::BatchInput input;
+    for (std::size_t i = 0; i < questions.size(); ++i) {
+        openai::ChatCompletionRequest request;
+        request.model = "gpt-4o-mini";
+        request.max_tokens = 50;
+
+        openai::Message msg;
+        msg.role = openai::MessageRole::User;
+        msg.content = questions[i];
+        request.messages.push_back(msg);
+
+        input.add(fmt::format("question-{}", i), request);
+    }
+    fmt::print("Prepared {} requests for {}\n\n", input.size(), input.endpoint());
+
+    try {
+        // Upload the input file and create the batch
+        auto batch = co_await client.submit_batch(input);
+
+        if (!batch.has_value()) {
+            fmt::print("Error: {}\n", batch.error().to_string());
+            co_return;
+        }
+        fmt::print("Batch {} created, status: {}\n", batch.value().id, batch.value().status);
+
+        // Poll until the batch reaches a final state
+        asio::steady_timer timer(co_await asio::this_coro::executor);
+        const std::string batch_id = batch.value().id;
+        while (batch.value().status != "completed" && batch.value().status != "failed" &&
+               batch.value().status != "expired" && batch.value().status != "cancelled") {
+            timer.expires_after(std::chrono::seconds(30));
+            co_await timer.async_wait(asio::use_awaitable);
+
+            batch = co_await client.retrieve_batch(batch_id);
+            if (!batch.has_value()) {
+                fmt::print("Error: {}\n", batch.error().to_string());
+                co_return;
+            }
+            const auto& counts = batch.value().request_counts;
+            fmt::print("  status: {} ({}/{} completed, {} failed)\n",
+                       batch.value().status, counts.completed, counts.total, counts.failed);
+        }
+
+        for (const auto& error : batch.value().errors) {
+            fmt::print("Input error: {} {}\n", error.code, error.message);
+        }
+
+        // Results arrive in no particular order; match them by custom_id
+        if (!batch.value().output_file_id.empty()) {
+            fmt::print("\n--- Results ---\n");
+            auto count = co_await client.read_batch_results<openai::ChatCompletionResponse>(
+                batch.value().output_file_id,
+                [](openai::BatchResult<openai::ChatCompletionResponse>&& result) {
+                    if (!result.result.has_value()) {
+                        fmt::print("{}: error: {}\n", result.custom_id, result.result.error().to_string());
+                    } else if (!result.result.value().choices.empty()) {
+                        fmt::print("{}: {}\n", result.custom_id, result.result.value().choices[0].message.content);
+                    }
+                });
+            if (!count.has_value()) {
+                fmt::print("Error: {}\n", count.error().to_string());
+            }
+        }
+
+        // Requests that could not be run at all are listed in the error file
+        if (!batch.value().error_file_id.empty()) {
+            fmt::print("\n--- Failed Requests ---\n");
+            co_await client.read_batch_results<openai::ChatCompletionResponse>(
+                batch.value().error_file_id,
+                [](openai::BatchResult<openai::ChatCompletionResponse>&& result) {
+                    fmt::print("{}: {}\n", result.custom_id, result.result.error().to_string());
+                });
+        }
+
+    } catch (const std::exception& e) {
+        fmt::print("Exception: {}\n", e.what());
+    }
+}
+
+int main() {
+    const char* api_key = std::getenv("OPENAI_API_KEY");
+    if (!api_key) {
+        fmt::print("Error: OPENAI_API_KEY environment variable not set\n");
+        return 1;
+    }
+
+    asio::io_context io_context;
+    openai::Client client(api_key, io_context);
+
+    asio::co_spawn(io_context, batch_example(client), asio::detached);
+    io_context.run();
+
+    return 0;
+}
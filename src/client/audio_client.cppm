@@ -44,23 +44,21 @@ public:
             fields["temperature"] = std::to_string(*request.temperature);
         }
         
-        std::map<std::string, std::pair<std::string, std::string>> files;
+        std::map<std::string, MultipartFile> files;
+        files["file"] = {request.file_path, request.file_path, {}};
         try {
-            std::string audio_content = read_file_content(request.file_path);
-            files["file"] = {request.file_path, audio_content};
+            req.body_stream = build_multipart_body(fields, files, boundary);
         } catch (const std::exception& e) {
             co_return std::unexpected(ApiError(std::string("Failed to read audio file: ") + e.what()));
         }
-        
-        req.body = build_multipart_formdata(fields, files, boundary);
         req.headers["Content-Type"] = "multipart/form-data; boundary=" + boundary;
         
         add_auth_headers(req, false);
         
-        auto response = co_await http_client_.async_request(req);
+        auto response = co_await send(req);
         
         if (response.is_error) {
-            co_return std::unexpected(ApiError(response.error_message));
+            co_return std::unexpected(transport_error(response));
         }
         
         if (response.status_code != 200) {
@@ -68,7 +66,11 @@ public:
                 fmt::format("HTTP {}: {}", response.status_code, response.body)));
         }
         
-        // Parse response (usually just text)
+        // json and verbose_json wrap the text in an object; other formats are the text itself
+        if (is_json_format(request.response_format)) {
+            co_return parse_response<AudioResponse>(response.body);
+        }
+        
         AudioResponse audio_response;
         audio_response.text = response.body;
         co_return audio_response;
@@ -97,23 +99,21 @@ public:
             fields["temperature"] = std::to_string(*request.temperature);
         }
         
-        std::map<std::string, std::pair<std::string, std::string>> files;
+        std::map<std::string, MultipartFile> files;
+        files["file"] = {request.file_path, request.file_path, {}};
         try {
-            std::string audio_content = read_file_content(request.file_path);
-            files["file"] = {request.file_path, audio_content};
+            req.body_stream = build_multipart_body(fields, files, boundary);
         } catch (const std::exception& e) {
             co_return std::unexpected(ApiError(std::string("Failed to read audio file: ") + e.what()));
         }
-        
-        req.body = build_multipart_formdata(fields, files, boundary);
         req.headers["Content-Type"] = "multipart/form-data; boundary=" + boundary;
         
         add_auth_headers(req, false);
         
-        auto response = co_await http_client_.async_request(req);
+        auto response = co_await send(req);
         
         if (response.is_error) {
-            co_return std::unexpected(ApiError(response.error_message));
+            co_return std::unexpected(transport_error(response));
         }
         
         if (response.status_code != 200) {
@@ -121,11 +121,20 @@ public:
                 fmt::format("HTTP {}: {}", response.status_code, response.body)));
         }
         
-        // Parse response (usually just text)
+        // json and verbose_json wrap the text in an object; other formats are the text itself
+        if (is_json_format(request.response_format)) {
+            co_return parse_response<AudioResponse>(response.body);
+        }
+        
         AudioResponse audio_response;
         audio_response.text = response.body;
         co_return audio_response;
     }
+
+private:
+    static bool is_json_format(const std::optional<std::string>& format) {
+        return !format || format->empty() || *format == "json" || *format == "verbose_json";
+    }
 };
 
 } // namespace openai::client
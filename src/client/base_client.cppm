@@ -6,6 +6,9 @@ export module openai.client.base;
 import asio;
 import fmt;
 import openai.http_client;
+import openai.types.common;
+import openai.types.json;
+import openai.types.response_cache;
 import std;
 
 export namespace openai::client {
@@ -14,15 +17,52 @@ export namespace openai::client {
 class BaseClient {
 public:
     explicit BaseClient(std::string api_key, asio::io_context& io_context)
+        : BaseClient(std::move(api_key), std::make_shared<http::Client>(io_context)) {}
+
+    // Send through a transport (TLS context, connection pool, DNS cache and
+    // metrics) shared with other clients. Transport settings below, such as
+    // the HTTP version, timeouts and cancel_all(), then apply to all of them.
+    BaseClient(std::string api_key, std::shared_ptr<http::Client> transport)
         : api_key_(std::move(api_key))
-        , io_context_(io_context)
-        , http_client_(io_context)
-        , api_base_("https://api.openai.com/v1") {}
+        , api_base_("https://api.openai.com/v1")
+        , http_client_(std::move(transport))
+        , io_context_(http_client_->io_context()) {}
 
     virtual ~BaseClient() = default;
 
-    // Configuration
+    // Configuration. Requests go to base_url, e.g. a proxy or a local
+    // stand-in server: "http://127.0.0.1:8080/v1" replaces the scheme, host
+    // and the "/v1" path prefix. Throws std::invalid_argument unless the
+    // URL starts with http:// or https://.
     void set_api_base(std::string base_url) {
+        Route route;
+        std::string_view rest = base_url;
+        if (rest.starts_with("https://")) {
+            route.use_ssl = true;
+            rest.remove_prefix(8);
+        } else if (rest.starts_with("http://")) {
+            route.use_ssl = false;
+            rest.remove_prefix(7);
+        } else {
+            throw std::invalid_argument("API base must be an http:// or https:// URL: " + base_url);
+        }
+        const auto slash = rest.find('/');
+        auto authority = rest.substr(0, slash);
+        route.prefix = slash == std::string_view::npos ? "" : rest.substr(slash);
+        while (route.prefix.ends_with('/')) {
+            route.prefix.pop_back();
+        }
+        if (const auto colon = authority.rfind(':'); colon != std::string_view::npos) {
+            route.port = authority.substr(colon + 1);
+            authority = authority.substr(0, colon);
+        }
+        route.host = authority;
+
+        if (route.use_ssl && route.host == "api.openai.com" && route.port.empty() && route.prefix == "/v1") {
+            route_.reset();
+        } else {
+            route_ = std::move(route);
+        }
         api_base_ = std::move(base_url);
     }
 
@@ -30,6 +70,92 @@ public:
         organization_id_ = std::move(org_id);
     }
 
+    // Share one DNS cache across clients
+    void set_resolver_cache(std::shared_ptr<http::ResolverCache> cache) {
+        http_client_->set_resolver_cache(std::move(cache));
+    }
+
+    // Use HTTP/2 (negotiated via ALPN) or HTTP/1.1 for requests
+    void set_http_version(http::HttpVersion version) {
+        http_client_->set_http_version(version);
+    }
+
+    // Close open HTTP/2 sessions so io_context::run() can return
+    void close_http2_sessions() {
+        http_client_->close_http2_sessions();
+    }
+
+    // Ask for gzip/deflate responses and compress large request bodies;
+    // transport().metrics() reports the bytes and time involved
+    void set_compression(http::CompressionOptions options) {
+        http_client_->set_compression(options);
+    }
+
+    // Pace requests against the API's rate limits; share one limiter across
+    // clients that use the same key. nullptr disables pacing.
+    void set_rate_limiter(std::shared_ptr<http::RateLimiter> limiter) {
+        rate_limiter_ = std::move(limiter);
+    }
+
+    const std::shared_ptr<http::RateLimiter>& rate_limiter() const { return rate_limiter_; }
+
+    // Per-phase limits for each attempt (connect, TLS handshake, first byte,
+    // idle read, total); retry_policy().deadline bounds all attempts together
+    void set_timeouts(http::Timeouts timeouts) {
+        http_client_->set_default_timeouts(timeouts);
+    }
+
+    const http::Timeouts& timeouts() const { return http_client_->default_timeouts(); }
+
+    // Abort every request in flight, including those waiting to retry or
+    // for rate limit budget; each completes with Response::cancelled set
+    void cancel_all() {
+        http_client_->cancel_all();
+        asio::dispatch(executor(), [this] {
+            for (auto* timer : backoff_timers_) {
+                timer->cancel();
+            }
+        });
+    }
+
+    // Strand the client's shared state lives on. Calls may be awaited from any
+    // executor, with the io_context run by any number of threads; streaming
+    // callbacks are invoked on this strand.
+    asio::any_io_executor executor() const { return http_client_->executor(); }
+
+    http::Client& transport() const { return *http_client_; }
+
+    // Hedge slow embedding, moderation and temperature-0 completion calls
+    // with a duplicate request; share one hedger to share its budget.
+    // nullptr (the default) disables hedging.
+    void set_hedger(std::shared_ptr<http::Hedger> hedger) {
+        hedger_ = std::move(hedger);
+    }
+
+    const std::shared_ptr<http::Hedger>& hedger() const { return hedger_; }
+
+    // Retry transient failures with exponential backoff and full jitter
+    void set_retry_policy(http::RetryPolicy policy) {
+        retry_policy_ = std::move(policy);
+    }
+
+    const http::RetryPolicy& retry_policy() const { return retry_policy_; }
+
+    // Count retries into shared metrics, e.g. one set for all sub-clients
+    void set_retry_metrics(std::shared_ptr<http::RetryMetrics> metrics) {
+        retry_metrics_ = std::move(metrics);
+    }
+
+    const http::RetryMetrics& retry_metrics() const { return *retry_metrics_; }
+
+    // Answer identical requests from a shared cache (used by the chat and
+    // completion clients). nullptr disables caching.
+    void set_response_cache(std::shared_ptr<ResponseCache> cache) {
+        response_cache_ = std::move(cache);
+    }
+
+    const std::shared_ptr<ResponseCache>& response_cache() const { return response_cache_; }
+
 protected:
     // Helper: Add authentication headers to request
     void add_auth_headers(http::Request& req, bool json_content = true) const {
@@ -51,32 +177,50 @@ protected:
         );
     }
     
-    // Helper: Build multipart/form-data body
-    std::string build_multipart_formdata(
+    // File field of a multipart/form-data body: streamed from path, or when
+    // path is empty, sent from content in place
+    struct MultipartFile {
+        std::string filename;
+        std::string path;
+        std::span<const char> content;  // Must outlive the request
+    };
+
+    // Helper: Build multipart/form-data body. Files are not loaded: only the
+    // boundaries and part headers are built here, and file bytes are read in
+    // bounded chunks while the request is sent. Throws std::runtime_error
+    // when a file cannot be read.
+    std::shared_ptr<http::BodyStream> build_multipart_body(
         const std::map<std::string, std::string>& fields,
-        const std::map<std::string, std::pair<std::string, std::string>>& files,
+        const std::map<std::string, MultipartFile>& files,
         const std::string& boundary
     ) const {
-        std::string body;
+        auto body = std::make_shared<http::BodyStream>();
+        std::string text;
         
         // Add text fields
         for (const auto& [key, value] : fields) {
-            body += "--" + boundary + "\r\n";
-            body += "Content-Disposition: form-data; name=\"" + key + "\"\r\n\r\n";
-            body += value + "\r\n";
+            text += "--" + boundary + "\r\n";
+            text += "Content-Disposition: form-data; name=\"" + key + "\"\r\n\r\n";
+            text += value + "\r\n";
         }
         
         // Add file fields
-        for (const auto& [key, file_data] : files) {
-            const auto& [filename, content] = file_data;
-            body += "--" + boundary + "\r\n";
-            body += "Content-Disposition: form-data; name=\"" + key + "\"; filename=\"" + filename + "\"\r\n";
-            body += "Content-Type: application/octet-stream\r\n\r\n";
-            body += content + "\r\n";
+        for (const auto& [key, file] : files) {
+            text += "--" + boundary + "\r\n";
+            text += "Content-Disposition: form-data; name=\"" + key + "\"; filename=\"" + file.filename + "\"\r\n";
+            text += "Content-Type: application/octet-stream\r\n\r\n";
+            body->append(std::exchange(text, {}));
+            if (file.path.empty()) {
+                body->append_view(file.content);
+            } else {
+                body->append_file(file.path);
+            }
+            text = "\r\n";
         }
         
         // End boundary
-        body += "--" + boundary + "--\r\n";
+        text += "--" + boundary + "--\r\n";
+        body->append(std::move(text));
         
         return body;
     }
@@ -86,77 +230,373 @@ protected:
         return api_base_ + path;
     }
     
-    // Helper: Read file content
-    std::string read_file_content(const std::string& filepath) const {
-        std::ifstream file(filepath, std::ios::binary);
-        if (!file) {
-            throw std::runtime_error("Failed to open file: " + filepath);
+    // Helper: Send req to the API. Every request goes through here so that
+    // rate limiting and retries apply to all endpoints.
+    asio::awaitable<http::Response> send(const http::Request& req) {
+        const auto how = handling(req);
+        if (route_) {
+            co_return co_await asio::co_spawn(executor(), send_with_retries(routed(req), how), asio::use_awaitable);
         }
-        
-        std::ostringstream content;
-        content << file.rdbuf();
-        return content.str();
+        co_return co_await asio::co_spawn(executor(), send_with_retries(req, how), asio::use_awaitable);
     }
 
-    // Helper: Unescape JSON strings
-    std::string unescape_json(const std::string& str) const {
-        std::string result;
-        result.reserve(str.size());
-        
-        for (std::size_t i = 0; i < str.length(); ++i) {
-            if (str[i] == '\\' && i + 1 < str.length()) {
-                switch (str[i + 1]) {
-                    case 'n': result += '\n'; ++i; break;
-                    case 't': result += '\t'; ++i; break;
-                    case 'r': result += '\r'; ++i; break;
-                    case '\\': result += '\\'; ++i; break;
-                    case '"': result += '"'; ++i; break;
-                    default: result += str[i]; break;
+    // Whether a request may be retried and hedged
+    struct Handling {
+        bool repeatable{false};
+        bool hedgeable{false};
+    };
+
+    // Helper: Classify req before routed() rewrites its "/v1" path prefix,
+    // which the endpoint checks match on
+    Handling handling(const http::Request& req) const {
+        return {retry_policy_.max_retries > 0 && safe_to_retry(req, retry_policy_),
+                hedger_ && hedgeable(req)};
+    }
+
+    // Helper: req sent to set_api_base()'s URL instead of the default
+    http::Request routed(const http::Request& req) const {
+        auto out = req;
+        out.use_ssl = route_->use_ssl;
+        out.host = route_->host;
+        out.port = route_->port;
+        if (out.path.starts_with("/v1")) {
+            out.path = route_->prefix + out.path.substr(3);
+        }
+        return out;
+    }
+
+    // Helper: send() on the strand. Transient failures of requests that are
+    // safe to repeat are retried per retry_policy_; streamed requests are not
+    // retried once body data has been delivered.
+    asio::awaitable<http::Response> send_with_retries(const http::Request& req, Handling how) {
+        const auto& policy = retry_policy_;
+        const auto deadline = std::chrono::steady_clock::now() + policy.deadline;
+        const bool repeatable = how.repeatable;
+
+        bool delivered = false;
+        std::optional<http::Request> streamed;
+        if (repeatable && req.on_body_chunk) {
+            streamed = req;
+            streamed->on_body_chunk = [&delivered, &on_chunk = req.on_body_chunk](std::string_view data) {
+                delivered = true;
+                on_chunk(data);
+            };
+        }
+        const auto& attempt_req = streamed ? *streamed : req;
+        const auto generation = http_client_->cancel_generation();
+
+        for (int attempt = 0;; ++attempt) {
+            auto response = co_await send_once(attempt_req, generation, how.hedgeable);
+            if (!repeatable || delivered || response.cancelled || !should_retry(response, policy)) {
+                if (attempt > 0 && !response.is_error && response.status_code < 400) {
+                    ++retry_metrics_->recovered;
                 }
-            } else {
-                result += str[i];
+                co_return response;
             }
+            if (attempt >= policy.max_retries) {
+                ++retry_metrics_->exhausted;
+                co_return response;
+            }
+
+            auto delay = retry_delay(attempt, response, policy);
+            if (std::chrono::steady_clock::now() + delay > deadline) {
+                ++retry_metrics_->deadline_exceeded;
+                co_return response;
+            }
+            ++retry_metrics_->retries;
+            retry_metrics_->backoff_ms += static_cast<std::uint64_t>(delay.count());
+            asio::steady_timer timer(co_await asio::this_coro::executor, delay);
+            backoff_timers_.insert(&timer);
+            std::error_code ec;
+            co_await timer.async_wait(asio::redirect_error(asio::use_awaitable, ec));
+            backoff_timers_.erase(&timer);
         }
-        
-        return result;
-    }
-
-    // Helper: Parse boolean field from JSON
-    bool parse_bool_field(const std::string& json_str, const std::string& field_name) const {
-        auto field_key = fmt::format("\"{}\":", field_name);
-        auto pos = json_str.find(field_key);
-        if (pos != std::string::npos) {
-            pos += field_key.length();
-            auto end_pos = json_str.find_first_of(",}", pos);
-            auto value = json_str.substr(pos, end_pos - pos);
-            return (value == "true");
-        }
-        return false;
-    }
-
-    // Helper: Parse double field from JSON
-    double parse_double_field(const std::string& json_str, const std::string& field_name) const {
-        auto field_key = fmt::format("\"{}\":", field_name);
-        auto pos = json_str.find(field_key);
-        if (pos != std::string::npos) {
-            pos += field_key.length();
-            auto end_pos = json_str.find_first_of(",}", pos);
-            auto value_str = json_str.substr(pos, end_pos - pos);
-            try {
-                return std::stod(value_str);
-            } catch (...) {
-                return 0.0;
+    }
+
+    // Helper: One attempt, paced by the rate limiter. Gives up when
+    // cancel_all() ran since the request (not this attempt) started.
+    asio::awaitable<http::Response> send_once(const http::Request& req, std::uint64_t generation, bool hedge) {
+        if (http_client_->cancel_generation() != generation) {
+            co_return cancelled_response();
+        }
+        ++retry_metrics_->attempts;
+        if (!rate_limiter_) {
+            co_return co_await transmit(req, hedge);
+        }
+        auto [model, tokens] = estimate_cost(req);
+        auto wait = rate_limiter_->reserve(model, tokens);
+        if (wait > std::chrono::steady_clock::duration::zero()) {
+            // A wait the request's total timeout would not survive fails now;
+            // retrying would only queue behind it again
+            if (auto total = total_timeout(req); total.count() > 0 && wait > total) {
+                http::Response response;
+                response.is_error = true;
+                response.timed_out = true;
+                response.headers["x-should-retry"] = "false";
+                response.error_message = fmt::format("rate limit wait of {} ms exceeds the {} ms request timeout",
+                    std::chrono::ceil<std::chrono::milliseconds>(wait).count(), total.count());
+                rate_limiter_->release(model, tokens, response);
+                co_return response;
             }
+            asio::steady_timer timer(co_await asio::this_coro::executor, wait);
+            backoff_timers_.insert(&timer);
+            std::error_code ec;
+            co_await timer.async_wait(asio::redirect_error(asio::use_awaitable, ec));
+            backoff_timers_.erase(&timer);
+        }
+        if (http_client_->cancel_generation() != generation) {
+            rate_limiter_->release(model, tokens, cancelled_response());
+            co_return cancelled_response();
         }
-        return 0.0;
+        auto response = co_await transmit(req, hedge);
+        rate_limiter_->release(model, tokens, response);
+        co_return response;
     }
 
+    // Helper: Total timeout req is sent with; zero for none
+    std::chrono::milliseconds total_timeout(const http::Request& req) const {
+        auto total = req.timeouts.total.count() != 0 ? req.timeouts.total : http_client_->default_timeouts().total;
+        return std::max(total, std::chrono::milliseconds{0});
+    }
+
+    // Helper: Put one attempt on the wire, hedged when that is safe
+    asio::awaitable<http::Response> transmit(const http::Request& req, bool hedge) {
+        if (hedge && hedger_) {
+            co_return co_await http_client_->async_hedged_request(req, hedger_);
+        }
+        co_return co_await http_client_->async_request(req);
+    }
+
+    // Helper: Calls whose answer does not depend on which copy is served:
+    // embeddings, moderations, and completions sampled at temperature 0
+    static bool hedgeable(const http::Request& req) {
+        if (req.method != "POST" || req.on_body_chunk) {
+            return false;
+        }
+        if (req.path.ends_with("/v1/embeddings") || req.path.ends_with("/v1/moderations")) {
+            return true;
+        }
+        if (!req.path.ends_with("/v1/chat/completions") && !req.path.ends_with("/v1/completions")) {
+            return false;
+        }
+        bool deterministic = false;
+        try {
+            JsonReader reader(req.body);
+            reader.object([&](std::string_view key) {
+                if (key == "temperature" && reader.peek() == JsonType::Number) {
+                    double temperature = 1.0;
+                    reader.read(temperature);
+                    deterministic = temperature == 0.0;
+                } else {
+                    reader.skip();
+                }
+            });
+        } catch (const JsonError&) {
+            return false;
+        }
+        return deterministic;
+    }
+
+    static http::Response cancelled_response() {
+        http::Response response{0, "", {}, true, "Request cancelled"};
+        response.cancelled = true;
+        return response;
+    }
+
+    // Helper: ApiError for a request that got no HTTP response; type is
+    // "timeout" or "cancelled" when that was the cause
+    static ApiError transport_error(const http::Response& response) {
+        if (response.timed_out) {
+            return ApiError(0, response.error_message, "timeout");
+        }
+        if (response.cancelled) {
+            return ApiError(0, response.error_message, "cancelled");
+        }
+        return ApiError(response.error_message);
+    }
+
+    // Helper: Idempotent methods, POSTs carrying an Idempotency-Key, and
+    // POSTs to endpoints that only compute a result can be sent again
+    static bool safe_to_retry(const http::Request& req, const http::RetryPolicy& policy) {
+        if (req.method != "POST" && req.method != "PATCH") {
+            return true;
+        }
+        if (policy.retry_all_posts || req.headers.contains("Idempotency-Key")) {
+            return true;
+        }
+        static constexpr std::array<std::string_view, 9> computing_endpoints = {
+            "/v1/chat/completions", "/v1/completions", "/v1/embeddings", "/v1/moderations",
+            "/v1/images/generations", "/v1/images/edits", "/v1/images/variations",
+            "/v1/audio/transcriptions", "/v1/audio/translations",
+        };
+        return std::ranges::any_of(computing_endpoints, [&](std::string_view endpoint) { return req.path.ends_with(endpoint); });
+    }
+
+    // Helper: Transport errors and listed statuses, unless the server says
+    // otherwise with x-should-retry or asks for a wait beyond max_retry_after
+    static bool should_retry(const http::Response& response, const http::RetryPolicy& policy) {
+        if (auto wait = http::retry_after(response); wait && *wait > policy.max_retry_after) {
+            return false;
+        }
+        if (auto it = response.headers.find("x-should-retry"); it != response.headers.end()) {
+            if (it->second == "true") return true;
+            if (it->second == "false") return false;
+        }
+        return response.is_error || std::ranges::find(policy.retry_statuses, response.status_code) != policy.retry_statuses.end();
+    }
+
+    // Helper: Retry-After when the server sends one, otherwise exponential
+    // backoff with full jitter
+    static std::chrono::milliseconds retry_delay(int attempt, const http::Response& response,
+                                                 const http::RetryPolicy& policy) {
+        if (auto wait = http::retry_after(response)) {
+            return *wait;
+        }
+        auto ceiling = std::min<std::int64_t>(policy.max_backoff.count(),
+            policy.initial_backoff.count() << std::min(attempt, 20));
+        thread_local std::minstd_rand rng(std::random_device{}());
+        return std::chrono::milliseconds(std::uniform_int_distribution<std::int64_t>(0, std::max<std::int64_t>(ceiling, 0))(rng));
+    }
+
+    // Helper: Model and rough token cost of a JSON request body: about 4
+    // bytes per prompt token plus the completion budget it asks for
+    static std::pair<std::string, std::uint64_t> estimate_cost(const http::Request& req) {
+        std::string model;
+        std::uint64_t tokens = 0;
+        if (req.body.empty() || req.body.front() != '{') {
+            return {model, tokens};
+        }
+        try {
+            JsonReader reader(req.body);
+            reader.object([&](std::string_view key) {
+                if (key == "model" && reader.peek() == JsonType::String) {
+                    reader.read(model);
+                } else if ((key == "max_tokens" || key == "max_completion_tokens") && reader.peek() == JsonType::Number) {
+                    std::int64_t budget = 0;
+                    reader.read(budget);
+                    tokens += static_cast<std::uint64_t>(std::max<std::int64_t>(budget, 0));
+                } else {
+                    reader.skip();
+                }
+            });
+        } catch (const JsonError&) {
+        }
+        tokens += req.body.size() / 4;
+        return {model, tokens};
+    }
+
+    // Helper: Send req through the response cache. Hits return a synthesized
+    // 200 response; concurrent identical misses share one upstream call, and
+    // only 200 responses are stored.
+    asio::awaitable<http::Response> send_cached(const http::Request& req, CachePolicy policy) {
+        if (!response_cache_ || policy == CachePolicy::Bypass) {
+            if (response_cache_) {
+                ++response_cache_->metrics().bypassed;
+            }
+            co_return co_await send(req);
+        }
+        const auto how = handling(req);
+        if (route_) {
+            co_return co_await asio::co_spawn(executor(), send_through_cache(routed(req), how, policy), asio::use_awaitable);
+        }
+        co_return co_await asio::co_spawn(executor(), send_through_cache(req, how, policy), asio::use_awaitable);
+    }
+
+    // Helper: send_cached() on the strand, which guards in_flight_
+    asio::awaitable<http::Response> send_through_cache(const http::Request& req, Handling how, CachePolicy policy) {
+        const auto key = ResponseCache::make_key(req.path, req.body);
+        if (policy == CachePolicy::Default) {
+            if (auto body = response_cache_->find(key)) {
+                http::Response response;
+                response.status_code = 200;
+                response.body = std::move(*body);
+                co_return response;
+            }
+        }
+
+        if (auto it = in_flight_.find(key); it != in_flight_.end()) {
+            auto flight = it->second;
+            ++response_cache_->metrics().shared;
+            while (!flight->response) {
+                std::error_code ec;
+                co_await flight->done.async_wait(asio::redirect_error(asio::use_awaitable, ec));
+            }
+            co_return *flight->response;
+        }
+
+        auto flight = std::make_shared<Flight>(co_await asio::this_coro::executor);
+        in_flight_.emplace(key, flight);
+
+        // On every exit, including an exception or an abandoned call, drop
+        // the entry and wake callers that joined this request
+        struct Release {
+            BaseClient& client;
+            const ResponseCache::Key& key;
+            Flight& flight;
+
+            ~Release() {
+                if (!flight.response) {
+                    http::Response failed;
+                    failed.is_error = true;
+                    failed.error_message = "Shared request was abandoned";
+                    flight.response = std::move(failed);
+                }
+                if (auto it = client.in_flight_.find(key); it != client.in_flight_.end() && it->second.get() == &flight) {
+                    client.in_flight_.erase(it);
+                }
+                flight.done.cancel();
+            }
+        } release{*this, key, *flight};
+
+        auto response = co_await send_with_retries(req, how);
+        if (!response.is_error && response.status_code == 200) {
+            response_cache_->insert(key, response.body);
+        }
+        flight->response = response;
+        co_return response;
+    }
+
+    // Helper: Decode a JSON response body into T in a single pass
+    template <typename T>
+    std::expected<T, ApiError> parse_response(std::string_view body) const {
+        try {
+            return decode_json<T>(body);
+        } catch (const JsonError& e) {
+            return std::unexpected(ApiError(fmt::format("Invalid JSON response: {}", e.what())));
+        }
+    }
+
+    // Upstream call shared by identical cache misses
+    struct Flight {
+        explicit Flight(asio::any_io_executor executor)
+            : done(std::move(executor), std::chrono::steady_clock::time_point::max()) {}
+
+        asio::steady_timer done;  // Cancelled once response is set
+        std::optional<http::Response> response;
+    };
+
+    // Destination set by set_api_base() when it is not the default
+    struct Route {
+        bool use_ssl{true};
+        std::string host;
+        std::string port;
+        std::string prefix;  // Replaces "/v1" at the start of request paths
+    };
+
     // Protected members accessible to derived clients
     std::string api_key_;
     std::string organization_id_;
     std::string api_base_;
-    http::Client http_client_;
+    std::optional<Route> route_;
+    std::shared_ptr<http::Client> http_client_;
     asio::io_context& io_context_;
+    std::shared_ptr<http::RateLimiter> rate_limiter_;
+    http::RetryPolicy retry_policy_;
+    std::shared_ptr<http::RetryMetrics> retry_metrics_{std::make_shared<http::RetryMetrics>()};
+    std::unordered_set<asio::steady_timer*> backoff_timers_;  // Retry and rate limit waits in progress
+    std::shared_ptr<http::Hedger> hedger_;
+    std::shared_ptr<ResponseCache> response_cache_;
+    std::map<ResponseCache::Key, std::shared_ptr<Flight>> in_flight_;
 };
 
 } // namespace openai::client
@@ -0,0 +1,224 @@
+// Batch Client Module
+// Handles OpenAI Batch API operations
+
+export module openai.client.batch;
+
+import asio;
+import fmt;
+import openai.client.base;
+import openai.http_client;
+import openai.types.batch;
+import openai.types.file;
+import openai.types.json;
+import openai.types.common;
+import std;
+
+export namespace openai::client {
+
+// Batch API client
+class BatchClient : public BaseClient {
+public:
+    using BaseClient::BaseClient;
+
+    // Upload a batch input file (purpose "batch"). A file-backed input is
+    // flushed and streamed from disk; an in-memory one is sent in place.
+    asio::awaitable<std::expected<FileObject, ApiError>> upload_batch_input(BatchInput& input) {
+        std::string boundary = generate_boundary();
+
+        http::Request req;
+        req.method = "POST";
+        req.host = "api.openai.com";
+        req.path = "/v1/files";
+        req.use_ssl = true;
+
+        std::map<std::string, std::string> fields;
+        fields["purpose"] = "batch";
+
+        std::map<std::string, MultipartFile> files;
+        if (input.path().empty()) {
+            files["file"] = {"batch_input.jsonl", {}, input.data()};
+        } else {
+            files["file"] = {input.path().filename().string(), input.path().string(), {}};
+        }
+        try {
+            input.flush();
+            req.body_stream = build_multipart_body(fields, files, boundary);
+        } catch (const std::exception& e) {
+            co_return std::unexpected(ApiError(std::string("Failed to read batch input: ") + e.what()));
+        }
+        req.headers["Content-Type"] = "multipart/form-data; boundary=" + boundary;
+
+        add_auth_headers(req, false);
+
+        auto response = co_await send(req);
+
+        if (response.is_error) {
+            co_return std::unexpected(transport_error(response));
+        }
+
+        if (response.status_code != 200) {
+            co_return std::unexpected(ApiError(response.status_code,
+                fmt::format("HTTP {}: {}", response.status_code, response.body)));
+        }
+
+        co_return parse_response<FileObject>(response.body);
+    }
+
+    // Create batch
+    asio::awaitable<std::expected<Batch, ApiError>> create_batch(const BatchRequest& request) {
+        http::Request req;
+        req.method = "POST";
+        req.host = "api.openai.com";
+        req.path = "/v1/batches";
+        req.use_ssl = true;
+        req.body = request.to_json();
+
+        add_auth_headers(req);
+
+        co_return co_await send_batch_request(req);
+    }
+
+    // Upload input, then create a batch for its endpoint
+    asio::awaitable<std::expected<Batch, ApiError>> submit_batch(
+        BatchInput& input,
+        std::map<std::string, std::string> metadata = {},
+        std::string completion_window = "24h"
+    ) {
+        if (input.size() == 0) {
+            co_return std::unexpected(ApiError("Batch input is empty"));
+        }
+        auto file = co_await upload_batch_input(input);
+        if (!file) {
+            co_return std::unexpected(file.error());
+        }
+
+        BatchRequest request;
+        request.input_file_id = file->id;
+        request.endpoint = input.endpoint();
+        request.completion_window = std::move(completion_window);
+        request.metadata = std::move(metadata);
+        co_return co_await create_batch(request);
+    }
+
+    // Retrieve batch
+    asio::awaitable<std::expected<Batch, ApiError>> retrieve_batch(const std::string& batch_id) {
+        http::Request req;
+        req.method = "GET";
+        req.host = "api.openai.com";
+        req.path = fmt::format("/v1/batches/{}", batch_id);
+        req.use_ssl = true;
+
+        add_auth_headers(req);
+
+        co_return co_await send_batch_request(req);
+    }
+
+    // Cancel batch; it moves to "cancelling", then "cancelled"
+    asio::awaitable<std::expected<Batch, ApiError>> cancel_batch(const std::string& batch_id) {
+        http::Request req;
+        req.method = "POST";
+        req.host = "api.openai.com";
+        req.path = fmt::format("/v1/batches/{}/cancel", batch_id);
+        req.use_ssl = true;
+
+        add_auth_headers(req);
+
+        co_return co_await send_batch_request(req);
+    }
+
+    // List batches, newest first; pass the last id seen as after to page
+    asio::awaitable<std::expected<BatchListResponse, ApiError>> list_batches(
+        int limit = 20, const std::string& after = {}) {
+        http::Request req;
+        req.method = "GET";
+        req.host = "api.openai.com";
+        req.path = after.empty() ? fmt::format("/v1/batches?limit={}", limit)
+                                 : fmt::format("/v1/batches?limit={}&after={}", limit, after);
+        req.use_ssl = true;
+
+        add_auth_headers(req);
+
+        auto response = co_await send(req);
+
+        if (response.is_error) {
+            co_return std::unexpected(transport_error(response));
+        }
+
+        if (response.status_code != 200) {
+            co_return std::unexpected(ApiError(response.status_code,
+                fmt::format("HTTP {}: {}", response.status_code, response.body)));
+        }
+
+        co_return parse_response<BatchListResponse>(response.body);
+    }
+
+    // Stream a batch output or error file, passing each line decoded into
+    // Response (ChatCompletionResponse or EmbeddingResponse) to on_result
+    // as it arrives. Results come in no particular order; match them to
+    // requests by custom_id. Returns the number of results.
+    template <typename Response>
+    asio::awaitable<std::expected<std::size_t, ApiError>> read_batch_results(
+        const std::string& file_id,
+        std::function<void(BatchResult<Response>&&)> on_result,
+        http::ProgressCallback on_progress = {}
+    ) {
+        std::size_t count = 0;
+        std::optional<ApiError> parse_error;
+        http::LineSink sink([&](std::string_view line) {
+            if (line.empty() || parse_error) {
+                return;
+            }
+            try {
+                on_result(parse_batch_result<Response>(line));
+                ++count;
+            } catch (const JsonError& e) {
+                parse_error = ApiError(fmt::format("Invalid batch result line {}: {}", count + 1, e.what()));
+            }
+        });
+        sink.set_progress(std::move(on_progress));
+
+        http::Request req;
+        req.method = "GET";
+        req.host = "api.openai.com";
+        req.path = fmt::format("/v1/files/{}/content", file_id);
+        req.use_ssl = true;
+        sink.attach(req);
+
+        add_auth_headers(req);
+
+        auto response = co_await send(req);
+
+        if (response.is_error) {
+            co_return std::unexpected(transport_error(response));
+        }
+
+        if (response.status_code != 200) {
+            co_return std::unexpected(ApiError(response.status_code,
+                fmt::format("HTTP {}: {}", response.status_code, response.body)));
+        }
+
+        sink.finish();
+        if (parse_error) {
+            co_return std::unexpected(std::move(*parse_error));
+        }
+        co_return count;
+    }
+
+private:
+    asio::awaitable<std::expected<Batch, ApiError>> send_batch_request(const http::Request& req) {
+        auto response = co_await send(req);
+
+        if (response.is_error) {
+            co_return std::unexpected(transport_error(response));
+        }
+
+        if (response.status_code != 200) {
+            co_return std::unexpected(ApiError(response.status_code,
+                fmt::format("HTTP {}: {}", response.status_code, response.body)));
+        }
+
+        co_return parse_response<Batch>(response.body);
+    }
+};
+
+} // namespace openai::client
@@ -9,6 +9,7 @@ import openai.client.base;
 import openai.http_client;
 import openai.types.completion;
 import openai.types.common;
+import openai.types.response_cache;
 import std;
 
 export namespace openai::client {
@@ -18,8 +19,9 @@ class CompletionClient : public BaseClient {
 public:
     using BaseClient::BaseClient;
 
-    // Create text completion
-    asio::awaitable<std::expected<std::string, ApiError>> create_completion(const CompletionRequest& request) {
+    // Create text completion, answered from the response cache when one is set
+    asio::awaitable<std::expected<std::string, ApiError>> create_completion(
+        const CompletionRequest& request, CachePolicy cache = CachePolicy::Default) {
         http::Request req;
         req.method = "POST";
         req.host = "api.openai.com";
@@ -29,10 +31,10 @@ public:
         
         add_auth_headers(req);
         
-        auto response = co_await http_client_.async_request(req);
+        auto response = co_await send_cached(req, cache);
         
         if (response.is_error) {
-            co_return std::unexpected(ApiError(response.error_message));
+            co_return std::unexpected(transport_error(response));
         }
         
         if (response.status_code != 200) {
@@ -40,28 +42,15 @@ public:
                 fmt::format("HTTP {}: {}", response.status_code, response.body)));
         }
         
-        // Parse the first choice text
-        auto choices_pos = response.body.find("\"choices\":[");
-        if (choices_pos != std::string::npos) {
-            auto text_pos = response.body.find("\"text\":", choices_pos);
-            if (text_pos != std::string::npos) {
-                text_pos += 7;
-                auto text_start = response.body.find("\"", text_pos) + 1;
-                auto text_end = text_start;
-                
-                while (text_end < response.body.length()) {
-                    if (response.body[text_end] == '"' && 
-                        (text_end == 0 || response.body[text_end - 1] != '\\')) {
-                        break;
-                    }
-                    text_end++;
-                }
-                
-                co_return unescape_json(response.body.substr(text_start, text_end - text_start));
-            }
+        // Return the first choice text
+        auto completion = parse_response<CompletionResponse>(response.body);
+        if (!completion) {
+            co_return std::unexpected(completion.error());
         }
-        
-        co_return std::string("");
+        if (completion->choices.empty()) {
+            co_return std::string("");
+        }
+        co_return std::move(completion->choices.front().text);
     }
 };
 
@@ -8,6 +8,8 @@ import fmt;
 import openai.client.base;
 import openai.http_client;
 import openai.types.embedding;
+import openai.types.embedding_cache;
+import openai.types.embedding_matrix;
 import openai.types.common;
 import std;
 
@@ -18,139 +20,273 @@ class EmbeddingClient : public BaseClient {
 public:
     using BaseClient::BaseClient;
 
-    // Create embeddings for input text
+    // Merge concurrent create_embedding calls into shared array requests
+    void set_coalescing(EmbeddingCoalescingOptions options) {
+        coalescing_ = options;
+    }
+
+    const EmbeddingCoalescingOptions& coalescing() const { return coalescing_; }
+
+    // Serve repeated inputs from a cache; only uncached texts reach the API.
+    // The cache may be shared between clients. nullptr disables caching.
+    void set_cache(std::shared_ptr<EmbeddingCache> cache) {
+        cache_ = std::move(cache);
+    }
+
+    const std::shared_ptr<EmbeddingCache>& cache() const { return cache_; }
+
+    // Requests actually sent, and calls that joined an existing batch
+    std::uint64_t requests_sent() const { return requests_sent_.load(); }
+    std::uint64_t calls_coalesced() const { return calls_coalesced_.load(); }
+
+    // Create embeddings for input text. With coalescing enabled the call may
+    // share a request with others; data and indices are still the caller's
+    // own, and usage is its share of the merged request by input length.
+    // With a cache set, usage only counts the inputs that missed it.
     asio::awaitable<std::expected<EmbeddingResponse, ApiError>> create_embedding(const EmbeddingRequest& request) {
+        if (cache_ && !request.input.empty()) {
+            co_return co_await create_cached(request);
+        }
+        co_return co_await create_uncached(request);
+    }
+
+    // Create embeddings decoded straight into one contiguous matrix, row i
+    // holding input i. Always sent as its own request (not coalesced).
+    asio::awaitable<std::expected<EmbeddingMatrixResponse, ApiError>> create_embedding_matrix(
+        const EmbeddingRequest& request) {
+        co_return co_await send_embedding<EmbeddingMatrixResponse>(request);
+    }
+
+private:
+    // Requests merged into one API call
+    struct Batch {
+        explicit Batch(const asio::any_io_executor& executor)
+            : flush(executor, std::chrono::steady_clock::time_point::max())
+            , done(executor, std::chrono::steady_clock::time_point::max()) {}
+
+        EmbeddingRequest request;
+        std::size_t tokens{0};
+        std::size_t chars{0};
+        bool closed{false};        // No longer accepting inputs
+        asio::steady_timer flush;  // Coalescing window; cancelled to send early
+        asio::steady_timer done;   // Cancelled once result is set
+        std::optional<std::expected<EmbeddingResponse, ApiError>> result;
+    };
+
+    asio::awaitable<std::expected<EmbeddingResponse, ApiError>> create_uncached(const EmbeddingRequest& request) {
+        if (!coalescing_.enabled || request.input.empty()) {
+            co_return co_await send_embedding<EmbeddingResponse>(request);
+        }
+        // Batches are shared between callers, so they live on the strand
+        co_return co_await asio::co_spawn(executor(), coalesce(request), asio::use_awaitable);
+    }
+
+    // Fill hits from the cache, then fetch the distinct missing texts in one
+    // array request and store what comes back
+    asio::awaitable<std::expected<EmbeddingResponse, ApiError>> create_cached(const EmbeddingRequest& request) {
+        const auto& texts = request.input.texts;
+        const auto dimensions = request.dimensions.value_or(0);
+
+        EmbeddingResponse response;
+        response.object = "list";
+        response.model = request.model;
+        response.data.resize(texts.size());
+
+        EmbeddingRequest missing = request;
+        missing.input.texts.clear();
+        missing.input.array = true;
+        std::vector<EmbeddingCache::Key> missing_keys;
+        std::map<EmbeddingCache::Key, std::size_t> pending;  // Key -> index in missing
+        std::vector<std::optional<std::size_t>> source(texts.size());
+
+        for (std::size_t i = 0; i < texts.size(); ++i) {
+            auto& item = response.data[i];
+            item.object = "embedding";
+            item.index = static_cast<int>(i);
+            auto key = EmbeddingCache::make_key(request.model, dimensions, texts[i]);
+            if (cache_->find(key, item.embedding)) {
+                continue;
+            }
+            auto [it, inserted] = pending.try_emplace(key, missing_keys.size());
+            if (inserted) {
+                missing.input.texts.push_back(texts[i]);
+                missing_keys.push_back(key);
+            }
+            source[i] = it->second;
+        }
+        if (missing_keys.empty()) {
+            co_return response;
+        }
+
+        auto fetched = co_await create_uncached(missing);
+        if (!fetched) {
+            co_return std::unexpected(fetched.error());
+        }
+        auto& data = fetched->data;
+        if (data.size() != missing_keys.size()) {
+            co_return std::unexpected(ApiError(fmt::format(
+                "Embedding response has {} items for {} inputs", data.size(), missing_keys.size())));
+        }
+        std::ranges::sort(data, {}, &EmbeddingData::index);
+        for (std::size_t j = 0; j < data.size(); ++j) {
+            cache_->insert(missing_keys[j], data[j].embedding);
+        }
+        for (std::size_t i = 0; i < texts.size(); ++i) {
+            if (source[i]) {
+                response.data[i].embedding = data[*source[i]].embedding;
+            }
+        }
+        response.model = fetched->model;
+        response.usage = fetched->usage;
+        co_return response;
+    }
+
+    template <typename Response>
+    asio::awaitable<std::expected<Response, ApiError>> send_embedding(const EmbeddingRequest& request) {
         http::Request req;
         req.method = "POST";
         req.host = "api.openai.com";
         req.path = "/v1/embeddings";
         req.use_ssl = true;
         req.body = request.to_json();
-        
+
         add_auth_headers(req);
-        
-        auto response = co_await http_client_.async_request(req);
-        
+
+        ++requests_sent_;
+        auto response = co_await send(req);
+
         if (response.is_error) {
-            co_return std::unexpected(ApiError(response.error_message));
+            co_return std::unexpected(transport_error(response));
         }
-        
+
         if (response.status_code != 200) {
             co_return std::unexpected(ApiError(response.status_code,
                 fmt::format("HTTP {}: {}", response.status_code, response.body)));
         }
-        
-        co_return parse_embedding_response(response.body);
+
+        co_return parse_response<Response>(response.body);
     }
 
-private:
-    EmbeddingResponse parse_embedding_response(const std::string& json_str) {
+    asio::awaitable<std::expected<EmbeddingResponse, ApiError>> coalesce(const EmbeddingRequest& request) {
+        std::size_t chars = 0;
+        for (const auto& text : request.input.texts) {
+            chars += text.size();
+        }
+        const auto tokens = estimate_tokens(request.input);
+
+        // Too large to share a request with anyone
+        if (request.input.size() >= coalescing_.max_items || tokens >= coalescing_.max_tokens) {
+            co_return co_await send_embedding<EmbeddingResponse>(request);
+        }
+
+        const auto key = batch_key(request);
+        auto& slot = open_batches_[key];
+        if (slot && (slot->request.input.size() + request.input.size() > coalescing_.max_items ||
+                     slot->tokens + tokens > coalescing_.max_tokens)) {
+            close_batch(*slot);
+            slot.reset();
+        }
+        if (!slot) {
+            slot = std::make_shared<Batch>(executor());
+            slot->request = request;
+            slot->request.input.texts.clear();
+            slot->request.input.array = true;
+            slot->flush.expires_after(coalescing_.window);
+            asio::co_spawn(executor(), run_batch(key, slot), asio::detached);
+        } else {
+            ++calls_coalesced_;
+        }
+
+        auto batch = slot;
+        const auto offset = batch->request.input.size();
+        const auto count = request.input.size();
+        auto& texts = batch->request.input.texts;
+        texts.insert(texts.end(), request.input.texts.begin(), request.input.texts.end());
+        batch->tokens += tokens;
+        batch->chars += chars;
+        if (texts.size() >= coalescing_.max_items) {
+            close_batch(*batch);
+            open_batches_.erase(key);
+        }
+
+        while (!batch->result) {
+            std::error_code ec;
+            co_await batch->done.async_wait(asio::redirect_error(asio::use_awaitable, ec));
+        }
+        if (!*batch->result) {
+            co_return std::unexpected(batch->result->error());
+        }
+
+        // This caller's slice, re-indexed from zero
+        auto& merged = batch->result->value();
         EmbeddingResponse response;
-        
-        // Parse model
-        auto model_pos = json_str.find("\"model\":");
-        if (model_pos != std::string::npos) {
-            model_pos += 8;
-            auto model_start = json_str.find("\"", model_pos) + 1;
-            auto model_end = json_str.find("\"", model_start);
-            response.model = json_str.substr(model_start, model_end - model_start);
-        }
-        
-        // Parse data array
-        auto data_pos = json_str.find("\"data\":[");
-        if (data_pos != std::string::npos) {
-            auto data_start = data_pos + 8;
-            auto current_pos = data_start;
-            
-            while (true) {
-                auto obj_start = json_str.find("{", current_pos);
-                if (obj_start == std::string::npos) break;
-                
-                auto obj_end = json_str.find("}", obj_start);
-                if (obj_end == std::string::npos) break;
-                
-                auto obj_json = json_str.substr(obj_start, obj_end - obj_start + 1);
-                
-                EmbeddingData data;
-                
-                // Parse index
-                auto index_pos = obj_json.find("\"index\":");
-                if (index_pos != std::string::npos) {
-                    index_pos += 8;
-                    auto end_pos = obj_json.find_first_of(",}", index_pos);
-                    data.index = std::stoi(obj_json.substr(index_pos, end_pos - index_pos));
-                }
-                
-                // Parse embedding vector
-                auto embedding_pos = obj_json.find("\"embedding\":[");
-                if (embedding_pos != std::string::npos) {
-                    auto vec_start = embedding_pos + 13;
-                    auto vec_end = obj_json.find("]", vec_start);
-                    auto vec_str = obj_json.substr(vec_start, vec_end - vec_start);
-                    
-                    // Parse float values
-                    std::size_t pos = 0;
-                    while (pos < vec_str.length()) {
-                        auto next_comma = vec_str.find(",", pos);
-                        if (next_comma == std::string::npos) {
-                            next_comma = vec_str.length();
-                        }
-                        
-                        auto value_str = vec_str.substr(pos, next_comma - pos);
-                        // Trim whitespace
-                        value_str.erase(0, value_str.find_first_not_of(" \t\n\r"));
-                        value_str.erase(value_str.find_last_not_of(" \t\n\r") + 1);
-                        
-                        if (!value_str.empty()) {
-                            data.embedding.push_back(std::stod(value_str));
-                        }
-                        
-                        pos = next_comma + 1;
-                    }
-                }
-                
-                response.data.push_back(data);
-                
-                current_pos = obj_end + 1;
-                auto next_comma = json_str.find(",", current_pos);
-                auto array_end = json_str.find("]", current_pos);
-                
-                if (array_end != std::string::npos && 
-                    (next_comma == std::string::npos || array_end < next_comma)) {
-                    break;
-                }
+        response.object = merged.object;
+        response.model = merged.model;
+        response.data.resize(count);
+        std::vector<bool> filled(count);
+        std::size_t filled_count = 0;
+        for (auto& item : merged.data) {
+            auto index = static_cast<std::size_t>(item.index);
+            if (index >= offset && index < offset + count && !filled[index - offset]) {
+                filled[index - offset] = true;
+                ++filled_count;
+                item.index -= static_cast<int>(offset);
+                response.data[index - offset] = std::move(item);
             }
         }
-        
-        // Parse usage
-        auto usage_pos = json_str.find("\"usage\":{");
-        if (usage_pos != std::string::npos) {
-            auto usage_section = json_str.substr(usage_pos);
-            auto usage_end = usage_section.find("}");
-            usage_section = usage_section.substr(0, usage_end + 1);
-            
-            auto prompt_tokens_pos = usage_section.find("\"prompt_tokens\":");
-            if (prompt_tokens_pos != std::string::npos) {
-                prompt_tokens_pos += 16;
-                auto end_pos = usage_section.find_first_of(",}", prompt_tokens_pos);
-                response.usage.prompt_tokens = std::stoi(
-                    usage_section.substr(prompt_tokens_pos, end_pos - prompt_tokens_pos)
-                );
-            }
-            
-            auto total_tokens_pos = usage_section.find("\"total_tokens\":");
-            if (total_tokens_pos != std::string::npos) {
-                total_tokens_pos += 15;
-                auto end_pos = usage_section.find_first_of(",}", total_tokens_pos);
-                response.usage.total_tokens = std::stoi(
-                    usage_section.substr(total_tokens_pos, end_pos - total_tokens_pos)
-                );
-            }
+        if (filled_count != count) {
+            co_return std::unexpected(ApiError(fmt::format(
+                "Embedding response has {} items for {} inputs", filled_count, count)));
         }
-        
-        return response;
+        auto share = [&](int total) {
+            return batch->chars == 0 ? 0 : static_cast<int>(static_cast<std::uint64_t>(total) * chars / batch->chars);
+        };
+        response.usage.prompt_tokens = share(merged.usage.prompt_tokens);
+        response.usage.total_tokens = share(merged.usage.total_tokens);
+        co_return response;
     }
+
+    // Wait out the window (unless closed early), then send the merged request
+    asio::awaitable<void> run_batch(std::string key, std::shared_ptr<Batch> batch) {
+        if (!batch->closed) {
+            std::error_code ec;
+            co_await batch->flush.async_wait(asio::redirect_error(asio::use_awaitable, ec));
+        }
+        auto it = open_batches_.find(key);
+        if (it != open_batches_.end() && it->second == batch) {
+            open_batches_.erase(it);
+        }
+        batch->closed = true;
+
+        batch->result = co_await send_embedding<EmbeddingResponse>(batch->request);
+        batch->done.cancel();  // Wake every caller in the batch
+    }
+
+    static void close_batch(Batch& batch) {
+        batch.closed = true;
+        batch.flush.cancel();
+    }
+
+    // Calls can only share a request when everything but the input matches
+    static std::string batch_key(const EmbeddingRequest& request) {
+        return fmt::format("{}\n{}\n{}\n{}", request.model, request.encoding_format.value_or(""),
+            request.dimensions.value_or(0), request.user.value_or(""));
+    }
+
+    // Rough token count: about 4 bytes of English text per token
+    static std::size_t estimate_tokens(const EmbeddingInput& input) {
+        std::size_t tokens = 0;
+        for (const auto& text : input.texts) {
+            tokens += text.size() / 4 + 1;
+        }
+        return tokens;
+    }
+
+    EmbeddingCoalescingOptions coalescing_;
+    std::shared_ptr<EmbeddingCache> cache_;
+    std::unordered_map<std::string, std::shared_ptr<Batch>> open_batches_;
+    std::atomic<std::uint64_t> requests_sent_{0};
+    std::atomic<std::uint64_t> calls_coalesced_{0};
 };
 
 } // namespace openai::client
-
@@ -32,23 +32,26 @@ public:
         std::map<std::string, std::string> fields;
         fields["purpose"] = request.purpose;
         
-        std::map<std::string, std::pair<std::string, std::string>> files;
+        // Without a path, file_content is sent in place; the request outlives the call
+        std::map<std::string, MultipartFile> files;
+        if (request.file_path.empty()) {
+            files["file"] = {request.filename, {}, request.file_content};
+        } else {
+            files["file"] = {request.file_path, request.file_path, {}};
+        }
         try {
-            std::string file_content = read_file_content(request.file_path);
-            files["file"] = {request.file_path, file_content};
+            req.body_stream = build_multipart_body(fields, files, boundary);
         } catch (const std::exception& e) {
             co_return std::unexpected(ApiError(std::string("Failed to read file: ") + e.what()));
         }
-        
-        req.body = build_multipart_formdata(fields, files, boundary);
         req.headers["Content-Type"] = "multipart/form-data; boundary=" + boundary;
         
         add_auth_headers(req, false);
         
-        auto response = co_await http_client_.async_request(req);
+        auto response = co_await send(req);
         
         if (response.is_error) {
-            co_return std::unexpected(ApiError(response.error_message));
+            co_return std::unexpected(transport_error(response));
         }
         
         if (response.status_code != 200) {
@@ -56,7 +59,7 @@ public:
                 fmt::format("HTTP {}: {}", response.status_code, response.body)));
         }
         
-        co_return parse_file_upload_response(response.body);
+        co_return parse_response<FileUploadResponse>(response.body);
     }
 
     // List files
@@ -69,10 +72,10 @@ public:
         
         add_auth_headers(req);
         
-        auto response = co_await http_client_.async_request(req);
+        auto response = co_await send(req);
         
         if (response.is_error) {
-            co_return std::unexpected(ApiError(response.error_message));
+            co_return std::unexpected(transport_error(response));
         }
         
         if (response.status_code != 200) {
@@ -80,7 +83,7 @@ public:
                 fmt::format("HTTP {}: {}", response.status_code, response.body)));
         }
         
-        co_return parse_file_list_response(response.body);
+        co_return parse_response<FileListResponse>(response.body);
     }
 
     // Retrieve file metadata
@@ -93,10 +96,10 @@ public:
         
         add_auth_headers(req);
         
-        auto response = co_await http_client_.async_request(req);
+        auto response = co_await send(req);
         
         if (response.is_error) {
-            co_return std::unexpected(ApiError(response.error_message));
+            co_return std::unexpected(transport_error(response));
         }
         
         if (response.status_code != 200) {
@@ -104,10 +107,11 @@ public:
                 fmt::format("HTTP {}: {}", response.status_code, response.body)));
         }
         
-        co_return parse_file_object(response.body);
+        co_return parse_response<FileObject>(response.body);
     }
 
-    // Retrieve file content
+    // Retrieve file content, held in memory; large files are better streamed
+    // through one of the overloads below
     asio::awaitable<std::expected<FileContentResponse, ApiError>> retrieve_file_content(const std::string& file_id) {
         http::Request req;
         req.method = "GET";
@@ -117,10 +121,10 @@ public:
         
         add_auth_headers(req);
         
-        auto response = co_await http_client_.async_request(req);
+        auto response = co_await send(req);
         
         if (response.is_error) {
-            co_return std::unexpected(ApiError(response.error_message));
+            co_return std::unexpected(transport_error(response));
         }
         
         if (response.status_code != 200) {
@@ -133,20 +137,24 @@ public:
         co_return content_response;
     }
 
-    // Delete file
-    asio::awaitable<std::expected<bool, ApiError>> delete_file(const std::string& file_id) {
+    // Stream file content into sink (a http::FileSink, LineSink or
+    // ChunkSink) with constant memory, instead of returning it whole.
+    // Returns the number of bytes received.
+    asio::awaitable<std::expected<std::uint64_t, ApiError>> retrieve_file_content(
+        const std::string& file_id, http::BodySink& sink) {
         http::Request req;
-        req.method = "DELETE";
+        req.method = "GET";
         req.host = "api.openai.com";
-        req.path = fmt::format("/v1/files/{}", file_id);
+        req.path = fmt::format("/v1/files/{}/content", file_id);
         req.use_ssl = true;
+        sink.attach(req);
         
         add_auth_headers(req);
         
-        auto response = co_await http_client_.async_request(req);
+        auto response = co_await send(req);
         
         if (response.is_error) {
-            co_return std::unexpected(ApiError(response.error_message));
+            co_return std::unexpected(transport_error(response));
         }
         
         if (response.status_code != 200) {
@@ -154,120 +162,58 @@ public:
                 fmt::format("HTTP {}: {}", response.status_code, response.body)));
         }
         
-        // Check for "deleted": true
-        auto deleted_pos = response.body.find("\"deleted\":");
-        if (deleted_pos != std::string::npos) {
-            deleted_pos += 10;
-            auto end_pos = response.body.find_first_of(",}", deleted_pos);
-            auto value = response.body.substr(deleted_pos, end_pos - deleted_pos);
-            co_return (value == "true");
+        try {
+            sink.finish();
+        } catch (const std::exception& e) {
+            co_return std::unexpected(ApiError(e.what()));
         }
-        
-        co_return false;
+        co_return sink.received();
     }
 
-private:
-    FileUploadResponse parse_file_upload_response(const std::string& json_str) {
-        // FileUploadResponse is an alias for FileObject
-        return parse_file_object(json_str);
+    // Download file content to path
+    asio::awaitable<std::expected<std::uint64_t, ApiError>> download_file_content(
+        const std::string& file_id, const std::filesystem::path& path, http::ProgressCallback on_progress = {}) {
+        http::FileSink sink(path);
+        sink.set_progress(std::move(on_progress));
+        co_return co_await retrieve_file_content(file_id, sink);
     }
 
-    FileObject parse_file_object(const std::string& json_str) {
-        FileObject file;
-        
-        // Parse id
-        auto id_pos = json_str.find("\"id\":");
-        if (id_pos != std::string::npos) {
-            id_pos += 5;
-            auto id_start = json_str.find("\"", id_pos) + 1;
-            auto id_end = json_str.find("\"", id_start);
-            file.id = json_str.substr(id_start, id_end - id_start);
-        }
-        
-        // Parse filename
-        auto filename_pos = json_str.find("\"filename\":");
-        if (filename_pos != std::string::npos) {
-            filename_pos += 11;
-            auto filename_start = json_str.find("\"", filename_pos) + 1;
-            auto filename_end = json_str.find("\"", filename_start);
-            file.filename = json_str.substr(filename_start, filename_end - filename_start);
-        }
+    // Pass each line of file content to on_line as it arrives, e.g. the
+    // records of a batch output or fine-tuning results file
+    asio::awaitable<std::expected<std::uint64_t, ApiError>> read_file_lines(
+        const std::string& file_id, std::function<void(std::string_view)> on_line,
+        http::ProgressCallback on_progress = {}) {
+        http::LineSink sink(std::move(on_line));
+        sink.set_progress(std::move(on_progress));
+        co_return co_await retrieve_file_content(file_id, sink);
+    }
+
+    // Delete file
+    asio::awaitable<std::expected<bool, ApiError>> delete_file(const std::string& file_id) {
+        http::Request req;
+        req.method = "DELETE";
+        req.host = "api.openai.com";
+        req.path = fmt::format("/v1/files/{}", file_id);
+        req.use_ssl = true;
         
-        // Parse purpose
-        auto purpose_pos = json_str.find("\"purpose\":");
-        if (purpose_pos != std::string::npos) {
-            purpose_pos += 10;
-            auto purpose_start = json_str.find("\"", purpose_pos) + 1;
-            auto purpose_end = json_str.find("\"", purpose_start);
-            file.purpose = json_str.substr(purpose_start, purpose_end - purpose_start);
-        }
+        add_auth_headers(req);
         
-        // Parse bytes
-        auto bytes_pos = json_str.find("\"bytes\":");
-        if (bytes_pos != std::string::npos) {
-            bytes_pos += 8;
-            auto end_pos = json_str.find_first_of(",}", bytes_pos);
-            file.bytes = std::stoi(json_str.substr(bytes_pos, end_pos - bytes_pos));
-        }
+        auto response = co_await send(req);
         
-        // Parse created_at
-        auto created_pos = json_str.find("\"created_at\":");
-        if (created_pos != std::string::npos) {
-            created_pos += 13;
-            auto end_pos = json_str.find_first_of(",}", created_pos);
-            file.created_at = std::stoll(json_str.substr(created_pos, end_pos - created_pos));
+        if (response.is_error) {
+            co_return std::unexpected(transport_error(response));
         }
         
-        // Parse status
-        auto status_pos = json_str.find("\"status\":");
-        if (status_pos != std::string::npos) {
-            status_pos += 9;
-            auto status_start = json_str.find("\"", status_pos) + 1;
-            auto status_end = json_str.find("\"", status_start);
-            file.status = json_str.substr(status_start, status_end - status_start);
+        if (response.status_code != 200) {
+            co_return std::unexpected(ApiError(response.status_code,
+                fmt::format("HTTP {}: {}", response.status_code, response.body)));
         }
         
-        return file;
-    }
-
-    FileListResponse parse_file_list_response(const std::string& json_str) {
-        FileListResponse response;
-        
-        // Parse data array
-        auto data_pos = json_str.find("\"data\":[");
-        if (data_pos != std::string::npos) {
-            auto data_start = data_pos + 8;
-            auto current_pos = data_start;
-            
-            while (true) {
-                auto obj_start = json_str.find("{", current_pos);
-                if (obj_start == std::string::npos) break;
-                
-                int brace_count = 1;
-                auto obj_end = obj_start + 1;
-                
-                while (obj_end < json_str.length() && brace_count > 0) {
-                    if (json_str[obj_end] == '{') brace_count++;
-                    else if (json_str[obj_end] == '}') brace_count--;
-                    obj_end++;
-                }
-                
-                auto file_json = json_str.substr(obj_start, obj_end - obj_start);
-                response.data.push_back(parse_file_object(file_json));
-                
-                current_pos = obj_end;
-                auto next_comma = json_str.find(",", current_pos);
-                auto array_end = json_str.find("]", current_pos);
-                
-                if (array_end != std::string::npos && 
-                    (next_comma == std::string::npos || array_end < next_comma)) {
-                    break;
-                }
-                current_pos = next_comma + 1;
-            }
+        auto deleted = parse_response<FileDeleteResponse>(response.body);
+        if (!deleted) {
+            co_return std::unexpected(deleted.error());
         }
-        
-        return response;
+        co_return deleted->deleted;
     }
 };
 
@@ -29,10 +29,10 @@ public:
         
         add_auth_headers(req);
         
-        auto response = co_await http_client_.async_request(req);
+        auto response = co_await send(req);
         
         if (response.is_error) {
-            co_return std::unexpected(ApiError(response.error_message));
+            co_return std::unexpected(transport_error(response));
         }
         
         if (response.status_code != 200) {
@@ -40,7 +40,7 @@ public:
                 fmt::format("HTTP {}: {}", response.status_code, response.body)));
         }
         
-        co_return parse_image_response(response.body);
+        co_return parse_response<ImageResponse>(response.body);
     }
 
     // Edit image
@@ -66,28 +66,24 @@ public:
             fields["response_format"] = *request.response_format;
         }
         
-        std::map<std::string, std::pair<std::string, std::string>> files;
+        std::map<std::string, MultipartFile> files;
+        files["image"] = {request.image_path, request.image_path, {}};
+        if (request.mask && !request.mask->empty()) {
+            files["mask"] = {*request.mask, *request.mask, {}};
+        }
         try {
-            std::string image_content = read_file_content(request.image_path);
-            files["image"] = {request.image_path, image_content};
-            
-            if (request.mask && !request.mask->empty()) {
-                std::string mask_content = read_file_content(*request.mask);
-                files["mask"] = {*request.mask, mask_content};
-            }
+            req.body_stream = build_multipart_body(fields, files, boundary);
         } catch (const std::exception& e) {
             co_return std::unexpected(ApiError(std::string("Failed to read image file: ") + e.what()));
         }
-        
-        req.body = build_multipart_formdata(fields, files, boundary);
         req.headers["Content-Type"] = "multipart/form-data; boundary=" + boundary;
         
         add_auth_headers(req, false);
         
-        auto response = co_await http_client_.async_request(req);
+        auto response = co_await send(req);
         
         if (response.is_error) {
-            co_return std::unexpected(ApiError(response.error_message));
+            co_return std::unexpected(transport_error(response));
         }
         
         if (response.status_code != 200) {
@@ -95,7 +91,7 @@ public:
                 fmt::format("HTTP {}: {}", response.status_code, response.body)));
         }
         
-        co_return parse_image_response(response.body);
+        co_return parse_response<ImageResponse>(response.body);
     }
 
     // Create image variation
@@ -120,23 +116,21 @@ public:
             fields["response_format"] = *request.response_format;
         }
         
-        std::map<std::string, std::pair<std::string, std::string>> files;
+        std::map<std::string, MultipartFile> files;
+        files["image"] = {request.image_path, request.image_path, {}};
         try {
-            std::string image_content = read_file_content(request.image_path);
-            files["image"] = {request.image_path, image_content};
+            req.body_stream = build_multipart_body(fields, files, boundary);
         } catch (const std::exception& e) {
             co_return std::unexpected(ApiError(std::string("Failed to read image file: ") + e.what()));
         }
-        
-        req.body = build_multipart_formdata(fields, files, boundary);
         req.headers["Content-Type"] = "multipart/form-data; boundary=" + boundary;
         
         add_auth_headers(req, false);
         
-        auto response = co_await http_client_.async_request(req);
+        auto response = co_await send(req);
         
         if (response.is_error) {
-            co_return std::unexpected(ApiError(response.error_message));
+            co_return std::unexpected(transport_error(response));
         }
         
         if (response.status_code != 200) {
@@ -144,70 +138,7 @@ public:
                 fmt::format("HTTP {}: {}", response.status_code, response.body)));
         }
         
-        co_return parse_image_response(response.body);
-    }
-
-private:
-    ImageResponse parse_image_response(const std::string& json_str) {
-        ImageResponse response;
-        
-        // Parse created timestamp
-        auto created_pos = json_str.find("\"created\":");
-        if (created_pos != std::string::npos) {
-            created_pos += 10;
-            auto end_pos = json_str.find_first_of(",}", created_pos);
-            response.created = std::stoll(json_str.substr(created_pos, end_pos - created_pos));
-        }
-        
-        // Parse data array
-        auto data_pos = json_str.find("\"data\":[");
-        if (data_pos != std::string::npos) {
-            auto data_start = data_pos + 8;
-            auto current_pos = data_start;
-            
-            while (true) {
-                auto obj_start = json_str.find("{", current_pos);
-                if (obj_start == std::string::npos) break;
-                
-                auto obj_end = json_str.find("}", obj_start);
-                if (obj_end == std::string::npos) break;
-                
-                auto obj_json = json_str.substr(obj_start, obj_end - obj_start + 1);
-                
-                ImageData data;
-                
-                // Parse URL
-                auto url_pos = obj_json.find("\"url\":");
-                if (url_pos != std::string::npos) {
-                    url_pos += 6;
-                    auto url_start = obj_json.find("\"", url_pos) + 1;
-                    auto url_end = obj_json.find("\"", url_start);
-                    data.url = obj_json.substr(url_start, url_end - url_start);
-                }
-                
-                // Parse revised_prompt (DALL-E 3)
-                auto revised_pos = obj_json.find("\"revised_prompt\":");
-                if (revised_pos != std::string::npos) {
-                    revised_pos += 17;
-                    auto revised_start = obj_json.find("\"", revised_pos) + 1;
-                    auto revised_end = obj_json.find("\"", revised_start);
-                    data.revised_prompt = obj_json.substr(revised_start, revised_end - revised_start);
-                }
-                
-                response.data.push_back(data);
-                
-                current_pos = obj_end + 1;
-                auto next_comma = json_str.find(",", current_pos);
-                auto array_end = json_str.find("]", current_pos);
-                
-                if (array_end != std::string::npos && 
-                    (next_comma == std::string::npos || array_end < next_comma)) {
-                    break;
-                }
-            }
-        }
-        
-        return response;
+        co_return parse_response<ImageResponse>(response.body);
     }
 };
 
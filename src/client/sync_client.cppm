@@ -0,0 +1,77 @@
+// Sync Client Module
+// Blocking facade over Client, driven by its own background threads
+
+export module openai.client.sync;
+
+import asio;
+import openai.client.unified;
+import openai.types;
+import openai.types.common;
+import std;
+
+export namespace openai {
+
+// Blocking access to the API for threads that do not run an io_context.
+// The client runs on an io_context owned by background threads; each call
+// is posted there and the caller waits on a future, so any number of worker
+// threads can call at once without taking turns driving one loop.
+class SyncClient {
+public:
+    explicit SyncClient(std::string api_key, std::size_t threads = 1)
+        : work_(asio::make_work_guard(io_context_))
+        , client_(std::move(api_key), io_context_) {
+        for (std::size_t i = 0; i < std::max<std::size_t>(threads, 1); ++i) {
+            threads_.emplace_back([this] { io_context_.run(); });
+        }
+    }
+
+    // Calls still in flight are cancelled and complete with an error. The
+    // threads exit once the io_context has run out of work, so no coroutine
+    // frame outlives the client; coroutines spawned on executor() must
+    // finish by then too.
+    ~SyncClient() {
+        client_.cancel_all();
+        client_.close_http2_sessions();
+        work_.reset();
+        for (auto& thread : threads_) {
+            thread.join();
+        }
+    }
+
+    SyncClient(const SyncClient&) = delete;
+    SyncClient& operator=(const SyncClient&) = delete;
+
+    // The wrapped client, for configuration and for awaiting calls from
+    // coroutines spawned on executor()
+    Client& client() { return client_; }
+    asio::any_io_executor executor() { return io_context_.get_executor(); }
+
+    // Run one API call on the background threads and wait for its result:
+    //   sync.call([&](Client& c) { return c.create_moderation(request); });
+    // Throws std::logic_error when called from a background thread.
+    template <typename F>
+    auto call(F&& f) {
+        if (io_context_.get_executor().running_in_this_thread()) {
+            throw std::logic_error("SyncClient::call() from one of its own threads would block it");
+        }
+        return asio::co_spawn(io_context_, std::invoke(std::forward<F>(f), client_), asio::use_future).get();
+    }
+
+    std::expected<ChatCompletionResponse, ApiError> create_chat_completion(const ChatCompletionRequest& request) {
+        return call([&](Client& client) { return client.create_chat_completion(request); });
+    }
+
+    std::expected<EmbeddingResponse, ApiError> create_embedding(const EmbeddingRequest& request) {
+        return call([&](Client& client) { return client.create_embedding(request); });
+    }
+
+private:
+    // The client's timers and sockets belong to io_context_, so it is
+    // destroyed after the client; the destructor drains it first
+    asio::io_context io_context_;
+    asio::executor_work_guard<asio::io_context::executor_type> work_;
+    Client client_;
+    std::vector<std::thread> threads_;
+};
+
+} // namespace openai
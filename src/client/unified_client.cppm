@@ -4,6 +4,7 @@
 export module openai.client.unified;
 
 import asio;
+import openai.http_client;
 import openai.client.base;
 import openai.client.model;
 import openai.client.chat;
@@ -13,6 +14,7 @@ import openai.client.completion;
 import openai.client.moderation;
 import openai.client.file;
 import openai.client.fine_tuning;
+import openai.client.batch;
 import openai.client.audio;
 import openai.client.assistant;
 import openai.client.thread;
@@ -24,66 +26,138 @@ import std;
 export namespace openai {
 
 // Unified OpenAI API Client
-// Composes all specialized API clients into a single interface
+// Composes all specialized API clients into a single interface. They share
+// one transport (TLS context, connection pool, DNS cache, metrics) and are
+// created on first use, each picking up the settings made so far.
 class Client {
 public:
     explicit Client(std::string api_key, asio::io_context& io_context)
-        : model_client_(api_key, io_context)
-        , chat_client_(api_key, io_context)
-        , image_client_(api_key, io_context)
-        , embedding_client_(api_key, io_context)
-        , completion_client_(api_key, io_context)
-        , moderation_client_(api_key, io_context)
-        , file_client_(api_key, io_context)
-        , fine_tuning_client_(api_key, io_context)
-        , audio_client_(api_key, io_context)
-        , assistant_client_(api_key, io_context)
-        , thread_client_(api_key, io_context)
-        , run_client_(api_key, io_context)
-        , api_key_(std::move(api_key))
-        , io_context_(io_context) {}
-
-    // Configuration methods
+        : Client(std::move(api_key), std::make_shared<http::Client>(io_context)) {}
+
+    // Share transport with other Clients, e.g. one per tenant API key, so
+    // they load the CA store once and draw on one connection pool. Transport
+    // settings (HTTP version, compression, timeouts, cancel_all()) then apply
+    // to all of them.
+    Client(std::string api_key, std::shared_ptr<http::Client> transport)
+        : transport_(std::move(transport))
+        , rate_limiter_(std::make_shared<http::RateLimiter>())
+        , retry_metrics_(std::make_shared<http::RetryMetrics>())
+        , api_key_(std::move(api_key)) {}
+
+    // Configuration methods. set_api_base() redirects every API call, e.g.
+    // to a proxy or a local stand-in server ("http://127.0.0.1:8080/v1").
     void set_api_base(std::string base_url) {
-        model_client_.set_api_base(base_url);
-        chat_client_.set_api_base(base_url);
-        image_client_.set_api_base(base_url);
-        embedding_client_.set_api_base(base_url);
-        completion_client_.set_api_base(base_url);
-        moderation_client_.set_api_base(base_url);
-        file_client_.set_api_base(base_url);
-        fine_tuning_client_.set_api_base(base_url);
-        audio_client_.set_api_base(base_url);
-        assistant_client_.set_api_base(base_url);
-        thread_client_.set_api_base(base_url);
-        run_client_.set_api_base(base_url);
+        if (!base_url.starts_with("http://") && !base_url.starts_with("https://")) {
+            throw std::invalid_argument("API base must be an http:// or https:// URL: " + base_url);
+        }
+        configure([&](Settings& settings) { settings.api_base = base_url; },
+                  [&](client::BaseClient& client) { client.set_api_base(base_url); });
     }
 
     void set_organization(std::string org_id) {
-        model_client_.set_organization(org_id);
-        chat_client_.set_organization(org_id);
-        image_client_.set_organization(org_id);
-        embedding_client_.set_organization(org_id);
-        completion_client_.set_organization(org_id);
-        moderation_client_.set_organization(org_id);
-        file_client_.set_organization(org_id);
-        fine_tuning_client_.set_organization(org_id);
-        audio_client_.set_organization(org_id);
-        assistant_client_.set_organization(org_id);
-        thread_client_.set_organization(org_id);
-        run_client_.set_organization(org_id);
+        configure([&](Settings& settings) { settings.organization = org_id; },
+                  [&](client::BaseClient& client) { client.set_organization(org_id); });
     }
 
+    // Use HTTP/2 (negotiated via ALPN) or HTTP/1.1 for all API calls
+    void set_http_version(http::HttpVersion version) {
+        transport_->set_http_version(version);
+    }
+
+    // Close open HTTP/2 sessions so io_context::run() can return
+    void close_http2_sessions() {
+        transport_->close_http2_sessions();
+    }
+
+    // Ask for gzip/deflate responses and gzip request bodies of at least
+    // min_request_size for all API calls; see transport().metrics()
+    void set_compression(const http::CompressionOptions& options) {
+        transport_->set_compression(options);
+    }
+
+    // Replace the shared rate limiter (nullptr disables pacing)
+    void set_rate_limiter(std::shared_ptr<http::RateLimiter> limiter) {
+        configure([&](Settings&) { rate_limiter_ = limiter; },
+                  [&](client::BaseClient& client) { client.set_rate_limiter(limiter); });
+    }
+
+    // Configure pacing, e.g. with known limits to apply before any headers arrive
+    void set_rate_limits(http::RateLimitOptions options) {
+        set_rate_limiter(std::make_shared<http::RateLimiter>(options));
+    }
+
+    const std::shared_ptr<http::RateLimiter>& rate_limiter() const { return rate_limiter_; }
+
+    // Retry transient failures of every API call (max_retries = 0 disables)
+    void set_retry_policy(const http::RetryPolicy& policy) {
+        configure([&](Settings& settings) { settings.retry_policy = policy; },
+                  [&](client::BaseClient& client) { client.set_retry_policy(policy); });
+    }
+
+    const http::RetryMetrics& retry_metrics() const { return *retry_metrics_; }
+
+    // Hedge slow embedding, moderation and temperature-0 completion calls:
+    // after a latency percentile of recent calls without a response, send a
+    // duplicate and take whichever answers first. nullptr disables hedging.
+    void set_hedger(std::shared_ptr<http::Hedger> hedger) {
+        configure([&](Settings&) { hedger_ = hedger; },
+                  [&](client::BaseClient& client) { client.set_hedger(hedger); });
+    }
+
+    void set_hedging(http::HedgeOptions options) {
+        set_hedger(std::make_shared<http::Hedger>(options));
+    }
+
+    const std::shared_ptr<http::Hedger>& hedger() const { return hedger_; }
+
+    // Per-phase limits (connect, TLS handshake, first byte, idle read, total)
+    // for every API call; Request::timeouts overrides them per request
+    void set_timeouts(const http::Timeouts& timeouts) {
+        transport_->set_default_timeouts(timeouts);
+    }
+
+    // Abort every API call in flight or waiting to retry; each returns an
+    // error whose Response had cancelled set
+    void cancel_all() {
+        configure([](Settings&) {}, [](client::BaseClient& client) { client.cancel_all(); });
+    }
+
+    // Cache chat and completion responses; identical requests share a cached
+    // body and concurrent identical misses share one upstream call
+    void set_response_cache(std::shared_ptr<ResponseCache> cache) {
+        configure([&](Settings& settings) { settings.response_cache = cache; },
+                  [&](client::BaseClient& client) { client.set_response_cache(cache); });
+    }
+
+    // The transport every API call goes through, e.g. for its metrics()
+    http::Client& transport() { return *transport_; }
+    const http::Client& transport() const { return *transport_; }
+
+    // Specialized clients, created on first use
+    client::ModelClient& model_client() { return get<client::ModelClient>(); }
+    client::ChatClient& chat_client() { return get<client::ChatClient>(); }
+    client::ImageClient& image_client() { return get<client::ImageClient>(); }
+    client::EmbeddingClient& embedding_client() { return get<client::EmbeddingClient>(); }
+    client::CompletionClient& completion_client() { return get<client::CompletionClient>(); }
+    client::ModerationClient& moderation_client() { return get<client::ModerationClient>(); }
+    client::FileClient& file_client() { return get<client::FileClient>(); }
+    client::FineTuningClient& fine_tuning_client() { return get<client::FineTuningClient>(); }
+    client::BatchClient& batch_client() { return get<client::BatchClient>(); }
+    client::AudioClient& audio_client() { return get<client::AudioClient>(); }
+    client::AssistantClient& assistant_client() { return get<client::AssistantClient>(); }
+    client::ThreadClient& thread_client() { return get<client::ThreadClient>(); }
+    client::RunClient& run_client() { return get<client::RunClient>(); }
+
     // ========================================================================
     // Models API - Delegated to ModelClient
     // ========================================================================
     
     asio::awaitable<std::expected<ModelList, ApiError>> list_models() {
-        co_return co_await model_client_.list_models();
+        co_return co_await model_client().list_models();
     }
 
     asio::awaitable<std::expected<Model, ApiError>> retrieve_model(const std::string& model_id) {
-        co_return co_await model_client_.retrieve_model(model_id);
+        co_return co_await model_client().retrieve_model(model_id);
     }
 
     // ========================================================================
@@ -91,15 +165,23 @@ public:
     // ========================================================================
     
     asio::awaitable<std::expected<ChatCompletionResponse, ApiError>> create_chat_completion(
-        const ChatCompletionRequest& request
+        const ChatCompletionRequest& request,
+        CachePolicy cache = CachePolicy::Default
     ) {
-        co_return co_await chat_client_.create_chat_completion(request);
+        co_return co_await chat_client().create_chat_completion(request, cache);
     }
 
     std::expected<ChatCompletionResponse, ApiError> create_chat_completion_sync(
         const ChatCompletionRequest& request
     ) {
-        return chat_client_.create_chat_completion_sync(request);
+        return chat_client().create_chat_completion_sync(request);
+    }
+
+    asio::awaitable<std::expected<ChatCompletionResponse, ApiError>> create_chat_completion_stream(
+        ChatCompletionRequest request,
+        std::function<void(const ChatCompletionChunk&)> on_chunk
+    ) {
+        co_return co_await chat_client().create_chat_completion_stream(std::move(request), std::move(on_chunk));
     }
 
     // ========================================================================
@@ -107,23 +189,24 @@ public:
     // ========================================================================
     
     asio::awaitable<std::expected<ImageResponse, ApiError>> generate_image(const ImageGenerationRequest& request) {
-        co_return co_await image_client_.generate_image(request);
+        co_return co_await image_client().generate_image(request);
     }
 
     asio::awaitable<std::expected<ImageResponse, ApiError>> edit_image(const ImageEditRequest& request) {
-        co_return co_await image_client_.edit_image(request);
+        co_return co_await image_client().edit_image(request);
     }
 
     asio::awaitable<std::expected<ImageResponse, ApiError>> create_image_variation(const ImageVariationRequest& request) {
-        co_return co_await image_client_.create_image_variation(request);
+        co_return co_await image_client().create_image_variation(request);
     }
 
     // ========================================================================
     // Completions API (Legacy) - Delegated to CompletionClient
     // ========================================================================
     
-    asio::awaitable<std::expected<std::string, ApiError>> create_completion(const CompletionRequest& request) {
-        co_return co_await completion_client_.create_completion(request);
+    asio::awaitable<std::expected<std::string, ApiError>> create_completion(
+        const CompletionRequest& request, CachePolicy cache = CachePolicy::Default) {
+        co_return co_await completion_client().create_completion(request, cache);
     }
 
     // ========================================================================
@@ -131,7 +214,23 @@ public:
     // ========================================================================
     
     asio::awaitable<std::expected<EmbeddingResponse, ApiError>> create_embedding(const EmbeddingRequest& request) {
-        co_return co_await embedding_client_.create_embedding(request);
+        co_return co_await embedding_client().create_embedding(request);
+    }
+
+    // Embeddings decoded into one contiguous, aligned matrix
+    asio::awaitable<std::expected<EmbeddingMatrixResponse, ApiError>> create_embedding_matrix(
+        const EmbeddingRequest& request) {
+        co_return co_await embedding_client().create_embedding_matrix(request);
+    }
+
+    // Merge concurrent create_embedding calls into shared array requests
+    void set_embedding_coalescing(EmbeddingCoalescingOptions options) {
+        embedding_client().set_coalescing(options);
+    }
+
+    // Serve repeated embedding inputs from a (possibly persistent) cache
+    void set_embedding_cache(std::shared_ptr<EmbeddingCache> cache) {
+        embedding_client().set_cache(std::move(cache));
     }
 
     // ========================================================================
@@ -139,23 +238,40 @@ public:
     // ========================================================================
     
     asio::awaitable<std::expected<FileUploadResponse, ApiError>> upload_file(const FileUploadRequest& request) {
-        co_return co_await file_client_.upload_file(request);
+        co_return co_await file_client().upload_file(request);
     }
 
     asio::awaitable<std::expected<FileListResponse, ApiError>> list_files() {
-        co_return co_await file_client_.list_files();
+        co_return co_await file_client().list_files();
     }
 
     asio::awaitable<std::expected<FileObject, ApiError>> retrieve_file(const std::string& file_id) {
-        co_return co_await file_client_.retrieve_file(file_id);
+        co_return co_await file_client().retrieve_file(file_id);
     }
 
     asio::awaitable<std::expected<FileContentResponse, ApiError>> retrieve_file_content(const std::string& file_id) {
-        co_return co_await file_client_.retrieve_file_content(file_id);
+        co_return co_await file_client().retrieve_file_content(file_id);
+    }
+
+    // Stream file content with constant memory; each returns the bytes received
+    asio::awaitable<std::expected<std::uint64_t, ApiError>> retrieve_file_content(
+        const std::string& file_id, http::BodySink& sink) {
+        co_return co_await file_client().retrieve_file_content(file_id, sink);
+    }
+
+    asio::awaitable<std::expected<std::uint64_t, ApiError>> download_file_content(
+        const std::string& file_id, const std::filesystem::path& path, http::ProgressCallback on_progress = {}) {
+        co_return co_await file_client().download_file_content(file_id, path, std::move(on_progress));
+    }
+
+    asio::awaitable<std::expected<std::uint64_t, ApiError>> read_file_lines(
+        const std::string& file_id, std::function<void(std::string_view)> on_line,
+        http::ProgressCallback on_progress = {}) {
+        co_return co_await file_client().read_file_lines(file_id, std::move(on_line), std::move(on_progress));
     }
 
     asio::awaitable<std::expected<bool, ApiError>> delete_file(const std::string& file_id) {
-        co_return co_await file_client_.delete_file(file_id);
+        co_return co_await file_client().delete_file(file_id);
     }
 
     // ========================================================================
@@ -163,19 +279,64 @@ public:
     // ========================================================================
     
     asio::awaitable<std::expected<FineTuningJobResponse, ApiError>> create_fine_tuning_job(const FineTuningRequest& request) {
-        co_return co_await fine_tuning_client_.create_fine_tuning_job(request);
+        co_return co_await fine_tuning_client().create_fine_tuning_job(request);
     }
 
     asio::awaitable<std::expected<FineTuningJobListResponse, ApiError>> list_fine_tuning_jobs(int limit = 20) {
-        co_return co_await fine_tuning_client_.list_fine_tuning_jobs(limit);
+        co_return co_await fine_tuning_client().list_fine_tuning_jobs(limit);
     }
 
     asio::awaitable<std::expected<FineTuningJobResponse, ApiError>> retrieve_fine_tuning_job(const std::string& job_id) {
-        co_return co_await fine_tuning_client_.retrieve_fine_tuning_job(job_id);
+        co_return co_await fine_tuning_client().retrieve_fine_tuning_job(job_id);
     }
 
     asio::awaitable<std::expected<FineTuningJobResponse, ApiError>> cancel_fine_tuning_job(const std::string& job_id) {
-        co_return co_await fine_tuning_client_.cancel_fine_tuning_job(job_id);
+        co_return co_await fine_tuning_client().cancel_fine_tuning_job(job_id);
+    }
+
+    // ========================================================================
+    // Batch API - Delegated to BatchClient
+    // ========================================================================
+    
+    asio::awaitable<std::expected<FileObject, ApiError>> upload_batch_input(BatchInput& input) {
+        co_return co_await batch_client().upload_batch_input(input);
+    }
+
+    asio::awaitable<std::expected<Batch, ApiError>> create_batch(const BatchRequest& request) {
+        co_return co_await batch_client().create_batch(request);
+    }
+
+    // Upload input, then create a batch for its endpoint
+    asio::awaitable<std::expected<Batch, ApiError>> submit_batch(
+        BatchInput& input,
+        std::map<std::string, std::string> metadata = {},
+        std::string completion_window = "24h"
+    ) {
+        co_return co_await batch_client().submit_batch(input, std::move(metadata), std::move(completion_window));
+    }
+
+    asio::awaitable<std::expected<Batch, ApiError>> retrieve_batch(const std::string& batch_id) {
+        co_return co_await batch_client().retrieve_batch(batch_id);
+    }
+
+    asio::awaitable<std::expected<Batch, ApiError>> cancel_batch(const std::string& batch_id) {
+        co_return co_await batch_client().cancel_batch(batch_id);
+    }
+
+    asio::awaitable<std::expected<BatchListResponse, ApiError>> list_batches(
+        int limit = 20, const std::string& after = {}) {
+        co_return co_await batch_client().list_batches(limit, after);
+    }
+
+    // Stream an output or error file as typed results, matched by custom_id
+    template <typename Response>
+    asio::awaitable<std::expected<std::size_t, ApiError>> read_batch_results(
+        const std::string& file_id,
+        std::function<void(BatchResult<Response>&&)> on_result,
+        http::ProgressCallback on_progress = {}
+    ) {
+        co_return co_await batch_client().read_batch_results<Response>(
+            file_id, std::move(on_result), std::move(on_progress));
     }
 
     // ========================================================================
@@ -183,11 +344,11 @@ public:
     // ========================================================================
     
     asio::awaitable<std::expected<AudioResponse, ApiError>> create_transcription(const AudioTranscriptionRequest& request) {
-        co_return co_await audio_client_.create_transcription(request);
+        co_return co_await audio_client().create_transcription(request);
     }
 
     asio::awaitable<std::expected<AudioResponse, ApiError>> create_translation(const AudioTranslationRequest& request) {
-        co_return co_await audio_client_.create_translation(request);
+        co_return co_await audio_client().create_translation(request);
     }
 
     // ========================================================================
@@ -195,7 +356,7 @@ public:
     // ========================================================================
     
     asio::awaitable<std::expected<ModerationResponse, ApiError>> create_moderation(const ModerationRequest& request) {
-        co_return co_await moderation_client_.create_moderation(request);
+        co_return co_await moderation_client().create_moderation(request);
     }
 
     // ========================================================================
@@ -203,26 +364,26 @@ public:
     // ========================================================================
     
     asio::awaitable<std::expected<Assistant, ApiError>> create_assistant(const CreateAssistantRequest& request) {
-        co_return co_await assistant_client_.create_assistant(request);
+        co_return co_await assistant_client().create_assistant(request);
     }
 
     asio::awaitable<std::expected<AssistantListResponse, ApiError>> list_assistants(int limit = 20) {
-        co_return co_await assistant_client_.list_assistants(limit);
+        co_return co_await assistant_client().list_assistants(limit);
     }
 
     asio::awaitable<std::expected<Assistant, ApiError>> retrieve_assistant(const std::string& assistant_id) {
-        co_return co_await assistant_client_.retrieve_assistant(assistant_id);
+        co_return co_await assistant_client().retrieve_assistant(assistant_id);
     }
 
     asio::awaitable<std::expected<Assistant, ApiError>> modify_assistant(
         const std::string& assistant_id,
         const ModifyAssistantRequest& request
     ) {
-        co_return co_await assistant_client_.modify_assistant(assistant_id, request);
+        co_return co_await assistant_client().modify_assistant(assistant_id, request);
     }
 
     asio::awaitable<std::expected<DeleteAssistantResponse, ApiError>> delete_assistant(const std::string& assistant_id) {
-        co_return co_await assistant_client_.delete_assistant(assistant_id);
+        co_return co_await assistant_client().delete_assistant(assistant_id);
     }
 
     // ========================================================================
@@ -230,22 +391,22 @@ public:
     // ========================================================================
     
     asio::awaitable<std::expected<Thread, ApiError>> create_thread(const CreateThreadRequest& request) {
-        co_return co_await thread_client_.create_thread(request);
+        co_return co_await thread_client().create_thread(request);
     }
 
     asio::awaitable<std::expected<Thread, ApiError>> retrieve_thread(const std::string& thread_id) {
-        co_return co_await thread_client_.retrieve_thread(thread_id);
+        co_return co_await thread_client().retrieve_thread(thread_id);
     }
 
     asio::awaitable<std::expected<Thread, ApiError>> modify_thread(
         const std::string& thread_id,
         const ModifyThreadRequest& request
     ) {
-        co_return co_await thread_client_.modify_thread(thread_id, request);
+        co_return co_await thread_client().modify_thread(thread_id, request);
     }
 
     asio::awaitable<std::expected<DeleteThreadResponse, ApiError>> delete_thread(const std::string& thread_id) {
-        co_return co_await thread_client_.delete_thread(thread_id);
+        co_return co_await thread_client().delete_thread(thread_id);
     }
 
     // ========================================================================
@@ -256,21 +417,21 @@ public:
         const std::string& thread_id,
         const CreateMessageRequest& request
     ) {
-        co_return co_await thread_client_.create_message(thread_id, request);
+        co_return co_await thread_client().create_message(thread_id, request);
     }
 
     asio::awaitable<std::expected<ThreadMessageListResponse, ApiError>> list_messages(
         const std::string& thread_id,
         int limit = 20
     ) {
-        co_return co_await thread_client_.list_messages(thread_id, limit);
+        co_return co_await thread_client().list_messages(thread_id, limit);
     }
 
     asio::awaitable<std::expected<ThreadMessage, ApiError>> retrieve_message(
         const std::string& thread_id,
         const std::string& message_id
     ) {
-        co_return co_await thread_client_.retrieve_message(thread_id, message_id);
+        co_return co_await thread_client().retrieve_message(thread_id, message_id);
     }
 
     asio::awaitable<std::expected<ThreadMessage, ApiError>> modify_message(
@@ -278,7 +439,7 @@ public:
         const std::string& message_id,
         const ModifyMessageRequest& request
     ) {
-        co_return co_await thread_client_.modify_message(thread_id, message_id, request);
+        co_return co_await thread_client().modify_message(thread_id, message_id, request);
     }
 
     // ========================================================================
@@ -289,21 +450,21 @@ public:
         const std::string& thread_id,
         const CreateRunRequest& request
     ) {
-        co_return co_await run_client_.create_run(thread_id, request);
+        co_return co_await run_client().create_run(thread_id, request);
     }
 
     asio::awaitable<std::expected<RunListResponse, ApiError>> list_runs(
         const std::string& thread_id,
         int limit = 20
     ) {
-        co_return co_await run_client_.list_runs(thread_id, limit);
+        co_return co_await run_client().list_runs(thread_id, limit);
     }
 
     asio::awaitable<std::expected<Run, ApiError>> retrieve_run(
         const std::string& thread_id,
         const std::string& run_id
     ) {
-        co_return co_await run_client_.retrieve_run(thread_id, run_id);
+        co_return co_await run_client().retrieve_run(thread_id, run_id);
     }
 
     asio::awaitable<std::expected<Run, ApiError>> modify_run(
@@ -311,14 +472,14 @@ public:
         const std::string& run_id,
         const ModifyRunRequest& request
     ) {
-        co_return co_await run_client_.modify_run(thread_id, run_id, request);
+        co_return co_await run_client().modify_run(thread_id, run_id, request);
     }
 
     asio::awaitable<std::expected<Run, ApiError>> cancel_run(
         const std::string& thread_id,
         const std::string& run_id
     ) {
-        co_return co_await run_client_.cancel_run(thread_id, run_id);
+        co_return co_await run_client().cancel_run(thread_id, run_id);
     }
 
     asio::awaitable<std::expected<Run, ApiError>> submit_tool_outputs(
@@ -326,7 +487,7 @@ public:
         const std::string& run_id,
         const SubmitToolOutputsRequest& request
     ) {
-        co_return co_await run_client_.submit_tool_outputs(thread_id, run_id, request);
+        co_return co_await run_client().submit_tool_outputs(thread_id, run_id, request);
     }
 
     asio::awaitable<std::expected<RunStepListResponse, ApiError>> list_run_steps(
@@ -334,7 +495,7 @@ public:
         const std::string& run_id,
         int limit = 20
     ) {
-        co_return co_await run_client_.list_run_steps(thread_id, run_id, limit);
+        co_return co_await run_client().list_run_steps(thread_id, run_id, limit);
     }
 
     asio::awaitable<std::expected<RunStep, ApiError>> retrieve_run_step(
@@ -342,30 +503,66 @@ public:
         const std::string& run_id,
         const std::string& step_id
     ) {
-        co_return co_await run_client_.retrieve_run_step(thread_id, run_id, step_id);
+        co_return co_await run_client().retrieve_run_step(thread_id, run_id, step_id);
     }
 
 private:
-    // Composed specialized clients - Core APIs
-    client::ModelClient model_client_;
-    client::ChatClient chat_client_;
-    client::ImageClient image_client_;
-    client::EmbeddingClient embedding_client_;
-    client::CompletionClient completion_client_;
-    client::ModerationClient moderation_client_;
-    
-    // Composed specialized clients - Advanced APIs
-    client::FileClient file_client_;
-    client::FineTuningClient fine_tuning_client_;
-    client::AudioClient audio_client_;
-    
-    // Composed specialized clients - Beta APIs
-    client::AssistantClient assistant_client_;
-    client::ThreadClient thread_client_;
-    client::RunClient run_client_;
-    
+    // Settings applied to each sub-client as it is created
+    struct Settings {
+        std::optional<std::string> api_base;
+        std::optional<std::string> organization;
+        std::optional<http::RetryPolicy> retry_policy;
+        std::shared_ptr<ResponseCache> response_cache;
+    };
+
+    template <typename T>
+    T& get() {
+        std::lock_guard lock(mutex_);
+        auto& slot = std::get<std::unique_ptr<T>>(clients_);
+        if (!slot) {
+            slot = std::make_unique<T>(api_key_, transport_);
+            if (settings_.api_base) slot->set_api_base(*settings_.api_base);
+            if (settings_.organization) slot->set_organization(*settings_.organization);
+            if (settings_.retry_policy) slot->set_retry_policy(*settings_.retry_policy);
+            slot->set_rate_limiter(rate_limiter_);
+            slot->set_retry_metrics(retry_metrics_);
+            slot->set_hedger(hedger_);
+            slot->set_response_cache(settings_.response_cache);
+        }
+        return *slot;
+    }
+
+    // Record a setting for clients created later and apply it to existing ones
+    template <typename Record, typename Apply>
+    void configure(Record&& record, Apply&& apply) {
+        std::lock_guard lock(mutex_);
+        record(settings_);
+        std::apply([&](auto&... slot) { ((slot ? apply(*slot) : void()), ...); }, clients_);
+    }
+
+    std::shared_ptr<http::Client> transport_;
+    std::shared_ptr<http::RateLimiter> rate_limiter_;
+    std::shared_ptr<http::RetryMetrics> retry_metrics_;
+    std::shared_ptr<http::Hedger> hedger_;
     std::string api_key_;
-    asio::io_context& io_context_;
+    Settings settings_;
+    std::mutex mutex_;
+
+    // Core, advanced and beta API clients
+    std::tuple<
+        std::unique_ptr<client::ModelClient>,
+        std::unique_ptr<client::ChatClient>,
+        std::unique_ptr<client::ImageClient>,
+        std::unique_ptr<client::EmbeddingClient>,
+        std::unique_ptr<client::CompletionClient>,
+        std::unique_ptr<client::ModerationClient>,
+        std::unique_ptr<client::FileClient>,
+        std::unique_ptr<client::FineTuningClient>,
+        std::unique_ptr<client::BatchClient>,
+        std::unique_ptr<client::AudioClient>,
+        std::unique_ptr<client::AssistantClient>,
+        std::unique_ptr<client::ThreadClient>,
+        std::unique_ptr<client::RunClient>> clients_;
 };
 
 } // namespace openai
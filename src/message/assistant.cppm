@@ -4,6 +4,7 @@
 export module openai.types.assistant;
 
 import std;
+import openai.types.json;
 
 export namespace openai {
 
@@ -18,17 +19,37 @@ enum class AssistantToolType {
     Function
 };
 
+// Helper function to convert AssistantToolType to string
+inline std::string_view to_string(AssistantToolType type) {
+    switch (type) {
+        case AssistantToolType::CodeInterpreter: return "code_interpreter";
+        case AssistantToolType::Retrieval: return "retrieval";
+        default: return "function";
+    }
+}
+
+// Helper function to convert string to AssistantToolType
+inline AssistantToolType string_to_assistant_tool_type(std::string_view type_str) {
+    if (type_str == "code_interpreter") return AssistantToolType::CodeInterpreter;
+    if (type_str == "retrieval" || type_str == "file_search") return AssistantToolType::Retrieval;
+    return AssistantToolType::Function;
+}
+
 // Function definition for tools
 struct FunctionDefinition {
     std::string name;
     std::string description;
     std::string parameters;  // JSON schema
+    
+    void write_json(JsonWriter& json) const;
 };
 
 // Assistant tool
 struct AssistantTool {
-    AssistantToolType type;
+    AssistantToolType type{AssistantToolType::Function};
     std::optional<FunctionDefinition> function;
+    
+    void write_json(JsonWriter& json) const;
 };
 
 // Assistant object
@@ -56,6 +77,7 @@ struct CreateAssistantRequest {
     std::optional<std::map<std::string, std::string>> metadata;
     
     std::string to_json() const;
+    void write_json(JsonWriter& json) const;
 };
 
 // Modify assistant request
@@ -69,6 +91,7 @@ struct ModifyAssistantRequest {
     std::optional<std::map<std::string, std::string>> metadata;
     
     std::string to_json() const;
+    void write_json(JsonWriter& json) const;
 };
 
 // Assistant list response
@@ -87,6 +110,13 @@ struct DeleteAssistantResponse {
     bool deleted{false};
 };
 
+// JSON decoding
+void read_json(JsonReader& reader, FunctionDefinition& out);
+void read_json(JsonReader& reader, AssistantTool& out);
+void read_json(JsonReader& reader, Assistant& out);
+void read_json(JsonReader& reader, AssistantListResponse& out);
+void read_json(JsonReader& reader, DeleteAssistantResponse& out);
+
 } // namespace openai
 
 // ============================================================================
@@ -95,54 +125,126 @@ struct DeleteAssistantResponse {
 
 namespace openai {
 
-// CreateAssistantRequest::to_json implementation
-std::string CreateAssistantRequest::to_json() const {
-    std::ostringstream json;
-    json << "{";
-    json << "\"model\":\"" << model << "\"";
-    
-    if (name) {
-        json << ",\"name\":\"" << *name << "\"";
+// FunctionDefinition::write_json implementation
+void FunctionDefinition::write_json(JsonWriter& json) const {
+    json.begin_object();
+    json.field("name", name);
+    if (!description.empty()) {
+        json.field("description", description);
     }
-    if (description) {
-        json << ",\"description\":\"" << *description << "\"";
+    if (!parameters.empty()) {
+        json.key("parameters");
+        json.raw(parameters);
     }
-    if (instructions) {
-        json << ",\"instructions\":\"" << *instructions << "\"";
-    }
-    
-    json << "}";
-    return json.str();
+    json.end_object();
+}
+
+// AssistantTool::write_json implementation
+void AssistantTool::write_json(JsonWriter& json) const {
+    json.begin_object();
+    json.field("type", to_string(type));
+    json.field("function", function);
+    json.end_object();
+}
+
+// CreateAssistantRequest::to_json implementation
+std::string CreateAssistantRequest::to_json() const {
+    return to_json_string(*this);
+}
+
+// CreateAssistantRequest::write_json implementation
+void CreateAssistantRequest::write_json(JsonWriter& json) const {
+    json.begin_object();
+    json.field("model", model);
+    json.field("name", name);
+    json.field("description", description);
+    json.field("instructions", instructions);
+    json.field("tools", tools);
+    json.field("file_ids", file_ids);
+    json.field("metadata", metadata);
+    json.end_object();
 }
 
 // ModifyAssistantRequest::to_json implementation
 std::string ModifyAssistantRequest::to_json() const {
-    std::ostringstream json;
-    json << "{";
-    bool first = true;
-    
-    if (model) {
-        json << "\"model\":\"" << *model << "\"";
-        first = false;
-    }
-    if (name) {
-        if (!first) json << ",";
-        json << "\"name\":\"" << *name << "\"";
-        first = false;
-    }
-    if (description) {
-        if (!first) json << ",";
-        json << "\"description\":\"" << *description << "\"";
-        first = false;
-    }
-    if (instructions) {
-        if (!first) json << ",";
-        json << "\"instructions\":\"" << *instructions << "\"";
-    }
-    
-    json << "}";
-    return json.str();
+    return to_json_string(*this);
 }
 
-} // namespace openai
+// ModifyAssistantRequest::write_json implementation
+void ModifyAssistantRequest::write_json(JsonWriter& json) const {
+    json.begin_object();
+    json.field("model", model);
+    json.field("name", name);
+    json.field("description", description);
+    json.field("instructions", instructions);
+    json.field("tools", tools);
+    json.field("file_ids", file_ids);
+    json.field("metadata", metadata);
+    json.end_object();
+}
+
+
+// ============================================================================
+// JSON Decoding
+// ============================================================================
 
+void read_json(JsonReader& reader, FunctionDefinition& out) {
+    reader.object([&](std::string_view key) {
+        if (key == "name") reader.read(out.name);
+        else if (key == "description") reader.read(out.description);
+        else if (key == "parameters") out.parameters = reader.raw();
+        else reader.skip();
+    });
+}
+
+void read_json(JsonReader& reader, AssistantTool& out) {
+    reader.object([&](std::string_view key) {
+        if (key == "type") {
+            std::string type;
+            reader.read(type);
+            out.type = string_to_assistant_tool_type(type);
+        } else if (key == "function") {
+            reader.read(out.function);
+        } else {
+            reader.skip();
+        }
+    });
+}
+
+void read_json(JsonReader& reader, Assistant& out) {
+    reader.object([&](std::string_view key) {
+        if (key == "id") reader.read(out.id);
+        else if (key == "object") reader.read(out.object);
+        else if (key == "created_at") reader.read(out.created_at);
+        else if (key == "name") reader.read(out.name);
+        else if (key == "description") reader.read(out.description);
+        else if (key == "model") reader.read(out.model);
+        else if (key == "instructions") reader.read(out.instructions);
+        else if (key == "tools") reader.read(out.tools);
+        else if (key == "file_ids") reader.read(out.file_ids);
+        else if (key == "metadata") reader.read(out.metadata);
+        else reader.skip();
+    });
+}
+
+void read_json(JsonReader& reader, AssistantListResponse& out) {
+    reader.object([&](std::string_view key) {
+        if (key == "object") reader.read(out.object);
+        else if (key == "data") reader.read(out.data);
+        else if (key == "first_id") reader.read(out.first_id);
+        else if (key == "last_id") reader.read(out.last_id);
+        else if (key == "has_more") reader.read(out.has_more);
+        else reader.skip();
+    });
+}
+
+void read_json(JsonReader& reader, DeleteAssistantResponse& out) {
+    reader.object([&](std::string_view key) {
+        if (key == "id") reader.read(out.id);
+        else if (key == "object") reader.read(out.object);
+        else if (key == "deleted") reader.read(out.deleted);
+        else reader.skip();
+    });
+}
+
+} // namespace openai
@@ -4,6 +4,7 @@
 export module openai.types.audio;
 
 import std;
+import openai.types.json;
 
 export namespace openai {
 
@@ -35,5 +36,22 @@ struct AudioResponse {
     std::string text;
 };
 
+// JSON decoding
+void read_json(JsonReader& reader, AudioResponse& out);
+
 } // namespace openai
 
+// ============================================================================
+// Implementation
+// ============================================================================
+
+namespace openai {
+
+void read_json(JsonReader& reader, AudioResponse& out) {
+    reader.object([&](std::string_view key) {
+        if (key == "text") reader.read(out.text);
+        else reader.skip();
+    });
+}
+
+} // namespace openai
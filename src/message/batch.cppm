@@ -0,0 +1,334 @@
+// Batch API Types Module
+// Batch jobs, JSONL input files and output lines
+
+export module openai.types.batch;
+
+import std;
+import fmt;
+import openai.types.common;
+import openai.types.json;
+import openai.types.chat;
+import openai.types.embedding;
+
+export namespace openai {
+
+// ============================================================================
+// BATCH API - Request & Response Types
+// ============================================================================
+
+// Batch creation request; input_file_id is a JSONL file uploaded with
+// purpose "batch"
+struct BatchRequest {
+    std::string input_file_id;
+    std::string endpoint;                        // e.g. "/v1/chat/completions"
+    std::string completion_window{"24h"};
+    std::map<std::string, std::string> metadata;  // Omitted when empty
+
+    std::string to_json() const;
+    void write_json(JsonWriter& json) const;
+};
+
+// Request counts of a batch
+struct BatchRequestCounts {
+    int total{0};
+    int completed{0};
+    int failed{0};
+};
+
+// Input file validation error
+struct BatchError {
+    std::string code;
+    std::string message;
+    std::string param;
+    std::optional<int> line;
+};
+
+// Batch object
+struct Batch {
+    std::string id;
+    std::string object;
+    std::string endpoint;
+    std::string input_file_id;
+    std::string completion_window;
+    std::string status;  // validating, failed, in_progress, finalizing, completed, expired, cancelling, cancelled
+    std::string output_file_id;
+    std::string error_file_id;
+    std::int64_t created_at{0};
+    std::int64_t in_progress_at{0};
+    std::int64_t expires_at{0};
+    std::int64_t finalizing_at{0};
+    std::int64_t completed_at{0};
+    std::int64_t failed_at{0};
+    std::int64_t expired_at{0};
+    std::int64_t cancelling_at{0};
+    std::int64_t cancelled_at{0};
+    BatchRequestCounts request_counts;
+    std::map<std::string, std::string> metadata;
+    std::vector<BatchError> errors;
+};
+
+// Batch list response
+struct BatchListResponse {
+    std::string object;
+    std::vector<Batch> data;
+    std::string first_id;
+    std::string last_id;
+    bool has_more{false};
+};
+
+// JSONL input file of a batch: one request per line, each with a caller
+// chosen custom_id that identifies its result. Lines are built in memory, or
+// with a path, appended to that file through a bounded buffer so millions
+// of requests can be prepared without holding them all. A batch targets a
+// single endpoint, so chat and embedding requests cannot be mixed.
+class BatchInput {
+public:
+    BatchInput() = default;
+
+    // Throws std::runtime_error when the file cannot be created
+    explicit BatchInput(std::filesystem::path path);
+
+    // Throw std::invalid_argument for a request to another endpoint than
+    // the first one added, and std::runtime_error when writing fails
+    void add(std::string_view custom_id, const ChatCompletionRequest& request);
+    void add(std::string_view custom_id, const EmbeddingRequest& request);
+
+    // Write out buffered lines; call before uploading a file-backed input.
+    // Throws std::runtime_error when writing fails.
+    void flush();
+
+    std::size_t size() const { return lines_; }
+    const std::string& endpoint() const { return endpoint_; }
+
+    // File the lines go to; empty for an in-memory input
+    const std::filesystem::path& path() const { return path_; }
+
+    // The JSONL text of an in-memory input
+    std::span<const char> data() const { return {buffer_.data(), buffer_.size()}; }
+
+private:
+    template <typename T>
+    void add_line(std::string_view custom_id, std::string_view url, const T& body);
+
+    static constexpr std::size_t flush_size = 1 << 20;  // Buffered bytes of a file-backed input
+
+    std::filesystem::path path_;
+    std::ofstream file_;
+    fmt::memory_buffer buffer_;
+    std::string endpoint_;
+    std::size_t lines_{0};
+};
+
+// One line of a batch output or error file. result holds the decoded
+// response body, or the error: a non-2xx status_code with the body in its
+// message, or the request-level error of an error file line.
+template <typename Response>
+struct BatchResult {
+    std::string id;
+    std::string custom_id;
+    int status_code{0};
+    std::string request_id;
+    std::expected<Response, ApiError> result;
+};
+
+// Decode one output or error file line. Throws JsonError when the line is
+// not valid JSON; a body that does not decode into Response becomes an error.
+template <typename Response>
+BatchResult<Response> parse_batch_result(std::string_view line);
+
+// JSON decoding
+void read_json(JsonReader& reader, BatchRequestCounts& out);
+void read_json(JsonReader& reader, BatchError& out);
+void read_json(JsonReader& reader, Batch& out);
+void read_json(JsonReader& reader, BatchListResponse& out);
+
+template <typename Response>
+BatchResult<Response> parse_batch_result(std::string_view line) {
+    BatchResult<Response> out;
+    std::string_view body;
+    std::optional<ApiError> error;
+
+    JsonReader reader(line);
+    reader.object([&](std::string_view key) {
+        if (key == "id") reader.read(out.id);
+        else if (key == "custom_id") reader.read(out.custom_id);
+        else if (key == "response") {
+            if (reader.null()) {
+                return;
+            }
+            reader.object([&](std::string_view field) {
+                if (field == "status_code") reader.read(out.status_code);
+                else if (field == "request_id") reader.read(out.request_id);
+                else if (field == "body") body = reader.raw();
+                else reader.skip();
+            });
+        }
+        else if (key == "error") {
+            if (reader.null()) {
+                return;
+            }
+            BatchError batch_error;
+            reader.read(batch_error);
+            error = ApiError(0, std::move(batch_error.message), std::move(batch_error.code));
+        }
+        else reader.skip();
+    });
+    reader.finish();
+
+    if (error) {
+        out.result = std::unexpected(std::move(*error));
+    } else if (out.status_code < 200 || out.status_code >= 300) {
+        out.result = std::unexpected(ApiError(out.status_code, fmt::format("HTTP {}: {}", out.status_code, body)));
+    } else {
+        try {
+            out.result = decode_json<Response>(body);
+        } catch (const JsonError& e) {
+            out.result = std::unexpected(ApiError(fmt::format("Invalid JSON response: {}", e.what())));
+        }
+    }
+    return out;
+}
+
+} // namespace openai
+
+// ============================================================================
+// Implementation
+// ============================================================================
+
+namespace openai {
+
+// BatchRequest::to_json implementation
+std::string BatchRequest::to_json() const {
+    return to_json_string(*this);
+}
+
+// BatchRequest::write_json implementation
+void BatchRequest::write_json(JsonWriter& json) const {
+    json.begin_object();
+    json.field("input_file_id", input_file_id);
+    json.field("endpoint", endpoint);
+    json.field("completion_window", completion_window);
+    if (!metadata.empty()) {
+        json.field("metadata", metadata);
+    }
+    json.end_object();
+}
+
+BatchInput::BatchInput(std::filesystem::path path)
+    : path_(std::move(path))
+    , file_(path_, std::ios::binary | std::ios::trunc) {
+    if (!file_) {
+        throw std::runtime_error("Failed to open file for writing: " + path_.string());
+    }
+}
+
+void BatchInput::add(std::string_view custom_id, const ChatCompletionRequest& request) {
+    add_line(custom_id, "/v1/chat/completions", request);
+}
+
+void BatchInput::add(std::string_view custom_id, const EmbeddingRequest& request) {
+    add_line(custom_id, "/v1/embeddings", request);
+}
+
+template <typename T>
+void BatchInput::add_line(std::string_view custom_id, std::string_view url, const T& body) {
+    if (endpoint_.empty()) {
+        endpoint_ = url;
+    } else if (endpoint_ != url) {
+        throw std::invalid_argument(fmt::format("Batch input for {} cannot take a {} request", endpoint_, url));
+    }
+
+    JsonWriter json(buffer_);
+    json.begin_object();
+    json.field("custom_id", custom_id);
+    json.field("method", "POST");
+    json.field("url", url);
+    json.key("body");
+    body.write_json(json);
+    json.end_object();
+    buffer_.push_back('\n');
+    ++lines_;
+
+    if (!path_.empty() && buffer_.size() >= flush_size) {
+        flush();
+    }
+}
+
+void BatchInput::flush() {
+    if (path_.empty()) {
+        return;
+    }
+    file_.write(buffer_.data(), static_cast<std::streamsize>(buffer_.size()));
+    file_.flush();
+    buffer_.clear();
+    if (!file_) {
+        throw std::runtime_error("Failed to write file: " + path_.string());
+    }
+}
+
+void read_json(JsonReader& reader, BatchRequestCounts& out) {
+    reader.object([&](std::string_view key) {
+        if (key == "total") reader.read(out.total);
+        else if (key == "completed") reader.read(out.completed);
+        else if (key == "failed") reader.read(out.failed);
+        else reader.skip();
+    });
+}
+
+void read_json(JsonReader& reader, BatchError& out) {
+    reader.object([&](std::string_view key) {
+        if (key == "code") reader.read(out.code);
+        else if (key == "message") reader.read(out.message);
+        else if (key == "param") reader.read(out.param);
+        else if (key == "line") reader.read(out.line);
+        else reader.skip();
+    });
+}
+
+void read_json(JsonReader& reader, Batch& out) {
+    reader.object([&](std::string_view key) {
+        if (key == "id") reader.read(out.id);
+        else if (key == "object") reader.read(out.object);
+        else if (key == "endpoint") reader.read(out.endpoint);
+        else if (key == "input_file_id") reader.read(out.input_file_id);
+        else if (key == "completion_window") reader.read(out.completion_window);
+        else if (key == "status") reader.read(out.status);
+        else if (key == "output_file_id") reader.read(out.output_file_id);
+        else if (key == "error_file_id") reader.read(out.error_file_id);
+        else if (key == "created_at") reader.read(out.created_at);
+        else if (key == "in_progress_at") reader.read(out.in_progress_at);
+        else if (key == "expires_at") reader.read(out.expires_at);
+        else if (key == "finalizing_at") reader.read(out.finalizing_at);
+        else if (key == "completed_at") reader.read(out.completed_at);
+        else if (key == "failed_at") reader.read(out.failed_at);
+        else if (key == "expired_at") reader.read(out.expired_at);
+        else if (key == "cancelling_at") reader.read(out.cancelling_at);
+        else if (key == "cancelled_at") reader.read(out.cancelled_at);
+        else if (key == "request_counts") reader.read(out.request_counts);
+        else if (key == "metadata") reader.read(out.metadata);
+        else if (key == "errors") {
+            // {"object": "list", "data": [...]}
+            if (reader.null()) {
+                return;
+            }
+            reader.object([&](std::string_view field) {
+                if (field == "data") reader.read(out.errors);
+                else reader.skip();
+            });
+        }
+        else reader.skip();
+    });
+}
+
+void read_json(JsonReader& reader, BatchListResponse& out) {
+    reader.object([&](std::string_view key) {
+        if (key == "object") reader.read(out.object);
+        else if (key == "data") reader.read(out.data);
+        else if (key == "first_id") reader.read(out.first_id);
+        else if (key == "last_id") reader.read(out.last_id);
+        else if (key == "has_more") reader.read(out.has_more);
+        else reader.skip();
+    });
+}
+
+} // namespace openai
@@ -6,6 +6,7 @@ export module openai.types.chat;
 import std;
 import fmt;
 import openai.types.common;
+import openai.types.json;
 
 export namespace openai {
 
@@ -18,24 +19,63 @@ enum class MessageRole {
     System,
     User,
     Assistant,
-    Function
+    Function,
+    Tool
 };
 
 // Convert MessageRole to string
 std::string to_string(MessageRole role);
 
+// Convert string to MessageRole (unknown roles map to Assistant)
+MessageRole string_to_message_role(std::string_view role_str);
+
 // ============================================================================
 // CHAT API - Request & Response Types
 // ============================================================================
 
+// Function invocation requested by the model
+struct FunctionCall {
+    std::string name;
+    std::string arguments;  // JSON-encoded arguments
+};
+
+// Tool call made by the assistant
+struct ToolCall {
+    std::string id;
+    std::string type{"function"};
+    FunctionCall function;
+    
+    std::string to_json() const;
+    void write_json(JsonWriter& json) const;
+};
+
+// Function the model may call
+struct ToolFunction {
+    std::string name;
+    std::optional<std::string> description;
+    std::string parameters{R"({"type":"object","properties":{}})"};  // JSON Schema
+};
+
+// Tool offered to the model
+struct Tool {
+    std::string type{"function"};
+    ToolFunction function;
+    
+    std::string to_json() const;
+    void write_json(JsonWriter& json) const;
+};
+
 // Chat message
 struct Message {
     MessageRole role{MessageRole::User};
     std::string content;
     std::optional<std::string> name;
     std::optional<std::string> function_call;
+    std::optional<std::vector<ToolCall>> tool_calls;  // Assistant messages
+    std::optional<std::string> tool_call_id;          // Tool messages: the call being answered
     
     std::string to_json() const;
+    void write_json(JsonWriter& json) const;
 };
 
 // Chat completion request
@@ -51,8 +91,12 @@ struct ChatCompletionRequest {
     std::optional<bool> stream;
     std::optional<std::vector<std::string>> stop;
     std::optional<std::string> user;
+    std::optional<std::vector<Tool>> tools;
+    std::optional<std::string> tool_choice;      // "none", "auto", "required" or a JSON object
+    std::optional<bool> stream_include_usage;    // Streaming: send usage in a final chunk
     
     std::string to_json() const;
+    void write_json(JsonWriter& json) const;
 };
 
 // Chat completion choice
@@ -82,6 +126,73 @@ struct ChatCompletionResponse {
 // Alias for convenience  
 using ChatChoice = ChatCompletionChoice;
 
+// ============================================================================
+// CHAT API - Streaming Types
+// ============================================================================
+
+// Fragment of a tool call in a streamed chunk
+struct ToolCallDelta {
+    int index{0};
+    std::optional<std::string> id;
+    std::optional<std::string> type;
+    std::optional<std::string> function_name;
+    std::string arguments;  // Appended to the arguments received so far
+};
+
+// Message fragment in a streamed chunk
+struct ChatCompletionDelta {
+    std::optional<MessageRole> role;
+    std::string content;
+    std::vector<ToolCallDelta> tool_calls;
+};
+
+// Streamed chunk choice
+struct ChatCompletionChunkChoice {
+    int index{0};
+    ChatCompletionDelta delta;
+    std::optional<std::string> finish_reason;
+};
+
+// One chat.completion.chunk event of a streamed completion
+struct ChatCompletionChunk {
+    std::string id;
+    std::string object;
+    std::int64_t created{0};
+    std::string model;
+    std::vector<ChatCompletionChunkChoice> choices;
+    std::optional<ChatCompletionUsage> usage;  // Only in the final chunk, with stream_include_usage
+};
+
+// Builds a complete response from streamed chunks, concatenating content and
+// assembling tool calls from their argument fragments
+class ChatCompletionAccumulator {
+public:
+    void add(const ChatCompletionChunk& chunk);
+    
+    const ChatCompletionResponse& response() const { return response_; }
+    ChatCompletionResponse take() { return std::move(response_); }
+
+private:
+    ChatCompletionChoice& choice(int index);
+    
+    ChatCompletionResponse response_;
+};
+
+// ============================================================================
+// CHAT API - JSON Decoding
+// ============================================================================
+
+void read_json(JsonReader& reader, FunctionCall& out);
+void read_json(JsonReader& reader, ToolCall& out);
+void read_json(JsonReader& reader, Message& out);
+void read_json(JsonReader& reader, ChatCompletionChoice& out);
+void read_json(JsonReader& reader, ChatCompletionUsage& out);
+void read_json(JsonReader& reader, ChatCompletionResponse& out);
+void read_json(JsonReader& reader, ToolCallDelta& out);
+void read_json(JsonReader& reader, ChatCompletionDelta& out);
+void read_json(JsonReader& reader, ChatCompletionChunkChoice& out);
+void read_json(JsonReader& reader, ChatCompletionChunk& out);
+
 } // namespace openai
 
 // ============================================================================
@@ -97,76 +208,309 @@ std::string to_string(MessageRole role) {
         case MessageRole::User: return "user";
         case MessageRole::Assistant: return "assistant";
         case MessageRole::Function: return "function";
+        case MessageRole::Tool: return "tool";
         default: return "user";
     }
 }
 
+// Convert string to MessageRole
+MessageRole string_to_message_role(std::string_view role_str) {
+    if (role_str == "system") return MessageRole::System;
+    if (role_str == "user") return MessageRole::User;
+    if (role_str == "function") return MessageRole::Function;
+    if (role_str == "tool") return MessageRole::Tool;
+    return MessageRole::Assistant;
+}
+
+// ToolCall::to_json implementation
+std::string ToolCall::to_json() const {
+    return to_json_string(*this);
+}
+
+// ToolCall::write_json implementation
+void ToolCall::write_json(JsonWriter& json) const {
+    json.begin_object();
+    json.field("id", id);
+    json.field("type", type);
+    json.key("function");
+    json.begin_object();
+    json.field("name", function.name);
+    json.field("arguments", function.arguments);
+    json.end_object();
+    json.end_object();
+}
+
+// Tool::to_json implementation
+std::string Tool::to_json() const {
+    return to_json_string(*this);
+}
+
+// Tool::write_json implementation
+void Tool::write_json(JsonWriter& json) const {
+    json.begin_object();
+    json.field("type", type);
+    json.key("function");
+    json.begin_object();
+    json.field("name", function.name);
+    json.field("description", function.description);
+    json.key("parameters");
+    json.raw(function.parameters);
+    json.end_object();
+    json.end_object();
+}
+
 // Message::to_json implementation
 std::string Message::to_json() const {
-    std::ostringstream json;
-    json << "{";
-    json << fmt::format(R"("role":"{}")", to_string(role));
-    json << fmt::format(R"(,"content":"{}")", escape_json(content));
+    return to_json_string(*this);
+}
+
+// Message::write_json implementation
+void Message::write_json(JsonWriter& json) const {
+    json.begin_object();
+    json.field("role", to_string(role));
     
-    if (name) {
-        json << fmt::format(R"(,"name":"{}")", *name);
+    // Assistant messages that only carry tool calls have null content
+    json.key("content");
+    if (content.empty() && tool_calls) {
+        json.null();
+    } else {
+        json.string(content);
     }
+    
+    json.field("name", name);
     if (function_call) {
-        json << fmt::format(R"(,"function_call":{})", *function_call);
+        json.key("function_call");
+        json.raw(*function_call);
     }
-    
-    json << "}";
-    return json.str();
+    json.field("tool_calls", tool_calls);
+    json.field("tool_call_id", tool_call_id);
+    json.end_object();
 }
 
 // ChatCompletionRequest::to_json implementation
 std::string ChatCompletionRequest::to_json() const {
-    std::ostringstream json;
-    json << "{";
-    json << fmt::format(R"("model":"{}")", model);
-    
-    json << R"(,"messages":[)";
-    for (std::size_t i = 0; i < messages.size(); ++i) {
-        if (i > 0) json << ",";
-        json << messages[i].to_json();
-    }
-    json << "]";
-    
-    if (temperature) {
-        json << fmt::format(R"(,"temperature":{})", *temperature);
-    }
-    if (max_tokens) {
-        json << fmt::format(R"(,"max_tokens":{})", *max_tokens);
-    }
-    if (top_p) {
-        json << fmt::format(R"(,"top_p":{})", *top_p);
+    return to_json_string(*this);
+}
+
+// ChatCompletionRequest::write_json implementation
+void ChatCompletionRequest::write_json(JsonWriter& json) const {
+    json.begin_object();
+    json.field("model", model);
+    json.field("messages", messages);
+    json.field("temperature", temperature);
+    json.field("max_tokens", max_tokens);
+    json.field("top_p", top_p);
+    json.field("frequency_penalty", frequency_penalty);
+    json.field("presence_penalty", presence_penalty);
+    json.field("n", n);
+    json.field("stream", stream);
+    json.field("stop", stop);
+    json.field("user", user);
+    json.field("tools", tools);
+    if (tool_choice) {
+        json.key("tool_choice");
+        if (tool_choice->starts_with('{')) {
+            json.raw(*tool_choice);
+        } else {
+            json.string(*tool_choice);
+        }
     }
-    if (frequency_penalty) {
-        json << fmt::format(R"(,"frequency_penalty":{})", *frequency_penalty);
+    if (stream_include_usage) {
+        json.key("stream_options");
+        json.begin_object();
+        json.field("include_usage", *stream_include_usage);
+        json.end_object();
     }
-    if (presence_penalty) {
-        json << fmt::format(R"(,"presence_penalty":{})", *presence_penalty);
+    json.end_object();
+}
+
+// ChatCompletionAccumulator implementation
+ChatCompletionChoice& ChatCompletionAccumulator::choice(int index) {
+    for (auto& existing : response_.choices) {
+        if (existing.index == index) {
+            return existing;
+        }
     }
-    if (n) {
-        json << fmt::format(R"(,"n":{})", *n);
+    auto& added = response_.choices.emplace_back();
+    added.index = index;
+    added.message.role = MessageRole::Assistant;
+    return added;
+}
+
+void ChatCompletionAccumulator::add(const ChatCompletionChunk& chunk) {
+    if (response_.id.empty()) {
+        response_.id = chunk.id;
+        response_.object = "chat.completion";
+        response_.created = chunk.created;
+        response_.model = chunk.model;
     }
-    if (stream) {
-        json << fmt::format(R"(,"stream":{})", *stream ? "true" : "false");
+    if (chunk.usage) {
+        response_.usage = *chunk.usage;
     }
-    if (stop) {
-        json << R"(,"stop":[)";
-        for (std::size_t i = 0; i < stop->size(); ++i) {
-            if (i > 0) json << ",";
-            json << fmt::format(R"("{}")", (*stop)[i]);
+    
+    for (const auto& part : chunk.choices) {
+        auto& target = choice(part.index);
+        if (part.delta.role) {
+            target.message.role = *part.delta.role;
+        }
+        target.message.content += part.delta.content;
+        
+        for (const auto& delta : part.delta.tool_calls) {
+            auto& calls = target.message.tool_calls ? *target.message.tool_calls
+                                                    : target.message.tool_calls.emplace();
+            if (delta.index < 0) {
+                continue;
+            }
+            if (calls.size() <= static_cast<std::size_t>(delta.index)) {
+                calls.resize(static_cast<std::size_t>(delta.index) + 1);
+            }
+            auto& call = calls[static_cast<std::size_t>(delta.index)];
+            if (delta.id) call.id = *delta.id;
+            if (delta.type) call.type = *delta.type;
+            if (delta.function_name) call.function.name += *delta.function_name;
+            call.function.arguments += delta.arguments;
+        }
+        
+        if (part.finish_reason) {
+            target.finish_reason = *part.finish_reason;
         }
-        json << "]";
-    }
-    if (user) {
-        json << fmt::format(R"(,"user":"{}")", *user);
     }
-    
-    json << "}";
-    return json.str();
 }
 
-} // namespace openai
\ No newline at end of file
+// ============================================================================
+// JSON Decoding
+// ============================================================================
+
+void read_json(JsonReader& reader, FunctionCall& out) {
+    reader.object([&](std::string_view key) {
+        if (key == "name") reader.read(out.name);
+        else if (key == "arguments") reader.read(out.arguments);
+        else reader.skip();
+    });
+}
+
+void read_json(JsonReader& reader, ToolCall& out) {
+    reader.object([&](std::string_view key) {
+        if (key == "id") reader.read(out.id);
+        else if (key == "type") reader.read(out.type);
+        else if (key == "function") reader.read(out.function);
+        else reader.skip();
+    });
+}
+
+void read_json(JsonReader& reader, Message& out) {
+    reader.object([&](std::string_view key) {
+        if (key == "role") {
+            std::string role;
+            reader.read(role);
+            out.role = string_to_message_role(role);
+        } else if (key == "content") {
+            reader.read(out.content);
+        } else if (key == "name") {
+            reader.read(out.name);
+        } else if (key == "function_call") {
+            if (reader.null()) {
+                out.function_call.reset();
+            } else {
+                out.function_call = std::string(reader.raw());
+            }
+        } else if (key == "tool_calls") {
+            reader.read(out.tool_calls);
+        } else if (key == "tool_call_id") {
+            reader.read(out.tool_call_id);
+        } else {
+            reader.skip();
+        }
+    });
+}
+
+void read_json(JsonReader& reader, ChatCompletionChoice& out) {
+    reader.object([&](std::string_view key) {
+        if (key == "index") reader.read(out.index);
+        else if (key == "message") reader.read(out.message);
+        else if (key == "finish_reason") reader.read(out.finish_reason);
+        else reader.skip();
+    });
+}
+
+void read_json(JsonReader& reader, ChatCompletionUsage& out) {
+    reader.object([&](std::string_view key) {
+        if (key == "prompt_tokens") reader.read(out.prompt_tokens);
+        else if (key == "completion_tokens") reader.read(out.completion_tokens);
+        else if (key == "total_tokens") reader.read(out.total_tokens);
+        else reader.skip();
+    });
+}
+
+void read_json(JsonReader& reader, ChatCompletionResponse& out) {
+    reader.object([&](std::string_view key) {
+        if (key == "id") reader.read(out.id);
+        else if (key == "object") reader.read(out.object);
+        else if (key == "created") reader.read(out.created);
+        else if (key == "model") reader.read(out.model);
+        else if (key == "choices") reader.read(out.choices);
+        else if (key == "usage") reader.read(out.usage);
+        else reader.skip();
+    });
+}
+
+void read_json(JsonReader& reader, ToolCallDelta& out) {
+    reader.object([&](std::string_view key) {
+        if (key == "index") {
+            reader.read(out.index);
+        } else if (key == "id") {
+            reader.read(out.id);
+        } else if (key == "type") {
+            reader.read(out.type);
+        } else if (key == "function") {
+            reader.object([&](std::string_view field) {
+                if (field == "name") reader.read(out.function_name);
+                else if (field == "arguments") reader.read(out.arguments);
+                else reader.skip();
+            });
+        } else {
+            reader.skip();
+        }
+    });
+}
+
+void read_json(JsonReader& reader, ChatCompletionDelta& out) {
+    reader.object([&](std::string_view key) {
+        if (key == "role") {
+            if (!reader.null()) {
+                std::string role;
+                reader.read(role);
+                out.role = string_to_message_role(role);
+            }
+        } else if (key == "content") {
+            reader.read(out.content);
+        } else if (key == "tool_calls") {
+            reader.read(out.tool_calls);
+        } else {
+            reader.skip();
+        }
+    });
+}
+
+void read_json(JsonReader& reader, ChatCompletionChunkChoice& out) {
+    reader.object([&](std::string_view key) {
+        if (key == "index") reader.read(out.index);
+        else if (key == "delta") reader.read(out.delta);
+        else if (key == "finish_reason") reader.read(out.finish_reason);
+        else reader.skip();
+    });
+}
+
+void read_json(JsonReader& reader, ChatCompletionChunk& out) {
+    reader.object([&](std::string_view key) {
+        if (key == "id") reader.read(out.id);
+        else if (key == "object") reader.read(out.object);
+        else if (key == "created") reader.read(out.created);
+        else if (key == "model") reader.read(out.model);
+        else if (key == "choices") reader.read(out.choices);
+        else if (key == "usage") reader.read(out.usage);
+        else reader.skip();
+    });
+}
+
+} // namespace openai
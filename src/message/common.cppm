@@ -3,6 +3,27 @@
 
 module;
 
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define OPENAI_X86_SIMD 1
+#include <immintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+#endif
+
+#if defined(_WIN32)
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include <openssl/evp.h>
+
 export module openai.types.common;
 
 import std;
@@ -35,8 +56,95 @@ struct ApiError {
     }
 };
 
+// x86 SIMD extensions usable on the running CPU (all false elsewhere)
+struct CpuFeatures {
+    bool avx2{false};
+    bool fma{false};
+    bool avx512f{false};
+};
+
+const CpuFeatures& cpu_features();
+
+// Read-only memory mapping of a whole file. Throws std::runtime_error if the
+// file cannot be opened or mapped; an empty file has data() == nullptr.
+class MappedFile {
+public:
+    explicit MappedFile(const std::string& path);
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    const std::byte* data() const { return data_; }
+    std::size_t size() const { return size_; }
+
+private:
+    void close();
+
+#if defined(_WIN32)
+    void* file_{nullptr};     // HANDLE
+    void* mapping_{nullptr};  // HANDLE
+#else
+    int fd_{-1};
+#endif
+    const std::byte* data_{nullptr};
+    std::size_t size_{0};
+};
+
+// Index of the first byte at or after pos that a JSON string must escape
+// ('"', '\\' or a control character), or str.size() if there is none.
+// Vectorized with SSE2/AVX2 where the CPU supports it.
+std::size_t find_json_escape(std::string_view str, std::size_t pos = 0);
+
+// Index of the first '"' or '\\' at or after pos, or str.size() if there is none
+std::size_t find_json_quote(std::string_view str, std::size_t pos = 0);
+
+// Escape sequence for a byte found by find_json_escape
+std::string_view json_escape_sequence(unsigned char c, char (&scratch)[6]);
+
+// Decode the escape sequence following a backslash at str[pos - 1], including
+// \uXXXX escapes and surrogate pairs, appending UTF-8 to out. Returns the
+// position after the sequence, or std::string_view::npos if it is malformed.
+std::size_t decode_json_escape(std::string_view str, std::size_t pos, std::string& out);
+
+// Escape str for a JSON string literal, passing each piece to append(const char*, std::size_t).
+// Runs of bytes that need no escaping are passed in one call.
+template <typename Append>
+void escape_json_to(std::string_view str, Append&& append) {
+    std::size_t pos = 0;
+    while (true) {
+        auto next = find_json_escape(str, pos);
+        if (next > pos) {
+            append(str.data() + pos, next - pos);
+        }
+        if (next == str.size()) {
+            return;
+        }
+        char scratch[6];
+        auto sequence = json_escape_sequence(static_cast<unsigned char>(str[next]), scratch);
+        append(sequence.data(), sequence.size());
+        pos = next + 1;
+    }
+}
+
 // Helper function to escape JSON strings
-std::string escape_json(const std::string& str);
+std::string escape_json(std::string_view str);
+
+// Helper function to unescape JSON string contents (without the quotes).
+// Malformed escapes are kept verbatim.
+std::string unescape_json(std::string_view str);
+
+// Number of bytes standard base64 text decodes to, accounting for '=' padding
+std::size_t base64_decoded_size(std::string_view base64);
+
+// Decode standard base64 into out, which must hold base64_decoded_size(base64)
+// bytes. Returns false on characters outside the alphabet or a bad length.
+// Vectorized with AVX2 where the CPU supports it.
+bool decode_base64(std::string_view base64, unsigned char* out);
+
+// SHA-256 over length-prefixed fields, so different field lists never hash
+// the same bytes. Used for content-addressed cache keys.
+std::array<std::uint8_t, 32> hash_fields(std::initializer_list<std::string_view> fields);
 
 } // namespace openai
 
@@ -46,27 +154,534 @@ std::string escape_json(const std::string& str);
 
 namespace openai {
 
+namespace {
+
+// Scalar kernels, also used for the tail of the vector kernels
+
+std::size_t find_json_escape_scalar(const char* data, std::size_t size, std::size_t pos) {
+    for (; pos < size; ++pos) {
+        auto c = static_cast<unsigned char>(data[pos]);
+        if (c < 0x20 || c == '"' || c == '\\') {
+            return pos;
+        }
+    }
+    return size;
+}
+
+std::size_t find_json_quote_scalar(const char* data, std::size_t size, std::size_t pos) {
+    for (; pos < size; ++pos) {
+        if (data[pos] == '"' || data[pos] == '\\') {
+            return pos;
+        }
+    }
+    return size;
+}
+
+#if defined(OPENAI_X86_SIMD)
+
+int first_set_bit(unsigned mask) {
+#if defined(_MSC_VER) && !defined(__clang__)
+    unsigned long index;
+    _BitScanForward(&index, mask);
+    return static_cast<int>(index);
+#else
+    return __builtin_ctz(mask);
+#endif
+}
+
+// SSE2 is part of the x86-64 baseline
+
+std::size_t find_json_escape_sse2(const char* data, std::size_t size, std::size_t pos) {
+    const __m128i quote = _mm_set1_epi8('"');
+    const __m128i backslash = _mm_set1_epi8('\\');
+    const __m128i control_max = _mm_set1_epi8(0x1F);
+    for (; pos + 16 <= size; pos += 16) {
+        __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + pos));
+        // Unsigned c <= 0x1F  <=>  max(c, 0x1F) == 0x1F
+        __m128i control = _mm_cmpeq_epi8(_mm_max_epu8(chunk, control_max), control_max);
+        __m128i special = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(chunk, quote), _mm_cmpeq_epi8(chunk, backslash)), control);
+        auto mask = static_cast<unsigned>(_mm_movemask_epi8(special));
+        if (mask != 0) {
+            return pos + first_set_bit(mask);
+        }
+    }
+    return find_json_escape_scalar(data, size, pos);
+}
+
+std::size_t find_json_quote_sse2(const char* data, std::size_t size, std::size_t pos) {
+    const __m128i quote = _mm_set1_epi8('"');
+    const __m128i backslash = _mm_set1_epi8('\\');
+    for (; pos + 16 <= size; pos += 16) {
+        __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + pos));
+        __m128i special = _mm_or_si128(_mm_cmpeq_epi8(chunk, quote), _mm_cmpeq_epi8(chunk, backslash));
+        auto mask = static_cast<unsigned>(_mm_movemask_epi8(special));
+        if (mask != 0) {
+            return pos + first_set_bit(mask);
+        }
+    }
+    return find_json_quote_scalar(data, size, pos);
+}
+
+#if defined(__GNUC__) || defined(__clang__)
+#define OPENAI_TARGET_AVX2 __attribute__((target("avx2")))
+#else
+#define OPENAI_TARGET_AVX2
+#endif
+
+OPENAI_TARGET_AVX2
+std::size_t find_json_escape_avx2(const char* data, std::size_t size, std::size_t pos) {
+    const __m256i quote = _mm256_set1_epi8('"');
+    const __m256i backslash = _mm256_set1_epi8('\\');
+    const __m256i control_max = _mm256_set1_epi8(0x1F);
+    for (; pos + 32 <= size; pos += 32) {
+        __m256i chunk = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + pos));
+        __m256i control = _mm256_cmpeq_epi8(_mm256_max_epu8(chunk, control_max), control_max);
+        __m256i special = _mm256_or_si256(
+            _mm256_or_si256(_mm256_cmpeq_epi8(chunk, quote), _mm256_cmpeq_epi8(chunk, backslash)), control);
+        auto mask = static_cast<unsigned>(_mm256_movemask_epi8(special));
+        if (mask != 0) {
+            return pos + first_set_bit(mask);
+        }
+    }
+    return find_json_escape_sse2(data, size, pos);
+}
+
+OPENAI_TARGET_AVX2
+std::size_t find_json_quote_avx2(const char* data, std::size_t size, std::size_t pos) {
+    const __m256i quote = _mm256_set1_epi8('"');
+    const __m256i backslash = _mm256_set1_epi8('\\');
+    for (; pos + 32 <= size; pos += 32) {
+        __m256i chunk = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + pos));
+        __m256i special = _mm256_or_si256(_mm256_cmpeq_epi8(chunk, quote), _mm256_cmpeq_epi8(chunk, backslash));
+        auto mask = static_cast<unsigned>(_mm256_movemask_epi8(special));
+        if (mask != 0) {
+            return pos + first_set_bit(mask);
+        }
+    }
+    return find_json_quote_sse2(data, size, pos);
+}
+
+// Mask of bytes within [low, high]. Signed compares: bytes >= 0x80 are
+// negative and fall in no ASCII range.
+OPENAI_TARGET_AVX2
+__m256i bytes_in_range_avx2(__m256i chunk, char low, char high) {
+    return _mm256_and_si256(_mm256_cmpgt_epi8(chunk, _mm256_set1_epi8(static_cast<char>(low - 1))),
+                            _mm256_cmpgt_epi8(_mm256_set1_epi8(static_cast<char>(high + 1)), chunk));
+}
+
+// 32 base64 characters to 24 bytes per iteration. Stops at the first block
+// with a character outside the alphabet, or when a 32-byte store would pass
+// capacity, and returns the number of characters consumed.
+OPENAI_TARGET_AVX2
+std::size_t decode_base64_avx2(const char* data, std::size_t size, unsigned char* out, std::size_t capacity) {
+    std::size_t pos = 0;
+    std::size_t written = 0;
+    for (; pos + 32 <= size && written + 32 <= capacity; pos += 32, written += 24) {
+        __m256i chunk = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + pos));
+
+        __m256i upper = bytes_in_range_avx2(chunk, 'A', 'Z');
+        __m256i lower = bytes_in_range_avx2(chunk, 'a', 'z');
+        __m256i digit = bytes_in_range_avx2(chunk, '0', '9');
+        __m256i plus = _mm256_cmpeq_epi8(chunk, _mm256_set1_epi8('+'));
+        __m256i slash = _mm256_cmpeq_epi8(chunk, _mm256_set1_epi8('/'));
+        __m256i valid = _mm256_or_si256(_mm256_or_si256(upper, lower),
+                                        _mm256_or_si256(digit, _mm256_or_si256(plus, slash)));
+        if (_mm256_movemask_epi8(valid) != -1) {
+            break;
+        }
+
+        // Classes are disjoint, so the per-class offsets can be OR-ed together
+        __m256i shift = _mm256_and_si256(upper, _mm256_set1_epi8(-65));
+        shift = _mm256_or_si256(shift, _mm256_and_si256(lower, _mm256_set1_epi8(-71)));
+        shift = _mm256_or_si256(shift, _mm256_and_si256(digit, _mm256_set1_epi8(4)));
+        shift = _mm256_or_si256(shift, _mm256_and_si256(plus, _mm256_set1_epi8(19)));
+        shift = _mm256_or_si256(shift, _mm256_and_si256(slash, _mm256_set1_epi8(16)));
+        __m256i sextets = _mm256_add_epi8(chunk, shift);
+
+        // Pack four 6-bit values into 24 bits per dword, then gather the
+        // 12 payload bytes of each lane into the low 24 bytes
+        __m256i pairs = _mm256_maddubs_epi16(sextets, _mm256_set1_epi32(0x01400140));
+        __m256i triples = _mm256_madd_epi16(pairs, _mm256_set1_epi32(0x00011000));
+        triples = _mm256_shuffle_epi8(triples, _mm256_setr_epi8(
+            2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1,
+            2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1));
+        triples = _mm256_permutevar8x32_epi32(triples, _mm256_setr_epi32(0, 1, 2, 4, 5, 6, 7, 7));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + written), triples);
+    }
+    return pos;
+}
+
+// CPUID / XGETBV probe; the OS must also have enabled the wider register state
+CpuFeatures detect_cpu_features() {
+    CpuFeatures features;
+#if defined(_MSC_VER) && !defined(__clang__)
+    int info[4];
+    __cpuid(info, 0);
+    if (info[0] < 7) {
+        return features;
+    }
+    __cpuid(info, 1);
+    bool osxsave = (info[2] & (1 << 27)) != 0;
+    bool avx = (info[2] & (1 << 28)) != 0;
+    bool fma = (info[2] & (1 << 12)) != 0;
+    if (!osxsave || !avx) {
+        return features;
+    }
+    auto xcr0 = _xgetbv(0);
+    if ((xcr0 & 0x6) != 0x6) {
+        return features;  // YMM state not enabled by the OS
+    }
+    __cpuidex(info, 7, 0);
+    features.avx2 = (info[1] & (1 << 5)) != 0;
+    features.fma = fma;
+    features.avx512f = (info[1] & (1 << 16)) != 0 && (xcr0 & 0xE6) == 0xE6;
+#else
+    __builtin_cpu_init();
+    features.avx2 = __builtin_cpu_supports("avx2");
+    features.fma = __builtin_cpu_supports("fma");
+    features.avx512f = __builtin_cpu_supports("avx512f");
+#endif
+    return features;
+}
+
+#endif // OPENAI_X86_SIMD
+
+using ScanKernel = std::size_t (*)(const char*, std::size_t, std::size_t);
+
+struct ScanKernels {
+    ScanKernel find_escape;
+    ScanKernel find_quote;
+};
+
+// Picked once from the running CPU
+const ScanKernels& scan_kernels() {
+    static const ScanKernels kernels = [] {
+#if defined(OPENAI_X86_SIMD)
+        if (cpu_features().avx2) {
+            return ScanKernels{find_json_escape_avx2, find_json_quote_avx2};
+        }
+        return ScanKernels{find_json_escape_sse2, find_json_quote_sse2};
+#else
+        return ScanKernels{find_json_escape_scalar, find_json_quote_scalar};
+#endif
+    }();
+    return kernels;
+}
+
+// Bulk base64 decoder; returns the number of characters it consumed and
+// leaves the rest (and any error) to the scalar loop
+using Base64Kernel = std::size_t (*)(const char*, std::size_t, unsigned char*, std::size_t);
+
+std::size_t decode_base64_none(const char*, std::size_t, unsigned char*, std::size_t) {
+    return 0;
+}
+
+Base64Kernel base64_kernel() {
+    static const Base64Kernel kernel = [] {
+#if defined(OPENAI_X86_SIMD)
+        if (cpu_features().avx2) {
+            return Base64Kernel{decode_base64_avx2};
+        }
+#endif
+        return Base64Kernel{decode_base64_none};
+    }();
+    return kernel;
+}
+
+// Sextet value of each base64 character, or -1
+constexpr auto base64_values = [] {
+    std::array<std::int8_t, 256> table{};
+    table.fill(-1);
+    constexpr std::string_view alphabet = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+    for (std::size_t i = 0; i < alphabet.size(); ++i) {
+        table[static_cast<unsigned char>(alphabet[i])] = static_cast<std::int8_t>(i);
+    }
+    return table;
+}();
+
+void append_utf8(std::string& out, std::uint32_t cp) {
+    if (cp < 0x80) {
+        out += static_cast<char>(cp);
+    } else if (cp < 0x800) {
+        out += static_cast<char>(0xC0 | (cp >> 6));
+        out += static_cast<char>(0x80 | (cp & 0x3F));
+    } else if (cp < 0x10000) {
+        out += static_cast<char>(0xE0 | (cp >> 12));
+        out += static_cast<char>(0x80 | ((cp >> 6) & 0x3F));
+        out += static_cast<char>(0x80 | (cp & 0x3F));
+    } else {
+        out += static_cast<char>(0xF0 | (cp >> 18));
+        out += static_cast<char>(0x80 | ((cp >> 12) & 0x3F));
+        out += static_cast<char>(0x80 | ((cp >> 6) & 0x3F));
+        out += static_cast<char>(0x80 | (cp & 0x3F));
+    }
+}
+
+// Four hex digits at str[pos], or -1
+std::int32_t parse_hex4(std::string_view str, std::size_t pos) {
+    if (pos + 4 > str.size()) {
+        return -1;
+    }
+    std::int32_t value = 0;
+    for (std::size_t i = pos; i < pos + 4; ++i) {
+        char c = str[i];
+        int digit;
+        if (c >= '0' && c <= '9') digit = c - '0';
+        else if (c >= 'a' && c <= 'f') digit = c - 'a' + 10;
+        else if (c >= 'A' && c <= 'F') digit = c - 'A' + 10;
+        else return -1;
+        value = (value << 4) | digit;
+    }
+    return value;
+}
+
+} // namespace
+
+const CpuFeatures& cpu_features() {
+#if defined(OPENAI_X86_SIMD)
+    static const CpuFeatures features = detect_cpu_features();
+#else
+    static const CpuFeatures features;
+#endif
+    return features;
+}
+
+std::size_t find_json_escape(std::string_view str, std::size_t pos) {
+    if (pos >= str.size()) {
+        return str.size();
+    }
+    return scan_kernels().find_escape(str.data(), str.size(), pos);
+}
+
+std::size_t find_json_quote(std::string_view str, std::size_t pos) {
+    if (pos >= str.size()) {
+        return str.size();
+    }
+    return scan_kernels().find_quote(str.data(), str.size(), pos);
+}
+
+std::string_view json_escape_sequence(unsigned char c, char (&scratch)[6]) {
+    switch (c) {
+        case '"': return "\\\"";
+        case '\\': return "\\\\";
+        case '\b': return "\\b";
+        case '\f': return "\\f";
+        case '\n': return "\\n";
+        case '\r': return "\\r";
+        case '\t': return "\\t";
+        default: {
+            constexpr char hex[] = "0123456789abcdef";
+            scratch[0] = '\\';
+            scratch[1] = 'u';
+            scratch[2] = '0';
+            scratch[3] = '0';
+            scratch[4] = hex[c >> 4];
+            scratch[5] = hex[c & 0xF];
+            return std::string_view(scratch, 6);
+        }
+    }
+}
+
+std::size_t decode_json_escape(std::string_view str, std::size_t pos, std::string& out) {
+    if (pos >= str.size()) {
+        return std::string_view::npos;
+    }
+    switch (str[pos]) {
+        case '"': out += '"'; return pos + 1;
+        case '\\': out += '\\'; return pos + 1;
+        case '/': out += '/'; return pos + 1;
+        case 'b': out += '\b'; return pos + 1;
+        case 'f': out += '\f'; return pos + 1;
+        case 'n': out += '\n'; return pos + 1;
+        case 'r': out += '\r'; return pos + 1;
+        case 't': out += '\t'; return pos + 1;
+        case 'u': break;
+        default: return std::string_view::npos;
+    }
+
+    auto unit = parse_hex4(str, pos + 1);
+    if (unit < 0) {
+        return std::string_view::npos;
+    }
+    pos += 5;
+    auto cp = static_cast<std::uint32_t>(unit);
+
+    if (cp >= 0xD800 && cp <= 0xDBFF) {
+        // High surrogate: combine with a following \uDC00-\uDFFF
+        if (str.substr(pos, 2) == "\\u") {
+            auto low = parse_hex4(str, pos + 2);
+            if (low >= 0xDC00 && low <= 0xDFFF) {
+                append_utf8(out, 0x10000 + ((cp - 0xD800) << 10) + (static_cast<std::uint32_t>(low) - 0xDC00));
+                return pos + 6;
+            }
+        }
+        cp = 0xFFFD;  // Unpaired surrogate
+    } else if (cp >= 0xDC00 && cp <= 0xDFFF) {
+        cp = 0xFFFD;
+    }
+    append_utf8(out, cp);
+    return pos;
+}
+
 // Helper function to escape JSON strings
-std::string escape_json(const std::string& str) {
-    std::ostringstream escaped;
-    for (char c : str) {
-        switch (c) {
-            case '"': escaped << "\\\""; break;
-            case '\\': escaped << "\\\\"; break;
-            case '\b': escaped << "\\b"; break;
-            case '\f': escaped << "\\f"; break;
-            case '\n': escaped << "\\n"; break;
-            case '\r': escaped << "\\r"; break;
-            case '\t': escaped << "\\t"; break;
-            default:
-                if (c < 0x20) {
-                    escaped << fmt::format("\\u{:04x}", static_cast<unsigned char>(c));
-                } else {
-                    escaped << c;
-                }
-        }
-    }
-    return escaped.str();
+std::string escape_json(std::string_view str) {
+    std::string escaped;
+    escaped.reserve(str.size() + str.size() / 8);
+    escape_json_to(str, [&escaped](const char* data, std::size_t size) { escaped.append(data, size); });
+    return escaped;
+}
+
+// Helper function to unescape JSON strings
+std::string unescape_json(std::string_view str) {
+    std::string result;
+    result.reserve(str.size());
+
+    std::size_t pos = 0;
+    while (pos < str.size()) {
+        auto next = find_json_quote(str, pos);
+        result.append(str.data() + pos, next - pos);
+        if (next == str.size()) {
+            break;
+        }
+        if (str[next] == '"') {
+            result += '"';
+            pos = next + 1;
+            continue;
+        }
+        auto end = decode_json_escape(str, next + 1, result);
+        if (end == std::string_view::npos) {
+            result += '\\';
+            pos = next + 1;
+        } else {
+            pos = end;
+        }
+    }
+    return result;
+}
+
+std::size_t base64_decoded_size(std::string_view base64) {
+    auto size = base64.size();
+    for (int i = 0; i < 2 && size > 0 && base64[size - 1] == '='; ++i) {
+        --size;
+    }
+    return size / 4 * 3 + (size % 4 == 0 ? 0 : size % 4 - 1);
+}
+
+bool decode_base64(std::string_view base64, unsigned char* out) {
+    auto size = base64.size();
+    for (int i = 0; i < 2 && size > 0 && base64[size - 1] == '='; ++i) {
+        --size;
+    }
+    if (size % 4 == 1 || (size != base64.size() && base64.size() % 4 != 0)) {
+        return false;
+    }
+
+    const char* data = base64.data();
+    auto capacity = base64_decoded_size(base64);
+    auto pos = base64_kernel()(data, size, out, capacity);
+    out += pos / 4 * 3;
+
+    auto value = [&](std::size_t i) { return base64_values[static_cast<unsigned char>(data[i])]; };
+    for (; pos + 4 <= size; pos += 4) {
+        int a = value(pos), b = value(pos + 1), c = value(pos + 2), d = value(pos + 3);
+        if ((a | b | c | d) < 0) {
+            return false;
+        }
+        auto triple = static_cast<std::uint32_t>((a << 18) | (b << 12) | (c << 6) | d);
+        *out++ = static_cast<unsigned char>(triple >> 16);
+        *out++ = static_cast<unsigned char>(triple >> 8);
+        *out++ = static_cast<unsigned char>(triple);
+    }
+
+    // Final 2 or 3 characters of unpadded or '='-padded input
+    if (pos < size) {
+        int a = value(pos), b = value(pos + 1);
+        int c = pos + 2 < size ? value(pos + 2) : 0;
+        if ((a | b | c) < 0) {
+            return false;
+        }
+        auto triple = static_cast<std::uint32_t>((a << 18) | (b << 12) | (c << 6));
+        *out++ = static_cast<unsigned char>(triple >> 16);
+        if (pos + 2 < size) {
+            *out++ = static_cast<unsigned char>(triple >> 8);
+        }
+    }
+    return true;
+}
+
+MappedFile::MappedFile(const std::string& path) {
+#if defined(_WIN32)
+    HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE, nullptr,
+                              OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE) {
+        throw std::runtime_error("Failed to open file: " + path);
+    }
+    file_ = file;
+    LARGE_INTEGER size;
+    GetFileSizeEx(file, &size);
+    size_ = static_cast<std::size_t>(size.QuadPart);
+    if (size_ > 0) {
+        mapping_ = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        if (mapping_ != nullptr) {
+            data_ = static_cast<const std::byte*>(MapViewOfFile(mapping_, FILE_MAP_READ, 0, 0, 0));
+        }
+        if (data_ == nullptr) {
+            close();
+            throw std::runtime_error("Failed to map file: " + path);
+        }
+    }
+#else
+    fd_ = ::open(path.c_str(), O_RDONLY);
+    if (fd_ < 0) {
+        throw std::runtime_error("Failed to open file: " + path);
+    }
+    struct stat info {};
+    ::fstat(fd_, &info);
+    size_ = static_cast<std::size_t>(info.st_size);
+    if (size_ > 0) {
+        void* data = ::mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd_, 0);
+        if (data == MAP_FAILED) {
+            close();
+            throw std::runtime_error("Failed to map file: " + path);
+        }
+        data_ = static_cast<const std::byte*>(data);
+    }
+#endif
+}
+
+MappedFile::~MappedFile() {
+    close();
+}
+
+void MappedFile::close() {
+#if defined(_WIN32)
+    if (data_ != nullptr) UnmapViewOfFile(data_);
+    if (mapping_ != nullptr) CloseHandle(mapping_);
+    if (file_ != nullptr) CloseHandle(file_);
+    file_ = nullptr;
+    mapping_ = nullptr;
+#else
+    if (data_ != nullptr) ::munmap(const_cast<std::byte*>(data_), size_);
+    if (fd_ >= 0) ::close(fd_);
+    fd_ = -1;
+#endif
+    data_ = nullptr;
+}
+
+std::array<std::uint8_t, 32> hash_fields(std::initializer_list<std::string_view> fields) {
+    std::unique_ptr<EVP_MD_CTX, decltype(&EVP_MD_CTX_free)> context(EVP_MD_CTX_new(), &EVP_MD_CTX_free);
+    if (!context || EVP_DigestInit_ex(context.get(), EVP_sha256(), nullptr) != 1) {
+        throw std::runtime_error("SHA-256 unavailable");
+    }
+    for (auto field : fields) {
+        std::uint64_t size = field.size();
+        EVP_DigestUpdate(context.get(), &size, sizeof(size));
+        EVP_DigestUpdate(context.get(), field.data(), field.size());
+    }
+    std::array<std::uint8_t, 32> digest{};
+    unsigned int size = 0;
+    EVP_DigestFinal_ex(context.get(), digest.data(), &size);
+    return digest;
 }
 
 } // namespace openai
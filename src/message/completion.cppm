@@ -6,6 +6,7 @@ export module openai.types.completion;
 import std;
 import fmt;
 import openai.types.common;
+import openai.types.json;
 
 export namespace openai {
 
@@ -31,6 +32,23 @@ struct CompletionRequest {
     std::optional<std::string> user;
     
     std::string to_json() const;
+    void write_json(JsonWriter& json) const;
+};
+
+// Completion choice
+struct CompletionChoice {
+    int index{0};
+    std::string text;
+    std::string finish_reason;
+};
+
+// Completion response
+struct CompletionResponse {
+    std::string id;
+    std::string object;
+    std::int64_t created{0};
+    std::string model;
+    std::vector<CompletionChoice> choices;
 };
 
 // ============================================================================
@@ -47,8 +65,13 @@ struct EditRequest {
     std::optional<float> top_p{1.0f};
     
     std::string to_json() const;
+    void write_json(JsonWriter& json) const;
 };
 
+// JSON decoding
+void read_json(JsonReader& reader, CompletionChoice& out);
+void read_json(JsonReader& reader, CompletionResponse& out);
+
 } // namespace openai
 
 // ============================================================================
@@ -59,63 +82,65 @@ namespace openai {
 
 // CompletionRequest::to_json implementation
 std::string CompletionRequest::to_json() const {
-    std::ostringstream json;
-    json << "{";
-    json << fmt::format(R"("model":"{}")", model);
-    json << fmt::format(R"(,"prompt":"{}")", escape_json(prompt));
-    
-    if (max_tokens) {
-        json << fmt::format(R"(,"max_tokens":{})", *max_tokens);
-    }
-    if (temperature) {
-        json << fmt::format(R"(,"temperature":{})", *temperature);
-    }
-    if (top_p) {
-        json << fmt::format(R"(,"top_p":{})", *top_p);
-    }
-    if (n) {
-        json << fmt::format(R"(,"n":{})", *n);
-    }
-    if (stream) {
-        json << fmt::format(R"(,"stream":{})", *stream ? "true" : "false");
-    }
-    if (echo) {
-        json << fmt::format(R"(,"echo":{})", *echo ? "true" : "false");
-    }
-    if (presence_penalty) {
-        json << fmt::format(R"(,"presence_penalty":{})", *presence_penalty);
-    }
-    if (frequency_penalty) {
-        json << fmt::format(R"(,"frequency_penalty":{})", *frequency_penalty);
-    }
-    if (best_of) {
-        json << fmt::format(R"(,"best_of":{})", *best_of);
-    }
-    
-    json << "}";
-    return json.str();
+    return to_json_string(*this);
+}
+
+// CompletionRequest::write_json implementation
+void CompletionRequest::write_json(JsonWriter& json) const {
+    json.begin_object();
+    json.field("model", model);
+    json.field("prompt", prompt);
+    json.field("max_tokens", max_tokens);
+    json.field("temperature", temperature);
+    json.field("top_p", top_p);
+    json.field("n", n);
+    json.field("stream", stream);
+    json.field("logprobs", logprobs);
+    json.field("echo", echo);
+    json.field("stop", stop);
+    json.field("presence_penalty", presence_penalty);
+    json.field("frequency_penalty", frequency_penalty);
+    json.field("best_of", best_of);
+    json.field("user", user);
+    json.end_object();
 }
 
 // EditRequest::to_json implementation
 std::string EditRequest::to_json() const {
-    std::ostringstream json;
-    json << "{";
-    json << fmt::format(R"("model":"{}")", model);
-    json << fmt::format(R"(,"input":"{}")", escape_json(input));
-    json << fmt::format(R"(,"instruction":"{}")", escape_json(instruction));
-    
-    if (n) {
-        json << fmt::format(R"(,"n":{})", *n);
-    }
-    if (temperature) {
-        json << fmt::format(R"(,"temperature":{})", *temperature);
-    }
-    if (top_p) {
-        json << fmt::format(R"(,"top_p":{})", *top_p);
-    }
-    
-    json << "}";
-    return json.str();
+    return to_json_string(*this);
+}
+
+// EditRequest::write_json implementation
+void EditRequest::write_json(JsonWriter& json) const {
+    json.begin_object();
+    json.field("model", model);
+    json.field("input", input);
+    json.field("instruction", instruction);
+    json.field("n", n);
+    json.field("temperature", temperature);
+    json.field("top_p", top_p);
+    json.end_object();
+}
+
+
+void read_json(JsonReader& reader, CompletionChoice& out) {
+    reader.object([&](std::string_view key) {
+        if (key == "index") reader.read(out.index);
+        else if (key == "text") reader.read(out.text);
+        else if (key == "finish_reason") reader.read(out.finish_reason);
+        else reader.skip();
+    });
+}
+
+void read_json(JsonReader& reader, CompletionResponse& out) {
+    reader.object([&](std::string_view key) {
+        if (key == "id") reader.read(out.id);
+        else if (key == "object") reader.read(out.object);
+        else if (key == "created") reader.read(out.created);
+        else if (key == "model") reader.read(out.model);
+        else if (key == "choices") reader.read(out.choices);
+        else reader.skip();
+    });
 }
 
 } // namespace openai
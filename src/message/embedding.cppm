@@ -6,6 +6,7 @@ export module openai.types.embedding;
 import std;
 import fmt;
 import openai.types.common;
+import openai.types.json;
 
 export namespace openai {
 
@@ -13,19 +14,50 @@ export namespace openai {
 // EMBEDDINGS API - Request & Response Types
 // ============================================================================
 
+// Embedding input: one text or an array of texts, each embedded separately.
+// Response data[i].index refers to texts[i].
+struct EmbeddingInput {
+    std::vector<std::string> texts;
+    bool array{false};  // Send a JSON array even for a single text
+
+    EmbeddingInput() = default;
+    EmbeddingInput(std::string text) : texts{std::move(text)} {}
+    EmbeddingInput(const char* text) : texts{std::string(text)} {}
+    EmbeddingInput(std::vector<std::string> items) : texts(std::move(items)), array(true) {}
+    EmbeddingInput(std::initializer_list<std::string> items) : texts(items), array(true) {}
+
+    std::size_t size() const { return texts.size(); }
+    bool empty() const { return texts.empty(); }
+
+    void write_json(JsonWriter& json) const;
+};
+
+// Merging of concurrent create_embedding calls into shared requests.
+// Calls with the same model and options that arrive within window are sent
+// as one array request; each caller receives only its own embeddings.
+struct EmbeddingCoalescingOptions {
+    bool enabled{false};
+    std::chrono::milliseconds window{5};  // How long a batch waits for more calls
+    std::size_t max_items{2048};          // Inputs per merged request (API limit)
+    std::size_t max_tokens{300000};       // Estimated tokens per merged request (API limit)
+};
+
 // Embedding request
 struct EmbeddingRequest {
     std::string model{"text-embedding-ada-002"};
-    std::string input;
+    EmbeddingInput input;
+    std::optional<std::string> encoding_format;  // "float" (default) or "base64"
+    std::optional<int> dimensions;               // text-embedding-3 and later
     std::optional<std::string> user;
     
     std::string to_json() const;
+    void write_json(JsonWriter& json) const;
 };
 
 // Embedding data
 struct EmbeddingData {
     std::string object;
-    std::vector<float> embedding;
+    std::vector<float> embedding;  // Decoded from either encoding_format
     int index{0};
 };
 
@@ -43,6 +75,16 @@ struct EmbeddingResponse {
     EmbeddingUsage usage;
 };
 
+// Decode an encoding_format "base64" embedding (packed little-endian
+// float32) straight into out. False if the text is not valid base64 of
+// whole floats.
+bool decode_base64_embedding(std::string_view base64, std::vector<float>& out);
+
+// JSON decoding
+void read_json(JsonReader& reader, EmbeddingData& out);
+void read_json(JsonReader& reader, EmbeddingUsage& out);
+void read_json(JsonReader& reader, EmbeddingResponse& out);
+
 } // namespace openai
 
 // ============================================================================
@@ -51,19 +93,82 @@ struct EmbeddingResponse {
 
 namespace openai {
 
+// EmbeddingInput::write_json implementation
+void EmbeddingInput::write_json(JsonWriter& json) const {
+    if (!array && texts.size() == 1) {
+        json.string(texts.front());
+        return;
+    }
+    json.value(texts);
+}
+
 // EmbeddingRequest::to_json implementation
 std::string EmbeddingRequest::to_json() const {
-    std::ostringstream json;
-    json << "{";
-    json << fmt::format(R"("model":"{}")", model);
-    json << fmt::format(R"(,"input":"{}")", escape_json(input));
-    
-    if (user) {
-        json << fmt::format(R"(,"user":"{}")", *user);
+    return to_json_string(*this);
+}
+
+// EmbeddingRequest::write_json implementation
+void EmbeddingRequest::write_json(JsonWriter& json) const {
+    json.begin_object();
+    json.field("model", model);
+    json.field("input", input);
+    json.field("encoding_format", encoding_format);
+    json.field("dimensions", dimensions);
+    json.field("user", user);
+    json.end_object();
+}
+
+bool decode_base64_embedding(std::string_view base64, std::vector<float>& out) {
+    auto bytes = base64_decoded_size(base64);
+    if (bytes % sizeof(float) != 0) {
+        return false;
     }
-    
-    json << "}";
-    return json.str();
+    out.resize(bytes / sizeof(float));
+    if (!decode_base64(base64, reinterpret_cast<unsigned char*>(out.data()))) {
+        return false;
+    }
+    if constexpr (std::endian::native == std::endian::big) {
+        for (auto& value : out) {
+            value = std::bit_cast<float>(std::byteswap(std::bit_cast<std::uint32_t>(value)));
+        }
+    }
+    return true;
+}
+
+void read_json(JsonReader& reader, EmbeddingData& out) {
+    reader.object([&](std::string_view key) {
+        if (key == "object") reader.read(out.object);
+        else if (key == "embedding") {
+            if (reader.peek() == JsonType::String) {
+                auto offset = reader.offset();
+                if (!decode_base64_embedding(reader.text(), out.embedding)) {
+                    throw JsonError("Invalid base64 embedding", offset);
+                }
+            } else {
+                reader.read(out.embedding);
+            }
+        }
+        else if (key == "index") reader.read(out.index);
+        else reader.skip();
+    });
+}
+
+void read_json(JsonReader& reader, EmbeddingUsage& out) {
+    reader.object([&](std::string_view key) {
+        if (key == "prompt_tokens") reader.read(out.prompt_tokens);
+        else if (key == "total_tokens") reader.read(out.total_tokens);
+        else reader.skip();
+    });
+}
+
+void read_json(JsonReader& reader, EmbeddingResponse& out) {
+    reader.object([&](std::string_view key) {
+        if (key == "object") reader.read(out.object);
+        else if (key == "data") reader.read(out.data);
+        else if (key == "model") reader.read(out.model);
+        else if (key == "usage") reader.read(out.usage);
+        else reader.skip();
+    });
 }
 
 } // namespace openai
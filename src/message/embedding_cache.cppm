@@ -0,0 +1,315 @@
+// Embedding Cache Module
+// Content-addressed embedding cache: sharded in-memory LRU over an append-only mapped file
+
+export module openai.types.embedding_cache;
+
+import std;
+import openai.types.common;
+
+export namespace openai {
+
+// ============================================================================
+// EMBEDDING CACHE - Persistent (model, dimensions, text) -> vector store
+// ============================================================================
+
+struct EmbeddingCacheOptions {
+    std::string path;                             // Store file; empty keeps the cache in memory only
+    std::size_t memory_bytes{256 * 1024 * 1024};  // LRU budget for vectors, split across shards
+    std::size_t shards{16};                       // Independently locked LRU partitions
+};
+
+// Cache counters (safe to read while lookups are in flight)
+struct EmbeddingCacheMetrics {
+    std::atomic<std::uint64_t> memory_hits{0};
+    std::atomic<std::uint64_t> disk_hits{0};
+    std::atomic<std::uint64_t> misses{0};
+    std::atomic<std::uint64_t> inserts{0};
+    std::atomic<std::uint64_t> memory_bytes{0};  // Vector bytes held by the LRU
+    std::atomic<std::uint64_t> disk_bytes{0};    // Size of the store file
+    std::atomic<std::uint64_t> bytes_served{0};  // Vector bytes returned from hits
+};
+
+// Embeddings keyed by SHA-256 of (model, dimensions, text). Lookups check a
+// sharded LRU, then the store file, which is memory-mapped and indexed by
+// key when the cache is opened. New vectors are appended to the file; a torn
+// record at its end (after a crash) is truncated on open. A store file must
+// only be written by one process at a time. All methods are thread-safe.
+class EmbeddingCache {
+public:
+    using Key = std::array<std::uint8_t, 32>;
+
+    explicit EmbeddingCache(EmbeddingCacheOptions options = {});
+    ~EmbeddingCache();
+
+    EmbeddingCache(const EmbeddingCache&) = delete;
+    EmbeddingCache& operator=(const EmbeddingCache&) = delete;
+
+    // dimensions is the requested output size, or 0 for the model default
+    static Key make_key(std::string_view model, int dimensions, std::string_view text);
+
+    // Copy the cached vector into out; false on a miss
+    bool find(const Key& key, std::vector<float>& out);
+
+    // Remember a vector (persisted when a path is set); existing keys are kept
+    void insert(const Key& key, std::span<const float> values);
+
+    // Push appended records to the file
+    void flush();
+
+    std::size_t disk_entries() const;
+    const EmbeddingCacheOptions& options() const { return options_; }
+    const EmbeddingCacheMetrics& metrics() const { return metrics_; }
+
+private:
+    struct KeyHash {
+        std::size_t operator()(const Key& key) const {
+            std::size_t hash;
+            std::memcpy(&hash, key.data(), sizeof(hash));  // Already uniformly distributed
+            return hash;
+        }
+    };
+
+    struct Entry {
+        std::vector<float> values;
+        std::list<Key>::iterator position;
+    };
+
+    struct Shard {
+        std::mutex mutex;
+        std::list<Key> order;  // Most recently used first
+        std::unordered_map<Key, Entry, KeyHash> entries;
+        std::size_t bytes{0};
+    };
+
+    struct DiskRecord {
+        std::uint64_t offset;  // First float
+        std::uint32_t dimensions;
+    };
+
+    Shard& shard_for(const Key& key) { return shards_[key[1] % shards_.size()]; }
+    void remember(const Key& key, std::span<const float> values);
+    bool find_on_disk(const Key& key, std::vector<float>& out);
+    void open_store();
+
+    EmbeddingCacheOptions options_;
+    std::vector<Shard> shards_;
+    std::size_t shard_budget_;
+
+    mutable std::mutex disk_mutex_;  // Guards everything below
+    std::unordered_map<Key, DiskRecord, KeyHash> disk_index_;
+    std::shared_ptr<const MappedFile> mapping_;
+    std::ofstream store_;
+    std::uint64_t store_size_{0};
+    bool unflushed_{false};
+
+    EmbeddingCacheMetrics metrics_;
+};
+
+} // namespace openai
+
+// ============================================================================
+// Implementation
+// ============================================================================
+
+namespace openai {
+
+namespace {
+
+// Store file layout, native byte order:
+//   header  magic (8 bytes), version (u32), reserved (u32)
+//   record  key (32 bytes), dimensions (u32), reserved (u32), dimensions x float32
+constexpr std::array<char, 8> store_magic = {'O', 'A', 'I', 'E', 'M', 'B', 'C', '1'};
+constexpr std::uint32_t store_version = 1;
+constexpr std::size_t store_header_size = 16;
+constexpr std::size_t record_header_size = 40;
+
+} // namespace
+
+EmbeddingCache::EmbeddingCache(EmbeddingCacheOptions options)
+    : options_(std::move(options))
+    , shards_(std::max<std::size_t>(options_.shards, 1))
+    , shard_budget_(options_.memory_bytes / shards_.size()) {
+    if (!options_.path.empty()) {
+        open_store();
+    }
+}
+
+EmbeddingCache::~EmbeddingCache() {
+    if (store_.is_open()) {
+        store_.flush();
+    }
+}
+
+EmbeddingCache::Key EmbeddingCache::make_key(std::string_view model, int dimensions, std::string_view text) {
+    return hash_fields({model, std::to_string(dimensions), text});
+}
+
+bool EmbeddingCache::find(const Key& key, std::vector<float>& out) {
+    {
+        auto& shard = shard_for(key);
+        std::lock_guard lock(shard.mutex);
+        auto it = shard.entries.find(key);
+        if (it != shard.entries.end()) {
+            shard.order.splice(shard.order.begin(), shard.order, it->second.position);
+            out = it->second.values;
+            ++metrics_.memory_hits;
+            metrics_.bytes_served += out.size() * sizeof(float);
+            return true;
+        }
+    }
+    if (find_on_disk(key, out)) {
+        remember(key, out);
+        ++metrics_.disk_hits;
+        metrics_.bytes_served += out.size() * sizeof(float);
+        return true;
+    }
+    ++metrics_.misses;
+    return false;
+}
+
+void EmbeddingCache::insert(const Key& key, std::span<const float> values) {
+    remember(key, values);
+    ++metrics_.inserts;
+    if (!store_.is_open()) {
+        return;
+    }
+
+    std::lock_guard lock(disk_mutex_);
+    if (disk_index_.contains(key)) {
+        return;
+    }
+    std::array<std::uint32_t, 2> header = {static_cast<std::uint32_t>(values.size()), 0};
+    store_.write(reinterpret_cast<const char*>(key.data()), static_cast<std::streamsize>(key.size()));
+    store_.write(reinterpret_cast<const char*>(header.data()), sizeof(header));
+    store_.write(reinterpret_cast<const char*>(values.data()),
+                 static_cast<std::streamsize>(values.size_bytes()));
+    if (!store_) {
+        throw std::runtime_error("Failed to append to embedding cache: " + options_.path);
+    }
+    disk_index_[key] = {store_size_ + record_header_size, static_cast<std::uint32_t>(values.size())};
+    store_size_ += record_header_size + values.size_bytes();
+    metrics_.disk_bytes = store_size_;
+    unflushed_ = true;
+}
+
+void EmbeddingCache::flush() {
+    std::lock_guard lock(disk_mutex_);
+    if (store_.is_open()) {
+        store_.flush();
+        unflushed_ = false;
+    }
+}
+
+std::size_t EmbeddingCache::disk_entries() const {
+    std::lock_guard lock(disk_mutex_);
+    return disk_index_.size();
+}
+
+// Insert into the LRU, evicting least recently used entries over budget
+void EmbeddingCache::remember(const Key& key, std::span<const float> values) {
+    const auto bytes = values.size_bytes();
+    if (bytes > shard_budget_) {
+        return;
+    }
+    auto& shard = shard_for(key);
+    std::lock_guard lock(shard.mutex);
+    if (shard.entries.contains(key)) {
+        return;
+    }
+    shard.order.push_front(key);
+    shard.entries.emplace(key, Entry{std::vector<float>(values.begin(), values.end()), shard.order.begin()});
+    shard.bytes += bytes;
+    metrics_.memory_bytes += bytes;
+
+    while (shard.bytes > shard_budget_) {
+        auto victim = shard.entries.find(shard.order.back());
+        auto victim_bytes = victim->second.values.size() * sizeof(float);
+        shard.bytes -= victim_bytes;
+        metrics_.memory_bytes -= victim_bytes;
+        shard.entries.erase(victim);
+        shard.order.pop_back();
+    }
+}
+
+bool EmbeddingCache::find_on_disk(const Key& key, std::vector<float>& out) {
+    if (options_.path.empty()) {
+        return false;
+    }
+    std::lock_guard lock(disk_mutex_);
+    auto it = disk_index_.find(key);
+    if (it == disk_index_.end()) {
+        return false;
+    }
+    const auto [offset, dimensions] = it->second;
+    const auto end = offset + std::uint64_t{dimensions} * sizeof(float);
+
+    // Records appended since the file was mapped need a fresh mapping
+    if (!mapping_ || mapping_->size() < end) {
+        if (unflushed_) {
+            store_.flush();
+            unflushed_ = false;
+        }
+        mapping_ = std::make_shared<const MappedFile>(options_.path);
+        if (mapping_->size() < end) {
+            return false;
+        }
+    }
+    out.resize(dimensions);
+    std::memcpy(out.data(), mapping_->data() + offset, dimensions * sizeof(float));
+    return true;
+}
+
+// Index existing records, drop a torn tail, and open the file for appending
+void EmbeddingCache::open_store() {
+    const auto& path = options_.path;
+    auto size = std::filesystem::exists(path) ? std::filesystem::file_size(path) : 0;
+
+    std::uint64_t valid = 0;
+    if (size > 0) {
+        mapping_ = std::make_shared<const MappedFile>(path);
+        const auto* data = mapping_->data();
+        if (size < store_header_size || std::memcmp(data, store_magic.data(), store_magic.size()) != 0) {
+            throw std::runtime_error("Not an embedding cache file: " + path);
+        }
+        std::uint32_t version;
+        std::memcpy(&version, data + store_magic.size(), sizeof(version));
+        if (version != store_version) {
+            throw std::runtime_error("Unsupported embedding cache version: " + path);
+        }
+
+        valid = store_header_size;
+        while (valid + record_header_size <= size) {
+            Key key;
+            std::uint32_t dimensions;
+            std::memcpy(key.data(), data + valid, key.size());
+            std::memcpy(&dimensions, data + valid + key.size(), sizeof(dimensions));
+            auto end = valid + record_header_size + std::uint64_t{dimensions} * sizeof(float);
+            if (end > size) {
+                break;
+            }
+            disk_index_.try_emplace(key, DiskRecord{valid + record_header_size, dimensions});
+            valid = end;
+        }
+    }
+
+    if (valid < size) {
+        mapping_.reset();
+        std::filesystem::resize_file(path, valid);
+    }
+    store_.open(path, std::ios::binary | std::ios::app);
+    if (!store_) {
+        throw std::runtime_error("Failed to open embedding cache: " + path);
+    }
+    if (valid == 0) {
+        std::array<char, store_header_size> header{};
+        std::memcpy(header.data(), store_magic.data(), store_magic.size());
+        std::memcpy(header.data() + store_magic.size(), &store_version, sizeof(store_version));
+        store_.write(header.data(), header.size());
+        store_.flush();
+        valid = store_header_size;
+    }
+    store_size_ = valid;
+    metrics_.disk_bytes = store_size_;
+}
+
+} // namespace openai
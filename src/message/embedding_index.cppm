@@ -0,0 +1,1031 @@
+// Embedding Index Module
+// In-process nearest-neighbor search over embeddings: SIMD flat scan and HNSW graph
+
+module;
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define OPENAI_X86_SIMD 1
+#include <immintrin.h>
+#endif
+
+export module openai.types.embedding_index;
+
+import std;
+import fmt;
+import openai.types.common;
+import openai.types.embedding_matrix;
+
+namespace openai {
+
+// Vectors of an index: owned and appendable, or read in place from a mapped
+// index file until the first add. Rows are padded to the matrix stride and,
+// for cosine, stored normalized.
+class VectorStore {
+public:
+    VectorStore(std::size_t dimensions, bool normalize);
+
+    // Copies and moves point at their own rows unless both share a mapping
+    VectorStore(const VectorStore& other);
+    VectorStore(VectorStore&& other) noexcept;
+    VectorStore& operator=(const VectorStore& other);
+    VectorStore& operator=(VectorStore&& other) noexcept;
+
+    std::size_t size() const { return size_; }
+    std::size_t dimensions() const { return dimensions_; }
+    std::size_t stride() const { return stride_; }
+    const float* row(std::size_t index) const { return data_ + index * stride_; }
+
+    void append(EmbeddingMatrixView rows);
+
+    // Padded (and for cosine, normalized) copy of a query
+    EmbeddingMatrix prepare(std::span<const float> query) const;
+
+    EmbeddingMatrixView view() const { return {data_, size_, dimensions_, stride_}; }
+
+    void map(std::shared_ptr<const MappedFile> mapping, std::size_t offset, std::size_t count);
+
+private:
+    void normalize_rows(std::size_t first);
+
+    std::size_t dimensions_;
+    std::size_t stride_;
+    bool normalize_;
+    EmbeddingMatrix owned_;
+    std::shared_ptr<const MappedFile> mapping_;
+    const float* data_{nullptr};
+    std::size_t size_{0};
+};
+
+} // namespace openai
+
+export namespace openai {
+
+// ============================================================================
+// EMBEDDING INDEX - Top-k similarity search
+// ============================================================================
+
+enum class IndexMetric {
+    Cosine,  // Vectors and queries are normalized; score in [-1, 1]
+    Dot      // Raw inner product
+};
+
+struct SearchResult {
+    std::size_t id;  // Insertion order, starting at 0
+    float score;     // Higher is more similar
+};
+
+// Dot product of two float arrays, using AVX-512F or AVX2+FMA when available
+float dot_product(const float* a, const float* b, std::size_t size);
+
+// Exact search: every query is scored against every vector with the SIMD dot
+// product. Best up to ~100k vectors, and the reference for HNSW recall.
+class FlatIndex {
+public:
+    explicit FlatIndex(std::size_t dimensions, IndexMetric metric = IndexMetric::Cosine);
+
+    std::size_t size() const { return store_.size(); }
+    std::size_t dimensions() const { return store_.dimensions(); }
+    IndexMetric metric() const { return metric_; }
+
+    // Append vectors; ids continue from size(). Throws std::invalid_argument
+    // if the dimensions differ.
+    void add(std::span<const float> vector);
+    void add(EmbeddingMatrixView vectors);
+
+    // Best k matches, highest score first
+    std::vector<SearchResult> search(std::span<const float> query, std::size_t k) const;
+
+    // One result list per query row, spread over threads (0: all cores)
+    std::vector<std::vector<SearchResult>> search(EmbeddingMatrixView queries, std::size_t k,
+                                                  std::size_t threads = 0) const;
+
+    // Stored vectors (normalized for cosine)
+    EmbeddingMatrixView vectors() const { return store_.view(); }
+
+    // Index file; load() maps it and scans the vectors in place.
+    // Both throw std::runtime_error on I/O or format errors.
+    void save(const std::string& path) const;
+    static FlatIndex load(const std::string& path);
+
+private:
+    IndexMetric metric_;
+    VectorStore store_;
+};
+
+// HNSW graph construction and search parameters
+struct HnswOptions {
+    std::size_t m{16};                 // Links per node and layer (2*m on the bottom layer)
+    std::size_t ef_construction{200};  // Candidate list size while inserting
+    std::size_t ef_search{64};         // Candidate list size while searching (raised to k)
+    std::uint64_t seed{42};            // Layer assignment
+};
+
+// Approximate search over a Hierarchical Navigable Small World graph
+// (Malkov & Yashunin). Sub-linear query time for large corpora; recall is
+// traded against speed with ef_search. add() may build with several threads;
+// searches must not run concurrently with add().
+class HnswIndex {
+public:
+    explicit HnswIndex(std::size_t dimensions, IndexMetric metric = IndexMetric::Cosine, HnswOptions options = {});
+
+    std::size_t size() const { return store_.size(); }
+    std::size_t dimensions() const { return store_.dimensions(); }
+    IndexMetric metric() const { return metric_; }
+    const HnswOptions& options() const { return options_; }
+
+    void set_ef_search(std::size_t ef) { options_.ef_search = ef; }
+
+    // Append vectors; ids continue from size(). Batches are linked into the
+    // graph by threads workers (0: all cores).
+    void add(std::span<const float> vector);
+    void add(EmbeddingMatrixView vectors, std::size_t threads = 0);
+
+    // Approximate best k matches, highest score first
+    std::vector<SearchResult> search(std::span<const float> query, std::size_t k) const;
+    std::vector<std::vector<SearchResult>> search(EmbeddingMatrixView queries, std::size_t k,
+                                                  std::size_t threads = 0) const;
+
+    EmbeddingMatrixView vectors() const { return store_.view(); }
+
+    // Index file; load() maps the vectors in place and reads the graph
+    void save(const std::string& path) const;
+    static HnswIndex load(const std::string& path);
+
+private:
+    using Candidate = std::pair<float, std::uint32_t>;  // (distance, id)
+    struct Visited;
+
+    static constexpr std::size_t lock_stripes = 4096;
+
+    std::uint32_t* links(std::uint32_t node, std::size_t level);
+    const std::uint32_t* links(std::uint32_t node, std::size_t level) const;
+    float distance(const float* query, std::uint32_t node) const;
+
+    void grow(std::size_t count);
+    void insert(std::uint32_t node, Visited& visited);
+    std::uint32_t descend(const float* query, std::uint32_t entry, std::size_t from, std::size_t to,
+                          bool locked) const;
+    std::vector<Candidate> search_layer(const float* query, std::uint32_t entry, std::size_t ef,
+                                        std::size_t level, Visited& visited, bool locked) const;
+    std::vector<std::uint32_t> select_neighbors(const std::vector<Candidate>& candidates, std::size_t count) const;
+    void link(std::uint32_t node, std::uint32_t neighbor, std::size_t level);
+
+    IndexMetric metric_;
+    HnswOptions options_;
+    VectorStore store_;
+    double level_scale_;
+    std::mt19937_64 rng_;
+
+    std::vector<std::uint32_t> levels_;
+    std::vector<std::uint64_t> upper_offsets_;  // Node's first upper-layer block in upper_links_
+    std::vector<std::uint32_t> level0_;         // Per node: count, then 2*m slots
+    std::vector<std::uint32_t> upper_links_;    // Per node and layer >= 1: count, then m slots
+    std::uint32_t entry_point_{0};
+    std::int64_t max_level_{-1};
+
+    std::unique_ptr<std::mutex[]> node_locks_;
+    std::unique_ptr<std::mutex> graph_lock_;  // Entry point and top layer
+};
+
+} // namespace openai
+
+// ============================================================================
+// Implementation
+// ============================================================================
+
+namespace openai {
+
+namespace {
+
+// ----------------------------------------------------------------------------
+// Dot product kernels
+// ----------------------------------------------------------------------------
+
+float dot_scalar(const float* a, const float* b, std::size_t size) {
+    float sum[4] = {0.0f, 0.0f, 0.0f, 0.0f};
+    std::size_t i = 0;
+    for (; i + 4 <= size; i += 4) {
+        sum[0] += a[i] * b[i];
+        sum[1] += a[i + 1] * b[i + 1];
+        sum[2] += a[i + 2] * b[i + 2];
+        sum[3] += a[i + 3] * b[i + 3];
+    }
+    for (; i < size; ++i) {
+        sum[0] += a[i] * b[i];
+    }
+    return (sum[0] + sum[1]) + (sum[2] + sum[3]);
+}
+
+#if defined(OPENAI_X86_SIMD)
+
+#if defined(__GNUC__) || defined(__clang__)
+#define OPENAI_TARGET_AVX2_FMA __attribute__((target("avx2,fma")))
+#define OPENAI_TARGET_AVX512 __attribute__((target("avx512f")))
+#else
+#define OPENAI_TARGET_AVX2_FMA
+#define OPENAI_TARGET_AVX512
+#endif
+
+OPENAI_TARGET_AVX2_FMA
+float dot_avx2(const float* a, const float* b, std::size_t size) {
+    __m256 sum0 = _mm256_setzero_ps();
+    __m256 sum1 = _mm256_setzero_ps();
+    __m256 sum2 = _mm256_setzero_ps();
+    __m256 sum3 = _mm256_setzero_ps();
+    std::size_t i = 0;
+    for (; i + 32 <= size; i += 32) {
+        sum0 = _mm256_fmadd_ps(_mm256_loadu_ps(a + i), _mm256_loadu_ps(b + i), sum0);
+        sum1 = _mm256_fmadd_ps(_mm256_loadu_ps(a + i + 8), _mm256_loadu_ps(b + i + 8), sum1);
+        sum2 = _mm256_fmadd_ps(_mm256_loadu_ps(a + i + 16), _mm256_loadu_ps(b + i + 16), sum2);
+        sum3 = _mm256_fmadd_ps(_mm256_loadu_ps(a + i + 24), _mm256_loadu_ps(b + i + 24), sum3);
+    }
+    for (; i + 8 <= size; i += 8) {
+        sum0 = _mm256_fmadd_ps(_mm256_loadu_ps(a + i), _mm256_loadu_ps(b + i), sum0);
+    }
+    __m256 sum = _mm256_add_ps(_mm256_add_ps(sum0, sum1), _mm256_add_ps(sum2, sum3));
+    __m128 half = _mm_add_ps(_mm256_castps256_ps128(sum), _mm256_extractf128_ps(sum, 1));
+    half = _mm_add_ps(half, _mm_movehl_ps(half, half));
+    half = _mm_add_ss(half, _mm_shuffle_ps(half, half, 1));
+    float result = _mm_cvtss_f32(half);
+    for (; i < size; ++i) {
+        result += a[i] * b[i];
+    }
+    return result;
+}
+
+OPENAI_TARGET_AVX512
+float dot_avx512(const float* a, const float* b, std::size_t size) {
+    __m512 sum0 = _mm512_setzero_ps();
+    __m512 sum1 = _mm512_setzero_ps();
+    std::size_t i = 0;
+    for (; i + 32 <= size; i += 32) {
+        sum0 = _mm512_fmadd_ps(_mm512_loadu_ps(a + i), _mm512_loadu_ps(b + i), sum0);
+        sum1 = _mm512_fmadd_ps(_mm512_loadu_ps(a + i + 16), _mm512_loadu_ps(b + i + 16), sum1);
+    }
+    if (i < size) {
+        // Masked loads read nothing past the end
+        auto remaining = size - i;
+        auto mask = static_cast<__mmask16>(remaining >= 16 ? 0xFFFF : (1u << remaining) - 1);
+        sum0 = _mm512_fmadd_ps(_mm512_maskz_loadu_ps(mask, a + i), _mm512_maskz_loadu_ps(mask, b + i), sum0);
+        if (remaining > 16) {
+            mask = static_cast<__mmask16>((1u << (remaining - 16)) - 1);
+            sum1 = _mm512_fmadd_ps(_mm512_maskz_loadu_ps(mask, a + i + 16),
+                                   _mm512_maskz_loadu_ps(mask, b + i + 16), sum1);
+        }
+    }
+    return _mm512_reduce_add_ps(_mm512_add_ps(sum0, sum1));
+}
+
+#endif // OPENAI_X86_SIMD
+
+using DotKernel = float (*)(const float*, const float*, std::size_t);
+
+// Picked once from the running CPU
+DotKernel dot_kernel() {
+    static const DotKernel kernel = [] {
+#if defined(OPENAI_X86_SIMD)
+        const auto& features = cpu_features();
+        if (features.avx512f) {
+            return DotKernel{dot_avx512};
+        }
+        if (features.avx2 && features.fma) {
+            return DotKernel{dot_avx2};
+        }
+#endif
+        return DotKernel{dot_scalar};
+    }();
+    return kernel;
+}
+
+// Keeps the k best results seen so far
+class TopK {
+public:
+    explicit TopK(std::size_t k) : k_(k) { heap_.reserve(k + 1); }
+
+    void push(std::size_t id, float score) {
+        if (heap_.size() < k_) {
+            heap_.push_back({id, score});
+            std::push_heap(heap_.begin(), heap_.end(), worse);
+        } else if (k_ > 0 && score > heap_.front().score) {
+            std::pop_heap(heap_.begin(), heap_.end(), worse);
+            heap_.back() = {id, score};
+            std::push_heap(heap_.begin(), heap_.end(), worse);
+        }
+    }
+
+    std::vector<SearchResult> take() {
+        std::sort_heap(heap_.begin(), heap_.end(), worse);
+        return std::move(heap_);
+    }
+
+private:
+    // Heap ordered so the front is the weakest kept result
+    static bool worse(const SearchResult& a, const SearchResult& b) { return a.score > b.score; }
+
+    std::size_t k_;
+    std::vector<SearchResult> heap_;
+};
+
+std::size_t worker_count(std::size_t threads, std::size_t jobs) {
+    if (threads == 0) {
+        threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+    return std::max<std::size_t>(1, std::min(threads, jobs));
+}
+
+// Run body(i) for i in [first, last) on worker threads pulling from a shared
+// counter. The first exception thrown by body stops the remaining work and is
+// rethrown once every worker has finished.
+template <typename Body>
+void parallel_for(std::size_t first, std::size_t last, std::size_t threads, Body&& body) {
+    threads = worker_count(threads, last - first);
+    if (threads == 1) {
+        for (auto i = first; i < last; ++i) {
+            body(i);
+        }
+        return;
+    }
+    std::atomic<std::size_t> next{first};
+    std::mutex error_mutex;
+    std::exception_ptr error;
+    {
+        std::vector<std::jthread> workers;
+        workers.reserve(threads);
+        for (std::size_t t = 0; t < threads; ++t) {
+            workers.emplace_back([&] {
+                try {
+                    for (auto i = next.fetch_add(1); i < last; i = next.fetch_add(1)) {
+                        body(i);
+                    }
+                } catch (...) {
+                    next = last;
+                    std::lock_guard lock(error_mutex);
+                    if (!error) {
+                        error = std::current_exception();
+                    }
+                }
+            });
+        }
+    }
+    if (error) {
+        std::rethrow_exception(error);
+    }
+}
+
+// ----------------------------------------------------------------------------
+// Index file
+//
+//   header   16 x u64 (IndexHeader fields below), native byte order
+//   vectors  count x stride float32 rows at vectors_offset (64-byte aligned)
+//   graph    HNSW only, at graph_offset: levels, upper offsets, bottom
+//            layer links, upper link count and links
+// ----------------------------------------------------------------------------
+
+constexpr std::uint64_t index_magic = 0x31584449'4941504FULL;  // "OPAIIDX1"
+constexpr std::uint64_t index_version = 1;
+
+enum class IndexKind : std::uint64_t {
+    Flat = 0,
+    Hnsw = 1
+};
+
+struct IndexHeader {
+    std::uint64_t magic{index_magic};
+    std::uint64_t version{index_version};
+    std::uint64_t kind{0};
+    std::uint64_t metric{0};
+    std::uint64_t dimensions{0};
+    std::uint64_t stride{0};
+    std::uint64_t count{0};
+    std::uint64_t vectors_offset{0};
+    std::uint64_t graph_offset{0};
+    std::uint64_t m{0};
+    std::uint64_t ef_construction{0};
+    std::uint64_t ef_search{0};
+    std::uint64_t entry_point{0};
+    std::uint64_t max_level{0};
+    std::uint64_t seed{0};
+    std::uint64_t reserved{0};
+};
+static_assert(sizeof(IndexHeader) == 128);
+
+template <typename T>
+void write_array(std::ofstream& out, const T* data, std::size_t count) {
+    out.write(reinterpret_cast<const char*>(data), static_cast<std::streamsize>(count * sizeof(T)));
+}
+
+// Header, then the rows padded to the stride
+std::ofstream write_index(const std::string& path, IndexHeader header, EmbeddingMatrixView vectors) {
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    if (!out) {
+        throw std::runtime_error("Failed to create index file: " + path);
+    }
+    header.dimensions = vectors.dimensions();
+    header.stride = vectors.stride();
+    header.count = vectors.rows();
+    header.vectors_offset = sizeof(IndexHeader);
+    header.graph_offset = header.vectors_offset + header.count * header.stride * sizeof(float);
+    write_array(out, &header, 1);
+    if (!vectors.empty()) {
+        write_array(out, vectors.data(), vectors.rows() * vectors.stride());
+    }
+    return out;
+}
+
+// Map an index file and check its header against the expected kind
+std::pair<std::shared_ptr<const MappedFile>, IndexHeader> open_index(const std::string& path, IndexKind kind) {
+    auto mapping = std::make_shared<const MappedFile>(path);
+    IndexHeader header;
+    if (mapping->size() < sizeof(IndexHeader)) {
+        throw std::runtime_error("Not an index file: " + path);
+    }
+    std::memcpy(&header, mapping->data(), sizeof(IndexHeader));
+    if (header.magic != index_magic || header.version != index_version) {
+        throw std::runtime_error("Not an index file (or different byte order): " + path);
+    }
+    if (header.kind != static_cast<std::uint64_t>(kind)) {
+        throw std::runtime_error("Index file holds a different index type: " + path);
+    }
+    if (header.metric > static_cast<std::uint64_t>(IndexMetric::Dot) || header.dimensions == 0 ||
+        header.count > std::numeric_limits<std::uint32_t>::max()) {
+        throw std::runtime_error("Corrupt index file: " + path);
+    }
+    if (header.vectors_offset % EmbeddingMatrix::alignment != 0 ||
+        header.graph_offset != header.vectors_offset + header.count * header.stride * sizeof(float) ||
+        header.graph_offset > mapping->size() || header.stride < header.dimensions) {
+        throw std::runtime_error("Corrupt index file: " + path);
+    }
+    return {std::move(mapping), header};
+}
+
+// Sequential reader over the graph section
+class SectionReader {
+public:
+    SectionReader(const MappedFile& file, std::size_t offset, const std::string& path)
+        : file_(file), offset_(offset), path_(path) {}
+
+    template <typename T>
+    void read(std::vector<T>& out, std::size_t count) {
+        auto bytes = count * sizeof(T);
+        if (offset_ + bytes > file_.size()) {
+            throw std::runtime_error("Truncated index file: " + path_);
+        }
+        out.resize(count);
+        if (bytes > 0) {
+            std::memcpy(out.data(), file_.data() + offset_, bytes);
+        }
+        offset_ += bytes;
+    }
+
+private:
+    const MappedFile& file_;
+    std::size_t offset_;
+    const std::string& path_;
+};
+
+} // namespace
+
+float dot_product(const float* a, const float* b, std::size_t size) {
+    return dot_kernel()(a, b, size);
+}
+
+// ----------------------------------------------------------------------------
+// VectorStore
+// ----------------------------------------------------------------------------
+
+VectorStore::VectorStore(std::size_t dimensions, bool normalize)
+    : dimensions_(dimensions)
+    , normalize_(normalize)
+    , owned_(0, dimensions) {
+    stride_ = owned_.stride();
+}
+
+VectorStore::VectorStore(const VectorStore& other)
+    : dimensions_(other.dimensions_)
+    , stride_(other.stride_)
+    , normalize_(other.normalize_)
+    , owned_(other.owned_)
+    , mapping_(other.mapping_)
+    , data_(mapping_ ? other.data_ : owned_.data())
+    , size_(other.size_) {}
+
+VectorStore::VectorStore(VectorStore&& other) noexcept
+    : dimensions_(other.dimensions_)
+    , stride_(other.stride_)
+    , normalize_(other.normalize_)
+    , owned_(std::move(other.owned_))
+    , mapping_(std::move(other.mapping_))
+    , data_(mapping_ ? other.data_ : owned_.data())
+    , size_(other.size_) {
+    other.data_ = nullptr;
+    other.size_ = 0;
+}
+
+VectorStore& VectorStore::operator=(const VectorStore& other) {
+    if (this != &other) {
+        *this = VectorStore(other);
+    }
+    return *this;
+}
+
+VectorStore& VectorStore::operator=(VectorStore&& other) noexcept {
+    if (this != &other) {
+        dimensions_ = other.dimensions_;
+        stride_ = other.stride_;
+        normalize_ = other.normalize_;
+        owned_ = std::move(other.owned_);
+        mapping_ = std::move(other.mapping_);
+        data_ = mapping_ ? other.data_ : owned_.data();
+        size_ = other.size_;
+        other.data_ = nullptr;
+        other.size_ = 0;
+    }
+    return *this;
+}
+
+void VectorStore::append(EmbeddingMatrixView rows) {
+    if (rows.empty()) {
+        return;
+    }
+    if (rows.dimensions() != dimensions_) {
+        throw std::invalid_argument(fmt::format("Expected {} dimensions, got {}", dimensions_, rows.dimensions()));
+    }
+    if (mapping_) {
+        // First write to a mapped index: copy the vectors out
+        EmbeddingMatrix owned(size_, dimensions_);
+        if (size_ > 0) {
+            std::memcpy(owned.data(), data_, size_ * stride_ * sizeof(float));
+        }
+        owned_ = std::move(owned);
+        mapping_.reset();
+    }
+
+    auto first = size_;
+    owned_.resize(size_ + rows.rows());
+    for (std::size_t i = 0; i < rows.rows(); ++i) {
+        std::ranges::copy(rows[i], owned_.row(first + i).begin());
+    }
+    data_ = owned_.data();
+    size_ = owned_.rows();
+    normalize_rows(first);
+}
+
+void VectorStore::normalize_rows(std::size_t first) {
+    if (!normalize_) {
+        return;
+    }
+    for (auto i = first; i < size_; ++i) {
+        auto values = owned_.row(i);
+        float norm = std::sqrt(dot_product(values.data(), values.data(), stride_));
+        if (norm > 0.0f) {
+            for (float& value : values) {
+                value /= norm;
+            }
+        }
+    }
+}
+
+EmbeddingMatrix VectorStore::prepare(std::span<const float> query) const {
+    if (query.size() != dimensions_) {
+        throw std::invalid_argument(fmt::format("Expected {} dimensions, got {}", dimensions_, query.size()));
+    }
+    EmbeddingMatrix padded(1, dimensions_);
+    std::ranges::copy(query, padded.row(0).begin());
+    if (normalize_) {
+        padded.normalize();
+    }
+    return padded;
+}
+
+void VectorStore::map(std::shared_ptr<const MappedFile> mapping, std::size_t offset, std::size_t count) {
+    owned_ = EmbeddingMatrix(0, dimensions_);
+    data_ = reinterpret_cast<const float*>(mapping->data() + offset);
+    size_ = count;
+    mapping_ = std::move(mapping);
+}
+
+// ----------------------------------------------------------------------------
+// FlatIndex
+// ----------------------------------------------------------------------------
+
+FlatIndex::FlatIndex(std::size_t dimensions, IndexMetric metric)
+    : metric_(metric), store_(dimensions, metric == IndexMetric::Cosine) {}
+
+void FlatIndex::add(std::span<const float> vector) {
+    store_.append(EmbeddingMatrixView(vector.data(), 1, vector.size()));
+}
+
+void FlatIndex::add(EmbeddingMatrixView vectors) {
+    store_.append(vectors);
+}
+
+std::vector<SearchResult> FlatIndex::search(std::span<const float> query, std::size_t k) const {
+    auto padded = store_.prepare(query);
+    const float* q = padded.data();
+    const auto stride = store_.stride();
+    const auto kernel = dot_kernel();
+
+    // Padding is zero in both, so whole strides are scored without a tail loop
+    TopK top(std::min(k, size()));
+    for (std::size_t i = 0; i < size(); ++i) {
+        top.push(i, kernel(store_.row(i), q, stride));
+    }
+    return top.take();
+}
+
+std::vector<std::vector<SearchResult>> FlatIndex::search(EmbeddingMatrixView queries, std::size_t k,
+                                                         std::size_t threads) const {
+    std::vector<std::vector<SearchResult>> results(queries.rows());
+    parallel_for(0, queries.rows(), threads, [&](std::size_t i) { results[i] = search(queries[i], k); });
+    return results;
+}
+
+void FlatIndex::save(const std::string& path) const {
+    IndexHeader header;
+    header.kind = static_cast<std::uint64_t>(IndexKind::Flat);
+    header.metric = static_cast<std::uint64_t>(metric_);
+    auto out = write_index(path, header, store_.view());
+    if (!out) {
+        throw std::runtime_error("Failed to write index file: " + path);
+    }
+}
+
+FlatIndex FlatIndex::load(const std::string& path) {
+    auto [mapping, header] = open_index(path, IndexKind::Flat);
+    FlatIndex index(header.dimensions, static_cast<IndexMetric>(header.metric));
+    if (index.store_.stride() != header.stride) {
+        throw std::runtime_error("Corrupt index file: " + path);
+    }
+    index.store_.map(std::move(mapping), header.vectors_offset, header.count);
+    return index;
+}
+
+// ----------------------------------------------------------------------------
+// HnswIndex
+// ----------------------------------------------------------------------------
+
+// Generation-tagged visited marks, reused across searches on a thread
+struct HnswIndex::Visited {
+    std::vector<std::uint32_t> marks;
+    std::uint32_t generation{0};
+
+    void reset(std::size_t size) {
+        if (marks.size() < size) {
+            marks.resize(size, 0);
+        }
+        if (++generation == 0) {
+            std::ranges::fill(marks, 0);
+            generation = 1;
+        }
+    }
+
+    // True the first time a node is seen since reset()
+    bool visit(std::uint32_t node) {
+        if (marks[node] == generation) {
+            return false;
+        }
+        marks[node] = generation;
+        return true;
+    }
+};
+
+HnswIndex::HnswIndex(std::size_t dimensions, IndexMetric metric, HnswOptions options)
+    : metric_(metric)
+    , options_(options)
+    , store_(dimensions, metric == IndexMetric::Cosine)
+    , level_scale_(1.0 / std::log(static_cast<double>(std::max<std::size_t>(options.m, 2))))
+    , rng_(options.seed)
+    , node_locks_(std::make_unique<std::mutex[]>(lock_stripes))
+    , graph_lock_(std::make_unique<std::mutex>()) {
+    options_.m = std::max<std::size_t>(options_.m, 2);
+}
+
+std::uint32_t* HnswIndex::links(std::uint32_t node, std::size_t level) {
+    if (level == 0) {
+        return level0_.data() + node * (1 + 2 * options_.m);
+    }
+    return upper_links_.data() + upper_offsets_[node] + (level - 1) * (1 + options_.m);
+}
+
+const std::uint32_t* HnswIndex::links(std::uint32_t node, std::size_t level) const {
+    return const_cast<HnswIndex*>(this)->links(node, level);
+}
+
+float HnswIndex::distance(const float* query, std::uint32_t node) const {
+    return -dot_kernel()(query, store_.row(node), store_.stride());
+}
+
+// Reserve graph storage and draw layers for count new nodes
+void HnswIndex::grow(std::size_t count) {
+    std::exponential_distribution<double> layer(1.0);
+    for (std::size_t i = 0; i < count; ++i) {
+        auto level = static_cast<std::uint32_t>(std::min(layer(rng_) * level_scale_, 30.0));
+        levels_.push_back(level);
+        upper_offsets_.push_back(upper_links_.size());
+        upper_links_.resize(upper_links_.size() + level * (1 + options_.m), 0);
+    }
+    level0_.resize(levels_.size() * (1 + 2 * options_.m), 0);
+}
+
+void HnswIndex::add(std::span<const float> vector) {
+    add(EmbeddingMatrixView(vector.data(), 1, vector.size()), 1);
+}
+
+void HnswIndex::add(EmbeddingMatrixView vectors, std::size_t threads) {
+    if (vectors.empty()) {
+        return;
+    }
+    auto first = size();
+    store_.append(vectors);
+    grow(vectors.rows());
+
+    // Each worker keeps its own visited marks
+    parallel_for(first, size(), threads, [&](std::size_t node) {
+        thread_local Visited visited;
+        insert(static_cast<std::uint32_t>(node), visited);
+    });
+}
+
+std::uint32_t HnswIndex::descend(const float* query, std::uint32_t entry, std::size_t from, std::size_t to,
+                                 bool locked) const {
+    // Greedy walk from layer from down to layer to + 1
+    auto current = entry;
+    auto best = distance(query, current);
+    std::vector<std::uint32_t> neighbors;
+    for (auto level = from; level > to; --level) {
+        bool improved = true;
+        while (improved) {
+            improved = false;
+            {
+                std::unique_lock lock(node_locks_[current % lock_stripes], std::defer_lock);
+                if (locked) lock.lock();
+                const auto* list = links(current, level);
+                neighbors.assign(list + 1, list + 1 + list[0]);
+            }
+            for (auto neighbor : neighbors) {
+                auto d = distance(query, neighbor);
+                if (d < best) {
+                    best = d;
+                    current = neighbor;
+                    improved = true;
+                }
+            }
+        }
+    }
+    return current;
+}
+
+std::vector<HnswIndex::Candidate> HnswIndex::search_layer(const float* query, std::uint32_t entry, std::size_t ef,
+                                                          std::size_t level, Visited& visited, bool locked) const {
+    visited.reset(size());
+    visited.visit(entry);
+
+    // candidates: nearest first; results: farthest first, at most ef
+    std::priority_queue<Candidate, std::vector<Candidate>, std::greater<>> candidates;
+    std::priority_queue<Candidate> results;
+    auto d = distance(query, entry);
+    candidates.push({d, entry});
+    results.push({d, entry});
+
+    std::vector<std::uint32_t> neighbors;
+    while (!candidates.empty()) {
+        auto [current_distance, current] = candidates.top();
+        if (current_distance > results.top().first && results.size() >= ef) {
+            break;
+        }
+        candidates.pop();
+
+        {
+            std::unique_lock lock(node_locks_[current % lock_stripes], std::defer_lock);
+            if (locked) lock.lock();
+            const auto* list = links(current, level);
+            neighbors.assign(list + 1, list + 1 + list[0]);
+        }
+        for (auto neighbor : neighbors) {
+            if (!visited.visit(neighbor)) {
+                continue;
+            }
+            auto nd = distance(query, neighbor);
+            if (results.size() < ef || nd < results.top().first) {
+                candidates.push({nd, neighbor});
+                results.push({nd, neighbor});
+                if (results.size() > ef) {
+                    results.pop();
+                }
+            }
+        }
+    }
+
+    std::vector<Candidate> nearest(results.size());
+    for (auto i = nearest.size(); i > 0; --i) {
+        nearest[i - 1] = results.top();
+        results.pop();
+    }
+    return nearest;
+}
+
+// Diversity heuristic: keep a candidate only if it is closer to the query
+// than to every neighbor already kept
+std::vector<std::uint32_t> HnswIndex::select_neighbors(const std::vector<Candidate>& candidates,
+                                                       std::size_t count) const {
+    std::vector<std::uint32_t> selected;
+    selected.reserve(count);
+    for (const auto& [d, candidate] : candidates) {
+        if (selected.size() >= count) {
+            break;
+        }
+        bool diverse = true;
+        for (auto kept : selected) {
+            if (distance(store_.row(candidate), kept) < d) {
+                diverse = false;
+                break;
+            }
+        }
+        if (diverse) {
+            selected.push_back(candidate);
+        }
+    }
+    return selected;
+}
+
+// Add a back link from neighbor to node, pruning neighbor's list when full
+void HnswIndex::link(std::uint32_t node, std::uint32_t neighbor, std::size_t level) {
+    const auto capacity = level == 0 ? 2 * options_.m : options_.m;
+    std::lock_guard lock(node_locks_[neighbor % lock_stripes]);
+    auto* list = links(neighbor, level);
+    if (list[0] < capacity) {
+        list[1 + list[0]] = node;
+        ++list[0];
+        return;
+    }
+
+    std::vector<Candidate> candidates;
+    candidates.reserve(capacity + 1);
+    const float* base = store_.row(neighbor);
+    for (std::uint32_t i = 0; i < list[0]; ++i) {
+        candidates.push_back({distance(base, list[1 + i]), list[1 + i]});
+    }
+    candidates.push_back({distance(base, node), node});
+    std::ranges::sort(candidates);
+
+    auto kept = select_neighbors(candidates, capacity);
+    list[0] = static_cast<std::uint32_t>(kept.size());
+    std::ranges::copy(kept, list + 1);
+}
+
+void HnswIndex::insert(std::uint32_t node, Visited& visited) {
+    const std::size_t level = levels_[node];
+
+    std::unique_lock graph(*graph_lock_);
+    if (max_level_ < 0) {
+        entry_point_ = node;
+        max_level_ = static_cast<std::int64_t>(level);
+        return;
+    }
+    const auto top = static_cast<std::size_t>(max_level_);
+    auto entry = entry_point_;
+    if (level <= top) {
+        graph.unlock();  // Only a new top layer needs the graph lock held
+    }
+
+    const float* query = store_.row(node);
+    if (top > level) {
+        entry = descend(query, entry, top, level, true);
+    }
+    for (auto current = std::min(level, top) + 1; current-- > 0;) {
+        auto nearest = search_layer(query, entry, options_.ef_construction, current, visited, true);
+        std::erase_if(nearest, [&](const Candidate& c) { return c.second == node; });
+        if (nearest.empty()) {
+            continue;
+        }
+        auto selected = select_neighbors(nearest, options_.m);
+        {
+            std::lock_guard lock(node_locks_[node % lock_stripes]);
+            auto* list = links(node, current);
+            list[0] = static_cast<std::uint32_t>(selected.size());
+            std::ranges::copy(selected, list + 1);
+        }
+        for (auto neighbor : selected) {
+            link(node, neighbor, current);
+        }
+        entry = nearest.front().second;
+    }
+
+    if (level > top) {
+        entry_point_ = node;
+        max_level_ = static_cast<std::int64_t>(level);
+    }
+}
+
+std::vector<SearchResult> HnswIndex::search(std::span<const float> query, std::size_t k) const {
+    auto padded = store_.prepare(query);
+    if (max_level_ < 0 || k == 0) {
+        return {};
+    }
+    thread_local Visited visited;
+    const float* q = padded.data();
+    auto entry = descend(q, entry_point_, static_cast<std::size_t>(max_level_), 0, false);
+    auto nearest = search_layer(q, entry, std::max(options_.ef_search, k), 0, visited, false);
+
+    std::vector<SearchResult> results;
+    results.reserve(std::min(k, nearest.size()));
+    for (std::size_t i = 0; i < nearest.size() && i < k; ++i) {
+        results.push_back({nearest[i].second, -nearest[i].first});
+    }
+    return results;
+}
+
+std::vector<std::vector<SearchResult>> HnswIndex::search(EmbeddingMatrixView queries, std::size_t k,
+                                                         std::size_t threads) const {
+    std::vector<std::vector<SearchResult>> results(queries.rows());
+    parallel_for(0, queries.rows(), threads, [&](std::size_t i) { results[i] = search(queries[i], k); });
+    return results;
+}
+
+void HnswIndex::save(const std::string& path) const {
+    IndexHeader header;
+    header.kind = static_cast<std::uint64_t>(IndexKind::Hnsw);
+    header.metric = static_cast<std::uint64_t>(metric_);
+    header.m = options_.m;
+    header.ef_construction = options_.ef_construction;
+    header.ef_search = options_.ef_search;
+    header.entry_point = entry_point_;
+    header.max_level = static_cast<std::uint64_t>(max_level_ + 1);  // 0: empty
+    header.seed = options_.seed;
+
+    auto out = write_index(path, header, store_.view());
+    std::uint64_t upper_count = upper_links_.size();
+    write_array(out, levels_.data(), levels_.size());
+    write_array(out, upper_offsets_.data(), upper_offsets_.size());
+    write_array(out, level0_.data(), level0_.size());
+    write_array(out, &upper_count, 1);
+    write_array(out, upper_links_.data(), upper_links_.size());
+    if (!out) {
+        throw std::runtime_error("Failed to write index file: " + path);
+    }
+}
+
+HnswIndex HnswIndex::load(const std::string& path) {
+    auto [mapping, header] = open_index(path, IndexKind::Hnsw);
+
+    // Link lists are sized from m; reject values that would overflow them
+    if (header.m < 2 || header.m > 4096) {
+        throw std::runtime_error("Corrupt index file: " + path);
+    }
+
+    HnswOptions options;
+    options.m = header.m;
+    options.ef_construction = header.ef_construction;
+    options.ef_search = header.ef_search;
+    options.seed = header.seed;
+    HnswIndex index(header.dimensions, static_cast<IndexMetric>(header.metric), options);
+    if (index.store_.stride() != header.stride || index.options_.m != header.m) {
+        throw std::runtime_error("Corrupt index file: " + path);
+    }
+
+    // The graph is small next to the vectors and is read into memory
+    SectionReader reader(*mapping, header.graph_offset, path);
+    std::vector<std::uint64_t> upper_count;
+    reader.read(index.levels_, header.count);
+    reader.read(index.upper_offsets_, header.count);
+    reader.read(index.level0_, header.count * (1 + 2 * header.m));
+    reader.read(upper_count, 1);
+    reader.read(index.upper_links_, upper_count[0]);
+    index.entry_point_ = static_cast<std::uint32_t>(header.entry_point);
+    index.max_level_ = static_cast<std::int64_t>(header.max_level) - 1;
+
+    // Every offset, count and id is used as an index while searching
+    const auto count = header.count;
+    const auto m = header.m;
+    auto check = [&](bool valid) {
+        if (!valid) {
+            throw std::runtime_error("Corrupt index file: " + path);
+        }
+    };
+    auto check_list = [&](const std::uint32_t* list, std::size_t capacity) {
+        check(list[0] <= capacity);
+        for (std::uint32_t i = 0; i < list[0]; ++i) {
+            check(list[1 + i] < count);
+        }
+    };
+    check(count == 0 ? header.max_level == 0
+                     : header.max_level >= 1 && header.max_level <= 31 && header.entry_point < count &&
+                       index.levels_[header.entry_point] == header.max_level - 1);
+    for (std::size_t node = 0; node < count; ++node) {
+        const auto level = index.levels_[node];
+        const auto offset = index.upper_offsets_[node];
+        check(level + 1 <= header.max_level);
+        check(offset <= index.upper_links_.size() && level * (1 + m) <= index.upper_links_.size() - offset);
+        check_list(index.level0_.data() + node * (1 + 2 * m), 2 * m);
+        for (std::size_t layer = 1; layer <= level; ++layer) {
+            check_list(index.upper_links_.data() + offset + (layer - 1) * (1 + m), m);
+        }
+    }
+
+    // Later additions draw layers from a stream distinct from the saved nodes
+    index.rng_.seed(header.seed + header.count);
+    index.store_.map(std::move(mapping), header.vectors_offset, header.count);
+    return index;
+}
+
+} // namespace openai
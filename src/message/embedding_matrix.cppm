@@ -0,0 +1,581 @@
+// Embedding Matrix Module
+// Contiguous, optionally quantized storage for batches of embeddings
+
+export module openai.types.embedding_matrix;
+
+import std;
+import openai.types.common;
+import openai.types.embedding;
+import openai.types.json;
+
+export namespace openai {
+
+// ============================================================================
+// EMBEDDING MATRIX - Row-major N x D storage
+// ============================================================================
+
+// Element type of a quantized matrix
+enum class EmbeddingPrecision {
+    Float32,
+    Float16,   // IEEE 754 half, rounded to nearest even
+    BFloat16,  // Upper 16 bits of float32, rounded to nearest even
+    Int8       // Symmetric per-row scale: value ~= q * scale
+};
+
+std::string to_string(EmbeddingPrecision precision);
+
+// Bytes per element
+std::size_t precision_size(EmbeddingPrecision precision);
+
+// Scalar element conversions
+std::uint16_t float_to_half(float value);
+float half_to_float(std::uint16_t bits);
+std::uint16_t float_to_bfloat16(float value);
+float bfloat16_to_float(std::uint16_t bits);
+
+// Non-owning view of row-major float32 rows. Consecutive rows are stride
+// floats apart (stride >= dimensions). The viewed storage must outlive it.
+class EmbeddingMatrixView {
+public:
+    EmbeddingMatrixView() = default;
+    EmbeddingMatrixView(const float* data, std::size_t rows, std::size_t dimensions, std::size_t stride)
+        : data_(data), rows_(rows), dimensions_(dimensions), stride_(stride) {}
+    EmbeddingMatrixView(const float* data, std::size_t rows, std::size_t dimensions)
+        : EmbeddingMatrixView(data, rows, dimensions, dimensions) {}
+
+    std::size_t rows() const { return rows_; }
+    std::size_t dimensions() const { return dimensions_; }
+    std::size_t stride() const { return stride_; }
+    const float* data() const { return data_; }
+    bool empty() const { return rows_ == 0; }
+
+    std::span<const float> operator[](std::size_t row) const {
+        return {data_ + row * stride_, dimensions_};
+    }
+
+    // Rows [first, first + count)
+    EmbeddingMatrixView slice(std::size_t first, std::size_t count) const {
+        return {data_ + first * stride_, count, dimensions_, stride_};
+    }
+
+private:
+    const float* data_{nullptr};
+    std::size_t rows_{0};
+    std::size_t dimensions_{0};
+    std::size_t stride_{0};
+};
+
+// Owning N x D float32 matrix in a single 64-byte aligned block. The row
+// stride is rounded up to 16 floats so every row starts on a cache line and
+// can be loaded with aligned SIMD; padding floats are zero.
+class EmbeddingMatrix {
+public:
+    static constexpr std::size_t alignment = 64;
+
+    EmbeddingMatrix() = default;
+    EmbeddingMatrix(std::size_t rows, std::size_t dimensions);
+
+    EmbeddingMatrix(const EmbeddingMatrix& other);
+    EmbeddingMatrix& operator=(const EmbeddingMatrix& other);
+    EmbeddingMatrix(EmbeddingMatrix&& other) noexcept;
+    EmbeddingMatrix& operator=(EmbeddingMatrix&& other) noexcept;
+
+    // Copy the embeddings of a response, row i holding input i.
+    // Throws std::invalid_argument if the vectors differ in length.
+    static EmbeddingMatrix from_response(const EmbeddingResponse& response);
+
+    std::size_t rows() const { return rows_; }
+    std::size_t dimensions() const { return dimensions_; }
+    std::size_t stride() const { return stride_; }
+    bool empty() const { return rows_ == 0; }
+
+    float* data() { return data_.get(); }
+    const float* data() const { return data_.get(); }
+
+    std::span<float> row(std::size_t index) { return {data_.get() + index * stride_, dimensions_}; }
+    std::span<const float> operator[](std::size_t index) const {
+        return {data_.get() + index * stride_, dimensions_};
+    }
+
+    EmbeddingMatrixView view() const { return {data_.get(), rows_, dimensions_, stride_}; }
+    operator EmbeddingMatrixView() const { return view(); }
+
+    // Change the row count, keeping existing rows and zero-filling new ones.
+    // Capacity grows geometrically so appending row by row is amortized O(1).
+    void resize(std::size_t rows);
+
+    // Scale every row to unit L2 length, so dot product equals cosine similarity
+    void normalize();
+
+    // Heap bytes held, including padding and spare capacity
+    std::size_t bytes() const { return capacity_ * stride_ * sizeof(float); }
+
+private:
+    struct AlignedDelete {
+        void operator()(float* data) const { ::operator delete[](data, std::align_val_t{alignment}); }
+    };
+
+    void reallocate(std::size_t capacity);
+
+    std::unique_ptr<float[], AlignedDelete> data_;
+    std::size_t rows_{0};
+    std::size_t dimensions_{0};
+    std::size_t stride_{0};
+    std::size_t capacity_{0};  // Rows allocated
+};
+
+// Compact copy of a float32 matrix at reduced precision. Rows are packed
+// (no padding); Int8 rows carry a scale, the other formats a scale of 1.
+class QuantizedEmbeddingMatrix {
+public:
+    QuantizedEmbeddingMatrix() = default;
+    QuantizedEmbeddingMatrix(EmbeddingMatrixView source, EmbeddingPrecision precision);
+
+    EmbeddingPrecision precision() const { return precision_; }
+    std::size_t rows() const { return rows_; }
+    std::size_t dimensions() const { return dimensions_; }
+    bool empty() const { return rows_ == 0; }
+
+    float scale(std::size_t row) const { return scales_[row]; }
+
+    // Encoded elements of a row (dimensions * precision_size bytes)
+    std::span<const std::byte> row_data(std::size_t row) const;
+
+    // Decode a row into out (out.size() == dimensions)
+    void dequantize_row(std::size_t row, std::span<float> out) const;
+
+    // Dot product of a row with a float32 query, decoding on the fly
+    float dot(std::size_t row, std::span<const float> query) const;
+
+    EmbeddingMatrix to_float32() const;
+
+    // Heap bytes held by elements and scales
+    std::size_t bytes() const { return data_.size() + scales_.size() * sizeof(float); }
+
+private:
+    EmbeddingPrecision precision_{EmbeddingPrecision::Float32};
+    std::size_t rows_{0};
+    std::size_t dimensions_{0};
+    std::vector<std::byte> data_;
+    std::vector<float> scales_;
+};
+
+// Embedding response decoded straight into a matrix, without a vector
+// and object string per row
+struct EmbeddingMatrixResponse {
+    std::string model;
+    EmbeddingUsage usage;
+    EmbeddingMatrix matrix;  // Row i is the embedding of input i
+};
+
+// JSON decoding (float or base64 embeddings)
+void read_json(JsonReader& reader, EmbeddingMatrixResponse& out);
+
+} // namespace openai
+
+// ============================================================================
+// Implementation
+// ============================================================================
+
+namespace openai {
+
+namespace {
+
+constexpr std::size_t padded_stride(std::size_t dimensions) {
+    constexpr std::size_t lane = EmbeddingMatrix::alignment / sizeof(float);
+    return (dimensions + lane - 1) / lane * lane;
+}
+
+template <typename T>
+T load(const std::byte* data, std::size_t index) {
+    T value;
+    std::memcpy(&value, data + index * sizeof(T), sizeof(T));
+    return value;
+}
+
+template <typename T>
+void store(std::byte* data, std::size_t index, T value) {
+    std::memcpy(data + index * sizeof(T), &value, sizeof(T));
+}
+
+} // namespace
+
+std::string to_string(EmbeddingPrecision precision) {
+    switch (precision) {
+        case EmbeddingPrecision::Float32: return "float32";
+        case EmbeddingPrecision::Float16: return "float16";
+        case EmbeddingPrecision::BFloat16: return "bfloat16";
+        case EmbeddingPrecision::Int8: return "int8";
+        default: return "float32";
+    }
+}
+
+std::size_t precision_size(EmbeddingPrecision precision) {
+    switch (precision) {
+        case EmbeddingPrecision::Float32: return 4;
+        case EmbeddingPrecision::Float16:
+        case EmbeddingPrecision::BFloat16: return 2;
+        case EmbeddingPrecision::Int8: return 1;
+        default: return 4;
+    }
+}
+
+std::uint16_t float_to_half(float value) {
+    auto bits = std::bit_cast<std::uint32_t>(value);
+    auto sign = static_cast<std::uint16_t>((bits >> 16) & 0x8000);
+    auto exponent = static_cast<int>((bits >> 23) & 0xFF);
+    std::uint32_t mantissa = bits & 0x7FFFFF;
+
+    if (exponent == 0xFF) {
+        return sign | 0x7C00 | (mantissa != 0 ? 0x200 : 0);  // Inf, or quiet NaN
+    }
+    int half_exponent = exponent - 127 + 15;
+    if (half_exponent >= 0x1F) {
+        return sign | 0x7C00;  // Overflow
+    }
+
+    std::uint32_t half;
+    std::uint32_t remainder;
+    std::uint32_t halfway;
+    if (half_exponent <= 0) {
+        // Subnormal half: shift the full significand into the 2^-24 grid
+        if (half_exponent < -10) {
+            return sign;
+        }
+        mantissa |= 0x800000;
+        int shift = 14 - half_exponent;
+        half = mantissa >> shift;
+        remainder = mantissa & ((1u << shift) - 1);
+        halfway = 1u << (shift - 1);
+    } else {
+        half = (static_cast<std::uint32_t>(half_exponent) << 10) | (mantissa >> 13);
+        remainder = mantissa & 0x1FFF;
+        halfway = 0x1000;
+    }
+    // Round to nearest even; a carry into the exponent is still correct
+    if (remainder > halfway || (remainder == halfway && (half & 1))) {
+        ++half;
+    }
+    return static_cast<std::uint16_t>(sign | half);
+}
+
+float half_to_float(std::uint16_t bits) {
+    std::uint32_t sign = static_cast<std::uint32_t>(bits & 0x8000) << 16;
+    std::uint32_t exponent = (bits >> 10) & 0x1F;
+    std::uint32_t mantissa = bits & 0x3FF;
+
+    if (exponent == 0) {
+        float magnitude = static_cast<float>(mantissa) * 0x1p-24f;
+        return sign ? -magnitude : magnitude;
+    }
+    if (exponent == 0x1F) {
+        return std::bit_cast<float>(sign | 0x7F800000 | (mantissa << 13));
+    }
+    return std::bit_cast<float>(sign | ((exponent + 112) << 23) | (mantissa << 13));
+}
+
+std::uint16_t float_to_bfloat16(float value) {
+    auto bits = std::bit_cast<std::uint32_t>(value);
+    if (std::isnan(value)) {
+        return static_cast<std::uint16_t>((bits >> 16) | 0x40);  // Keep it a NaN
+    }
+    bits += 0x7FFF + ((bits >> 16) & 1);
+    return static_cast<std::uint16_t>(bits >> 16);
+}
+
+float bfloat16_to_float(std::uint16_t bits) {
+    return std::bit_cast<float>(static_cast<std::uint32_t>(bits) << 16);
+}
+
+// ----------------------------------------------------------------------------
+// EmbeddingMatrix
+// ----------------------------------------------------------------------------
+
+EmbeddingMatrix::EmbeddingMatrix(std::size_t rows, std::size_t dimensions)
+    : dimensions_(dimensions), stride_(padded_stride(dimensions)) {
+    resize(rows);
+}
+
+EmbeddingMatrix::EmbeddingMatrix(const EmbeddingMatrix& other)
+    : dimensions_(other.dimensions_), stride_(other.stride_) {
+    reallocate(other.rows_);
+    rows_ = other.rows_;
+    if (rows_ > 0) {
+        std::memcpy(data_.get(), other.data_.get(), rows_ * stride_ * sizeof(float));
+    }
+}
+
+EmbeddingMatrix& EmbeddingMatrix::operator=(const EmbeddingMatrix& other) {
+    if (this != &other) {
+        EmbeddingMatrix copy(other);
+        *this = std::move(copy);
+    }
+    return *this;
+}
+
+EmbeddingMatrix::EmbeddingMatrix(EmbeddingMatrix&& other) noexcept
+    : data_(std::move(other.data_))
+    , rows_(std::exchange(other.rows_, 0))
+    , dimensions_(std::exchange(other.dimensions_, 0))
+    , stride_(std::exchange(other.stride_, 0))
+    , capacity_(std::exchange(other.capacity_, 0)) {}
+
+EmbeddingMatrix& EmbeddingMatrix::operator=(EmbeddingMatrix&& other) noexcept {
+    data_ = std::move(other.data_);
+    rows_ = std::exchange(other.rows_, 0);
+    dimensions_ = std::exchange(other.dimensions_, 0);
+    stride_ = std::exchange(other.stride_, 0);
+    capacity_ = std::exchange(other.capacity_, 0);
+    return *this;
+}
+
+EmbeddingMatrix EmbeddingMatrix::from_response(const EmbeddingResponse& response) {
+    if (response.data.empty()) {
+        return {};
+    }
+    std::size_t rows = 0;
+    for (const auto& item : response.data) {
+        rows = std::max(rows, static_cast<std::size_t>(item.index) + 1);
+    }
+
+    EmbeddingMatrix matrix(rows, response.data.front().embedding.size());
+    for (const auto& item : response.data) {
+        if (item.embedding.size() != matrix.dimensions_) {
+            throw std::invalid_argument("Embeddings differ in dimensions");
+        }
+        std::ranges::copy(item.embedding, matrix.row(static_cast<std::size_t>(item.index)).begin());
+    }
+    return matrix;
+}
+
+void EmbeddingMatrix::reallocate(std::size_t capacity) {
+    std::unique_ptr<float[], AlignedDelete> data;
+    if (capacity > 0 && stride_ > 0) {
+        auto count = capacity * stride_;
+        data.reset(static_cast<float*>(::operator new[](count * sizeof(float), std::align_val_t{alignment})));
+        std::fill_n(data.get(), count, 0.0f);
+        if (rows_ > 0) {
+            std::memcpy(data.get(), data_.get(), std::min(rows_, capacity) * stride_ * sizeof(float));
+        }
+    }
+    data_ = std::move(data);
+    capacity_ = capacity;
+}
+
+void EmbeddingMatrix::resize(std::size_t rows) {
+    if (rows > capacity_) {
+        reallocate(std::max(rows, capacity_ * 2));
+    } else if (rows < rows_) {
+        std::fill_n(data_.get() + rows * stride_, (rows_ - rows) * stride_, 0.0f);
+    }
+    rows_ = rows;
+}
+
+void EmbeddingMatrix::normalize() {
+    for (std::size_t i = 0; i < rows_; ++i) {
+        auto values = row(i);
+        float sum = 0.0f;
+        for (float value : values) {
+            sum += value * value;
+        }
+        if (sum > 0.0f) {
+            float inverse = 1.0f / std::sqrt(sum);
+            for (float& value : values) {
+                value *= inverse;
+            }
+        }
+    }
+}
+
+// ----------------------------------------------------------------------------
+// QuantizedEmbeddingMatrix
+// ----------------------------------------------------------------------------
+
+QuantizedEmbeddingMatrix::QuantizedEmbeddingMatrix(EmbeddingMatrixView source, EmbeddingPrecision precision)
+    : precision_(precision), rows_(source.rows()), dimensions_(source.dimensions()) {
+    const auto row_bytes = dimensions_ * precision_size(precision_);
+    data_.resize(rows_ * row_bytes);
+    scales_.assign(rows_, 1.0f);
+
+    for (std::size_t r = 0; r < rows_; ++r) {
+        auto values = source[r];
+        auto* out = data_.data() + r * row_bytes;
+        switch (precision_) {
+            case EmbeddingPrecision::Float32:
+                std::memcpy(out, values.data(), row_bytes);
+                break;
+            case EmbeddingPrecision::Float16:
+                for (std::size_t i = 0; i < dimensions_; ++i) {
+                    store(out, i, float_to_half(values[i]));
+                }
+                break;
+            case EmbeddingPrecision::BFloat16:
+                for (std::size_t i = 0; i < dimensions_; ++i) {
+                    store(out, i, float_to_bfloat16(values[i]));
+                }
+                break;
+            case EmbeddingPrecision::Int8: {
+                float max_abs = 0.0f;
+                for (float value : values) {
+                    max_abs = std::max(max_abs, std::abs(value));
+                }
+                float scale = max_abs / 127.0f;
+                float inverse = scale > 0.0f ? 1.0f / scale : 0.0f;
+                for (std::size_t i = 0; i < dimensions_; ++i) {
+                    auto q = std::clamp(std::nearbyint(values[i] * inverse), -127.0f, 127.0f);
+                    store(out, i, static_cast<std::int8_t>(q));
+                }
+                scales_[r] = scale;
+                break;
+            }
+        }
+    }
+}
+
+std::span<const std::byte> QuantizedEmbeddingMatrix::row_data(std::size_t row) const {
+    const auto row_bytes = dimensions_ * precision_size(precision_);
+    return {data_.data() + row * row_bytes, row_bytes};
+}
+
+void QuantizedEmbeddingMatrix::dequantize_row(std::size_t row, std::span<float> out) const {
+    const auto* in = row_data(row).data();
+    switch (precision_) {
+        case EmbeddingPrecision::Float32:
+            std::memcpy(out.data(), in, dimensions_ * sizeof(float));
+            break;
+        case EmbeddingPrecision::Float16:
+            for (std::size_t i = 0; i < dimensions_; ++i) {
+                out[i] = half_to_float(load<std::uint16_t>(in, i));
+            }
+            break;
+        case EmbeddingPrecision::BFloat16:
+            for (std::size_t i = 0; i < dimensions_; ++i) {
+                out[i] = bfloat16_to_float(load<std::uint16_t>(in, i));
+            }
+            break;
+        case EmbeddingPrecision::Int8: {
+            float scale = scales_[row];
+            for (std::size_t i = 0; i < dimensions_; ++i) {
+                out[i] = static_cast<float>(load<std::int8_t>(in, i)) * scale;
+            }
+            break;
+        }
+    }
+}
+
+float QuantizedEmbeddingMatrix::dot(std::size_t row, std::span<const float> query) const {
+    const auto* in = row_data(row).data();
+    float sum = 0.0f;
+    switch (precision_) {
+        case EmbeddingPrecision::Float32:
+            for (std::size_t i = 0; i < dimensions_; ++i) {
+                sum += load<float>(in, i) * query[i];
+            }
+            return sum;
+        case EmbeddingPrecision::Float16:
+            for (std::size_t i = 0; i < dimensions_; ++i) {
+                sum += half_to_float(load<std::uint16_t>(in, i)) * query[i];
+            }
+            return sum;
+        case EmbeddingPrecision::BFloat16:
+            for (std::size_t i = 0; i < dimensions_; ++i) {
+                sum += bfloat16_to_float(load<std::uint16_t>(in, i)) * query[i];
+            }
+            return sum;
+        case EmbeddingPrecision::Int8:
+            for (std::size_t i = 0; i < dimensions_; ++i) {
+                sum += static_cast<float>(load<std::int8_t>(in, i)) * query[i];
+            }
+            return sum * scales_[row];
+    }
+    return sum;
+}
+
+EmbeddingMatrix QuantizedEmbeddingMatrix::to_float32() const {
+    EmbeddingMatrix matrix(rows_, dimensions_);
+    for (std::size_t r = 0; r < rows_; ++r) {
+        dequantize_row(r, matrix.row(r));
+    }
+    return matrix;
+}
+
+// ----------------------------------------------------------------------------
+// JSON decoding
+// ----------------------------------------------------------------------------
+
+void read_json(JsonReader& reader, EmbeddingMatrixResponse& out) {
+    std::vector<float> scratch;  // One row at a time, reused
+    std::vector<std::size_t> order;  // Index each row arrived with; rows are stored in arrival order
+
+    auto read_row = [&] {
+        std::int64_t index = -1;
+        bool has_embedding = false;
+        reader.object([&](std::string_view key) {
+            if (key == "index") reader.read(index);
+            else if (key == "embedding") {
+                has_embedding = true;
+                if (reader.peek() == JsonType::String) {
+                    auto offset = reader.offset();
+                    if (!decode_base64_embedding(reader.text(), scratch)) {
+                        throw JsonError("Invalid base64 embedding", offset);
+                    }
+                } else {
+                    reader.read(scratch);
+                }
+            }
+            else reader.skip();
+        });
+        if (!has_embedding) {
+            return;
+        }
+
+        auto row = order.size();
+        if (out.matrix.dimensions() == 0 && out.matrix.rows() == 0) {
+            out.matrix = EmbeddingMatrix(0, scratch.size());
+        } else if (scratch.size() != out.matrix.dimensions()) {
+            throw JsonError("Embeddings differ in dimensions", reader.offset());
+        }
+        out.matrix.resize(row + 1);
+        std::ranges::copy(scratch, out.matrix.row(row).begin());
+        order.push_back(index >= 0 ? static_cast<std::size_t>(index) : row);
+    };
+
+    reader.object([&](std::string_view key) {
+        if (key == "data") {
+            if (!reader.null()) {
+                reader.array(read_row);
+            }
+        }
+        else if (key == "model") reader.read(out.model);
+        else if (key == "usage") reader.read(out.usage);
+        else reader.skip();
+    });
+
+    // The server's indices must name each row exactly once
+    const auto count = order.size();
+    std::vector<bool> filled(count);
+    for (auto index : order) {
+        if (index >= count) {
+            throw JsonError("Embedding index " + std::to_string(index) + " out of range for " +
+                            std::to_string(count) + " items", reader.offset());
+        }
+        filled[index] = true;
+    }
+    if (auto missing = std::ranges::find(filled, false); missing != filled.end()) {
+        throw JsonError("Embedding response has no row for index " +
+                        std::to_string(missing - filled.begin()), reader.offset());
+    }
+
+    // Move rows to their indices, one cycle of the permutation at a time
+    for (std::size_t i = 0; i < count; ++i) {
+        while (order[i] != i) {
+            auto target = order[i];
+            std::ranges::copy(out.matrix.row(target), scratch.begin());
+            std::ranges::copy(out.matrix.row(i), out.matrix.row(target).begin());
+            std::ranges::copy(scratch, out.matrix.row(i).begin());
+            std::swap(order[i], order[target]);
+        }
+    }
+}
+
+} // namespace openai
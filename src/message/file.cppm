@@ -4,6 +4,7 @@
 export module openai.types.file;
 
 import std;
+import openai.types.json;
 
 export namespace openai {
 
@@ -13,9 +14,9 @@ export namespace openai {
 
 // File upload request
 struct FileUploadRequest {
-    std::string file_path;          // Local file path
+    std::string file_path;           // Local file path, streamed from disk
     std::string purpose;             // "fine-tune", "assistants", etc.
-    std::vector<char> file_content;  // File content (alternative to file_path)
+    std::vector<char> file_content;  // File content (alternative to file_path), sent without copying
     std::string filename;            // Filename (when using file_content)
 };
 
@@ -45,5 +46,55 @@ struct FileContentResponse {
     std::string content;
 };
 
+// Delete file response
+struct FileDeleteResponse {
+    std::string id;
+    std::string object;
+    bool deleted{false};
+};
+
+// JSON decoding
+void read_json(JsonReader& reader, FileObject& out);
+void read_json(JsonReader& reader, FileListResponse& out);
+void read_json(JsonReader& reader, FileDeleteResponse& out);
+
 } // namespace openai
 
+// ============================================================================
+// Implementation
+// ============================================================================
+
+namespace openai {
+
+void read_json(JsonReader& reader, FileObject& out) {
+    reader.object([&](std::string_view key) {
+        if (key == "id") reader.read(out.id);
+        else if (key == "object") reader.read(out.object);
+        else if (key == "bytes") reader.read(out.bytes);
+        else if (key == "created_at") reader.read(out.created_at);
+        else if (key == "filename") reader.read(out.filename);
+        else if (key == "purpose") reader.read(out.purpose);
+        else if (key == "status") reader.read(out.status);
+        else if (key == "status_details") reader.read(out.status_details);
+        else reader.skip();
+    });
+}
+
+void read_json(JsonReader& reader, FileListResponse& out) {
+    reader.object([&](std::string_view key) {
+        if (key == "object") reader.read(out.object);
+        else if (key == "data") reader.read(out.data);
+        else reader.skip();
+    });
+}
+
+void read_json(JsonReader& reader, FileDeleteResponse& out) {
+    reader.object([&](std::string_view key) {
+        if (key == "id") reader.read(out.id);
+        else if (key == "object") reader.read(out.object);
+        else if (key == "deleted") reader.read(out.deleted);
+        else reader.skip();
+    });
+}
+
+} // namespace openai
@@ -5,6 +5,7 @@ export module openai.types.fine_tuning;
 
 import std;
 import fmt;
+import openai.types.json;
 
 export namespace openai {
 
@@ -17,6 +18,8 @@ struct FineTuningHyperparameters {
     std::optional<int> n_epochs;
     std::optional<float> learning_rate_multiplier;
     std::optional<int> batch_size;
+    
+    void write_json(JsonWriter& json) const;
 };
 
 // Fine-tuning request
@@ -28,6 +31,7 @@ struct FineTuningRequest {
     std::optional<std::string> suffix;
     
     std::string to_json() const;
+    void write_json(JsonWriter& json) const;
 };
 
 // Fine-tuning error
@@ -65,6 +69,12 @@ struct FineTuningJobListResponse {
 // Fine-tuning job response (alias)
 using FineTuningJobResponse = FineTuningJob;
 
+// JSON decoding
+void read_json(JsonReader& reader, FineTuningHyperparameters& out);
+void read_json(JsonReader& reader, FineTuningError& out);
+void read_json(JsonReader& reader, FineTuningJob& out);
+void read_json(JsonReader& reader, FineTuningJobListResponse& out);
+
 } // namespace openai
 
 // ============================================================================
@@ -73,40 +83,86 @@ using FineTuningJobResponse = FineTuningJob;
 
 namespace openai {
 
+// FineTuningHyperparameters::write_json implementation
+void FineTuningHyperparameters::write_json(JsonWriter& json) const {
+    json.begin_object();
+    json.field("n_epochs", n_epochs);
+    json.field("learning_rate_multiplier", learning_rate_multiplier);
+    json.field("batch_size", batch_size);
+    json.end_object();
+}
+
 // FineTuningRequest::to_json implementation
 std::string FineTuningRequest::to_json() const {
-    std::ostringstream json;
-    json << "{";
-    json << fmt::format(R"("training_file":"{}")", training_file);
-    json << fmt::format(R"(,"model":"{}")", model);
-    
-    if (validation_file) {
-        json << fmt::format(R"(,"validation_file":"{}")", *validation_file);
-    }
-    if (suffix) {
-        json << fmt::format(R"(,"suffix":"{}")", *suffix);
-    }
-    if (hyperparameters) {
-        json << R"(,"hyperparameters":{)";
-        bool first = true;
-        if (hyperparameters->n_epochs) {
-            json << fmt::format(R"("n_epochs":{})", *hyperparameters->n_epochs);
-            first = false;
-        }
-        if (hyperparameters->learning_rate_multiplier) {
-            if (!first) json << ",";
-            json << fmt::format(R"("learning_rate_multiplier":{})", *hyperparameters->learning_rate_multiplier);
-            first = false;
-        }
-        if (hyperparameters->batch_size) {
-            if (!first) json << ",";
-            json << fmt::format(R"("batch_size":{})", *hyperparameters->batch_size);
+    return to_json_string(*this);
+}
+
+// FineTuningRequest::write_json implementation
+void FineTuningRequest::write_json(JsonWriter& json) const {
+    json.begin_object();
+    json.field("training_file", training_file);
+    json.field("model", model);
+    json.field("validation_file", validation_file);
+    json.field("suffix", suffix);
+    json.field("hyperparameters", hyperparameters);
+    json.end_object();
+}
+
+
+void read_json(JsonReader& reader, FineTuningHyperparameters& out) {
+    // Each value is either a number or "auto", which leaves it unset
+    auto read_setting = [&reader](auto& value) {
+        if (reader.peek() == JsonType::Number) {
+            reader.read(value);
+        } else {
+            value.reset();
+            reader.skip();
         }
-        json << "}";
-    }
-    
-    json << "}";
-    return json.str();
+    };
+    reader.object([&](std::string_view key) {
+        if (key == "n_epochs") read_setting(out.n_epochs);
+        else if (key == "learning_rate_multiplier") read_setting(out.learning_rate_multiplier);
+        else if (key == "batch_size") read_setting(out.batch_size);
+        else reader.skip();
+    });
+}
+
+void read_json(JsonReader& reader, FineTuningError& out) {
+    reader.object([&](std::string_view key) {
+        if (key == "code") reader.read(out.code);
+        else if (key == "message") reader.read(out.message);
+        else if (key == "param") reader.read(out.param);
+        else reader.skip();
+    });
+}
+
+void read_json(JsonReader& reader, FineTuningJob& out) {
+    reader.object([&](std::string_view key) {
+        if (key == "id") reader.read(out.id);
+        else if (key == "object") reader.read(out.object);
+        else if (key == "created_at") reader.read(out.created_at);
+        else if (key == "finished_at") reader.read(out.finished_at);
+        else if (key == "model") reader.read(out.model);
+        else if (key == "fine_tuned_model") reader.read(out.fine_tuned_model);
+        else if (key == "organization_id") reader.read(out.organization_id);
+        else if (key == "status") reader.read(out.status);
+        else if (key == "hyperparameters") reader.read(out.hyperparameters);
+        else if (key == "training_file") reader.read(out.training_file);
+        else if (key == "validation_file") reader.read(out.validation_file);
+        else if (key == "result_files") reader.read(out.result_files);
+        else if (key == "trained_tokens") reader.read(out.trained_tokens);
+        else if (key == "error") reader.read(out.error);
+        else reader.skip();
+    });
+}
+
+void read_json(JsonReader& reader, FineTuningJobListResponse& out) {
+    reader.object([&](std::string_view key) {
+        if (key == "object") reader.read(out.object);
+        else if (key == "data") reader.read(out.data);
+        else if (key == "has_more") reader.read(out.has_more);
+        else reader.skip();
+    });
 }
 
 } // namespace openai
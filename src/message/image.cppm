@@ -6,6 +6,7 @@ export module openai.types.image;
 import std;
 import fmt;
 import openai.types.common;
+import openai.types.json;
 
 export namespace openai {
 
@@ -25,6 +26,7 @@ struct ImageGenerationRequest {
     std::optional<std::string> user;
     
     std::string to_json() const;
+    void write_json(JsonWriter& json) const;
 };
 
 // Image edit request
@@ -67,6 +69,10 @@ struct ImageResponse {
     std::vector<ImageData> data;
 };
 
+// JSON decoding
+void read_json(JsonReader& reader, ImageData& out);
+void read_json(JsonReader& reader, ImageResponse& out);
+
 } // namespace openai
 
 // ============================================================================
@@ -77,34 +83,39 @@ namespace openai {
 
 // ImageGenerationRequest::to_json implementation
 std::string ImageGenerationRequest::to_json() const {
-    std::ostringstream json;
-    json << "{";
-    json << fmt::format(R"("prompt":"{}")", escape_json(prompt));
-    
-    if (model) {
-        json << fmt::format(R"(,"model":"{}")", *model);
-    }
-    if (n) {
-        json << fmt::format(R"(,"n":{})", *n);
-    }
-    if (quality) {
-        json << fmt::format(R"(,"quality":"{}")", *quality);
-    }
-    if (response_format) {
-        json << fmt::format(R"(,"response_format":"{}")", *response_format);
-    }
-    if (size) {
-        json << fmt::format(R"(,"size":"{}")", *size);
-    }
-    if (style) {
-        json << fmt::format(R"(,"style":"{}")", *style);
-    }
-    if (user) {
-        json << fmt::format(R"(,"user":"{}")", *user);
-    }
-    
-    json << "}";
-    return json.str();
+    return to_json_string(*this);
+}
+
+// ImageGenerationRequest::write_json implementation
+void ImageGenerationRequest::write_json(JsonWriter& json) const {
+    json.begin_object();
+    json.field("prompt", prompt);
+    json.field("model", model);
+    json.field("n", n);
+    json.field("quality", quality);
+    json.field("response_format", response_format);
+    json.field("size", size);
+    json.field("style", style);
+    json.field("user", user);
+    json.end_object();
+}
+
+
+void read_json(JsonReader& reader, ImageData& out) {
+    reader.object([&](std::string_view key) {
+        if (key == "url") reader.read(out.url);
+        else if (key == "b64_json") reader.read(out.b64_json);
+        else if (key == "revised_prompt") reader.read(out.revised_prompt);
+        else reader.skip();
+    });
+}
+
+void read_json(JsonReader& reader, ImageResponse& out) {
+    reader.object([&](std::string_view key) {
+        if (key == "created") reader.read(out.created);
+        else if (key == "data") reader.read(out.data);
+        else reader.skip();
+    });
 }
 
 } // namespace openai
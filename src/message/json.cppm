@@ -0,0 +1,754 @@
+// JSON Module
+// Single-pass pull reader for response bodies and a buffer-appending writer for requests
+
+export module openai.types.json;
+
+import fmt;
+import openai.types.common;
+import std;
+
+export namespace openai {
+
+// Malformed, truncated or mistyped JSON
+class JsonError : public std::runtime_error {
+public:
+    JsonError(const std::string& message, std::size_t offset)
+        : std::runtime_error(message + " at offset " + std::to_string(offset)), offset_(offset) {}
+
+    std::size_t offset() const { return offset_; }
+
+private:
+    std::size_t offset_;
+};
+
+enum class JsonType {
+    Null,
+    Bool,
+    Number,
+    String,
+    Array,
+    Object
+};
+
+// Pull reader over a complete JSON document. Each value is visited once and
+// written to its target as it is read; no intermediate tree is built.
+//
+//   reader.object([&](std::string_view key) {
+//       if (key == "id") reader.read(out.id);
+//       else reader.skip();
+//   });
+//
+// Every member must be either read or skipped. A null leaves scalar targets
+// unchanged and resets optionals. Type mismatches throw JsonError.
+class JsonReader {
+public:
+    explicit JsonReader(std::string_view input) : input_(input) {}
+
+    // Type of the next value
+    JsonType peek();
+
+    // Consume a null; false (and nothing consumed) for any other value
+    bool null();
+
+    // Visit each member; on_member(std::string_view key) must consume the value.
+    // The key is only valid until the value has been read.
+    template <typename F>
+    void object(F&& on_member) {
+        expect('{', "object");
+        if (consume('}')) {
+            return;
+        }
+        do {
+            on_member(key());
+        } while (next_in('}'));
+    }
+
+    // Visit each element; on_element() must consume it
+    template <typename F>
+    void array(F&& on_element) {
+        expect('[', "array");
+        if (consume(']')) {
+            return;
+        }
+        do {
+            on_element();
+        } while (next_in(']'));
+    }
+
+    void read(std::string& out);
+    void read(bool& out);
+    void read(int& out);
+    void read(std::int64_t& out);
+    void read(float& out);
+    void read(double& out);
+
+    // String values are stored as-is, anything else as raw JSON text
+    void read(std::map<std::string, std::string>& out);
+
+    // Numeric arrays (embeddings) are parsed in one pass with std::from_chars
+    // into storage reserved from the element count
+    void read(std::vector<float>& out);
+    void read(std::vector<double>& out);
+
+    template <typename T>
+    void read(std::optional<T>& out) {
+        if (null()) {
+            out.reset();
+            return;
+        }
+        read(out.emplace());
+    }
+
+    template <typename T>
+    void read(std::vector<T>& out) {
+        if (null()) {
+            return;
+        }
+        out.clear();
+        array([&] { read(out.emplace_back()); });
+    }
+
+    // Structs are decoded by the read_json overload declared next to them
+    template <typename T>
+    void read(T& out) {
+        if (null()) {
+            return;
+        }
+        read_json(*this, out);
+    }
+
+    // Contents of the next string without copying when it has no escapes.
+    // Only valid until the next read.
+    std::string_view text();
+
+    // Raw JSON text of the next value, left undecoded
+    std::string_view raw();
+
+    // Consume the next value without decoding it
+    void skip();
+
+    // Require that only whitespace remains
+    void finish();
+
+    std::size_t offset() const { return pos_; }
+
+private:
+    std::string_view key();
+    bool next_in(char close);
+    void skip_whitespace();
+    bool consume(char c);
+    void expect(char c, const char* what);
+    std::string_view number_token();
+    void read_string(std::string& out);
+    void skip_string();
+    template <typename T>
+    void read_numbers(std::vector<T>& out);
+    void literal(std::string_view word);
+    [[noreturn]] void fail(const std::string& message) const;
+
+    std::string_view input_;
+    std::size_t pos_{0};
+    std::string key_buffer_;   // Keys containing escapes
+    std::string text_buffer_;  // text() of strings containing escapes
+};
+
+// Decode a complete document into T via its read_json overload
+template <typename T>
+T decode_json(std::string_view input) {
+    T out{};
+    JsonReader reader(input);
+    read_json(reader, out);
+    reader.finish();
+    return out;
+}
+
+// Writer appending to a caller-owned buffer. Commas are placed automatically
+// and strings are escaped while they are copied, so a whole request is
+// serialized without temporary strings.
+//
+//   json.begin_object();
+//   json.field("model", model);
+//   json.field("max_tokens", max_tokens);  // Skipped when the optional is empty
+//   json.end_object();
+//
+// A default-constructed writer only measures: it counts the bytes the same
+// calls would produce (strings before escaping) so the buffer can be
+// reserved up front.
+class JsonWriter {
+public:
+    JsonWriter() = default;
+    explicit JsonWriter(fmt::memory_buffer& out) : out_(&out) {}
+
+    void begin_object() { open('{'); }
+    void end_object() { close('}'); }
+    void begin_array() { open('['); }
+    void end_array() { close(']'); }
+
+    // Member name; the value written next belongs to it
+    void key(std::string_view name);
+
+    void string(std::string_view value);
+    void boolean(bool value);
+    void null();
+
+    // Non-finite floating-point values are written as null
+    template <typename T>
+        requires std::is_arithmetic_v<T>
+    void number(T value) {
+        if constexpr (std::is_floating_point_v<T>) {
+            if (!std::isfinite(value)) {
+                null();
+                return;
+            }
+        }
+        char digits[32];
+        auto end = fmt::format_to(digits, "{}", value);
+        separate();
+        append(digits, static_cast<std::size_t>(end - digits));
+        needs_comma_ = true;
+    }
+
+    // Pre-serialized JSON, copied verbatim
+    void raw(std::string_view json);
+
+    // Strings, numbers, bools and types with write_json(JsonWriter&)
+    template <typename T>
+    void value(const T& item) {
+        if constexpr (std::is_same_v<T, bool>) {
+            boolean(item);
+        } else if constexpr (std::is_arithmetic_v<T>) {
+            number(item);
+        } else if constexpr (std::is_convertible_v<const T&, std::string_view>) {
+            string(item);
+        } else {
+            item.write_json(*this);
+        }
+    }
+
+    template <typename T>
+    void value(const std::vector<T>& values) {
+        begin_array();
+        for (const auto& item : values) {
+            value(item);
+        }
+        end_array();
+    }
+
+    void value(const std::map<std::string, std::string>& values) {
+        begin_object();
+        for (const auto& [name, item] : values) {
+            key(name);
+            string(item);
+        }
+        end_object();
+    }
+
+    template <typename T>
+    void field(std::string_view name, const T& field_value) {
+        key(name);
+        value(field_value);
+    }
+
+    // Empty optionals are omitted
+    template <typename T>
+    void field(std::string_view name, const std::optional<T>& field_value) {
+        if (field_value) {
+            field(name, *field_value);
+        }
+    }
+
+    // Bytes written (or measured) so far
+    std::size_t size() const { return size_; }
+
+private:
+    void open(char bracket);
+    void close(char bracket);
+    void separate();
+    void append(const char* data, std::size_t size);
+    void append_escaped(std::string_view value);
+
+    fmt::memory_buffer* out_{nullptr};
+    std::size_t size_{0};
+    bool needs_comma_{false};
+};
+
+// Append value.write_json() to out, reserving the measured size first
+template <typename T>
+void append_json(fmt::memory_buffer& out, const T& value) {
+    JsonWriter measure;
+    value.write_json(measure);
+    out.reserve(out.size() + measure.size());
+    
+    JsonWriter writer(out);
+    value.write_json(writer);
+}
+
+// Serialize value.write_json() to a string
+template <typename T>
+std::string to_json_string(const T& value) {
+    fmt::memory_buffer buffer;
+    append_json(buffer, value);
+    return fmt::to_string(buffer);
+}
+
+} // namespace openai
+
+// ============================================================================
+// Implementation
+// ============================================================================
+
+namespace openai {
+
+void JsonReader::fail(const std::string& message) const {
+    throw JsonError(message, pos_);
+}
+
+void JsonReader::skip_whitespace() {
+    while (pos_ < input_.size()) {
+        char c = input_[pos_];
+        if (c != ' ' && c != '\n' && c != '\r' && c != '\t') {
+            break;
+        }
+        ++pos_;
+    }
+}
+
+bool JsonReader::consume(char c) {
+    skip_whitespace();
+    if (pos_ < input_.size() && input_[pos_] == c) {
+        ++pos_;
+        return true;
+    }
+    return false;
+}
+
+void JsonReader::expect(char c, const char* what) {
+    if (!consume(c)) {
+        fail(std::string("Expected ") + what);
+    }
+}
+
+JsonType JsonReader::peek() {
+    skip_whitespace();
+    if (pos_ >= input_.size()) {
+        fail("Unexpected end of JSON");
+    }
+    switch (input_[pos_]) {
+        case '{': return JsonType::Object;
+        case '[': return JsonType::Array;
+        case '"': return JsonType::String;
+        case 't':
+        case 'f': return JsonType::Bool;
+        case 'n': return JsonType::Null;
+        default: return JsonType::Number;
+    }
+}
+
+bool JsonReader::null() {
+    if (peek() != JsonType::Null) {
+        return false;
+    }
+    literal("null");
+    return true;
+}
+
+void JsonReader::literal(std::string_view word) {
+    if (input_.substr(pos_, word.size()) != word) {
+        fail("Invalid literal");
+    }
+    pos_ += word.size();
+}
+
+bool JsonReader::next_in(char close) {
+    if (consume(',')) {
+        return true;
+    }
+    if (consume(close)) {
+        return false;
+    }
+    fail(std::string("Expected ',' or '") + close + "'");
+}
+
+std::string_view JsonReader::key() {
+    skip_whitespace();
+    if (pos_ >= input_.size() || input_[pos_] != '"') {
+        fail("Expected object key");
+    }
+    std::string_view result;
+    auto start = pos_ + 1;
+    auto end = find_json_quote(input_, start);
+    if (end < input_.size() && input_[end] == '"') {
+        result = input_.substr(start, end - start);
+        pos_ = end + 1;
+    } else {
+        key_buffer_.clear();
+        read_string(key_buffer_);
+        result = key_buffer_;
+    }
+    expect(':', "':'");
+    return result;
+}
+
+void JsonReader::read_string(std::string& out) {
+    skip_whitespace();
+    if (pos_ >= input_.size() || input_[pos_] != '"') {
+        fail("Expected string");
+    }
+    ++pos_;
+
+    while (true) {
+        // Copy the run up to the next quote or escape in one go
+        auto end = find_json_quote(input_, pos_);
+        if (end == input_.size()) {
+            fail("Unterminated string");
+        }
+        out.append(input_.data() + pos_, end - pos_);
+        pos_ = end + 1;
+        if (input_[end] == '"') {
+            return;
+        }
+
+        auto next = decode_json_escape(input_, pos_, out);
+        if (next == std::string_view::npos) {
+            fail(pos_ >= input_.size() ? "Unterminated string" : "Invalid escape");
+        }
+        pos_ = next;
+    }
+}
+
+void JsonReader::skip_string() {
+    ++pos_;  // Opening quote
+    while (true) {
+        auto end = find_json_quote(input_, pos_);
+        if (end == input_.size()) {
+            fail("Unterminated string");
+        }
+        pos_ = end + 1;
+        if (input_[end] == '"') {
+            return;
+        }
+        ++pos_;  // Escaped character; \u digits are plain text here
+    }
+}
+
+std::string_view JsonReader::number_token() {
+    skip_whitespace();
+    auto start = pos_;
+    while (pos_ < input_.size()) {
+        char c = input_[pos_];
+        if ((c < '0' || c > '9') && c != '-' && c != '+' && c != '.' && c != 'e' && c != 'E') {
+            break;
+        }
+        ++pos_;
+    }
+    if (pos_ == start) {
+        fail("Expected number");
+    }
+    return input_.substr(start, pos_ - start);
+}
+
+void JsonReader::read(std::string& out) {
+    if (null()) {
+        return;
+    }
+    out.clear();
+    read_string(out);
+}
+
+void JsonReader::read(bool& out) {
+    switch (peek()) {
+        case JsonType::Null: literal("null"); return;
+        case JsonType::Bool:
+            out = input_[pos_] == 't';
+            literal(out ? "true" : "false");
+            return;
+        default: fail("Expected boolean");
+    }
+}
+
+void JsonReader::read(int& out) {
+    if (null()) {
+        return;
+    }
+    auto token = number_token();
+    auto [end, ec] = std::from_chars(token.data(), token.data() + token.size(), out);
+    if (ec != std::errc{} || end != token.data() + token.size()) {
+        // Integral fields occasionally arrive as 1.0
+        double value = 0.0;
+        auto [fend, fec] = std::from_chars(token.data(), token.data() + token.size(), value);
+        if (fec != std::errc{} || fend != token.data() + token.size()) {
+            fail("Invalid integer");
+        }
+        out = static_cast<int>(value);
+    }
+}
+
+void JsonReader::read(std::int64_t& out) {
+    if (null()) {
+        return;
+    }
+    auto token = number_token();
+    auto [end, ec] = std::from_chars(token.data(), token.data() + token.size(), out);
+    if (ec != std::errc{} || end != token.data() + token.size()) {
+        double value = 0.0;
+        auto [fend, fec] = std::from_chars(token.data(), token.data() + token.size(), value);
+        if (fec != std::errc{} || fend != token.data() + token.size()) {
+            fail("Invalid integer");
+        }
+        out = static_cast<std::int64_t>(value);
+    }
+}
+
+void JsonReader::read(float& out) {
+    if (null()) {
+        return;
+    }
+    auto token = number_token();
+    auto [end, ec] = std::from_chars(token.data(), token.data() + token.size(), out);
+    if (end != token.data() + token.size() || (ec != std::errc{} && ec != std::errc::result_out_of_range)) {
+        fail("Invalid number");
+    }
+}
+
+void JsonReader::read(double& out) {
+    if (null()) {
+        return;
+    }
+    auto token = number_token();
+    auto [end, ec] = std::from_chars(token.data(), token.data() + token.size(), out);
+    if (end != token.data() + token.size() || (ec != std::errc{} && ec != std::errc::result_out_of_range)) {
+        fail("Invalid number");
+    }
+}
+
+void JsonReader::read(std::map<std::string, std::string>& out) {
+    if (null()) {
+        return;
+    }
+    out.clear();
+    object([&](std::string_view name) {
+        auto& value = out[std::string(name)];
+        if (peek() == JsonType::String) {
+            read_string(value);
+        } else {
+            value = raw();
+        }
+    });
+}
+
+template <typename T>
+void JsonReader::read_numbers(std::vector<T>& out) {
+    if (null()) {
+        return;
+    }
+    expect('[', "array");
+    auto close = input_.find(']', pos_);
+    if (close == std::string_view::npos) {
+        fail("Unterminated array");
+    }
+
+    // A flat numeric array holds exactly one more element than commas
+    const char* p = input_.data() + pos_;
+    const char* end = input_.data() + close;
+    out.clear();
+    out.reserve(static_cast<std::size_t>(std::count(p, end, ',')) + 1);
+
+    auto skip_space = [&] {
+        while (p != end && (*p == ' ' || *p == '\n' || *p == '\r' || *p == '\t')) {
+            ++p;
+        }
+    };
+    skip_space();
+    while (p != end) {
+        T value{};
+        auto [next, ec] = std::from_chars(p, end, value);
+        if (ec != std::errc{} && ec != std::errc::result_out_of_range) {
+            pos_ = static_cast<std::size_t>(p - input_.data());
+            fail("Invalid number");
+        }
+        out.push_back(value);
+        p = next;
+        skip_space();
+        if (p == end) {
+            break;
+        }
+        if (*p != ',') {
+            pos_ = static_cast<std::size_t>(p - input_.data());
+            fail("Expected ',' or ']'");
+        }
+        ++p;
+        skip_space();
+        if (p == end) {
+            pos_ = close;
+            fail("Expected number");
+        }
+    }
+    pos_ = close + 1;
+}
+
+void JsonReader::read(std::vector<float>& out) {
+    read_numbers(out);
+}
+
+void JsonReader::read(std::vector<double>& out) {
+    read_numbers(out);
+}
+
+std::string_view JsonReader::text() {
+    skip_whitespace();
+    if (pos_ >= input_.size() || input_[pos_] != '"') {
+        fail("Expected string");
+    }
+    auto start = pos_ + 1;
+    auto end = find_json_quote(input_, start);
+    if (end < input_.size() && input_[end] == '"') {
+        pos_ = end + 1;
+        return input_.substr(start, end - start);
+    }
+    text_buffer_.clear();
+    read_string(text_buffer_);
+    return text_buffer_;
+}
+
+std::string_view JsonReader::raw() {
+    skip_whitespace();
+    auto start = pos_;
+    skip();
+    return input_.substr(start, pos_ - start);
+}
+
+void JsonReader::skip() {
+    // Iterative so deeply nested input cannot exhaust the stack
+    std::string closers;  // Closing brackets of the containers still open
+    while (true) {
+        switch (peek()) {
+            case JsonType::String:
+                skip_string();
+                break;
+            case JsonType::Number:
+                number_token();
+                break;
+            case JsonType::Bool:
+                literal(input_[pos_] == 't' ? "true" : "false");
+                break;
+            case JsonType::Null:
+                literal("null");
+                break;
+            case JsonType::Object:
+                ++pos_;
+                if (consume('}')) {
+                    break;
+                }
+                closers += '}';
+                key();
+                continue;
+            case JsonType::Array:
+                ++pos_;
+                if (consume(']')) {
+                    break;
+                }
+                closers += ']';
+                continue;
+        }
+
+        // A value is complete: close the containers it ended, then move on
+        while (!closers.empty()) {
+            if (consume(',')) {
+                if (closers.back() == '}') {
+                    key();
+                }
+                break;
+            }
+            if (!consume(closers.back())) {
+                fail(std::string("Expected ',' or '") + closers.back() + "'");
+            }
+            closers.pop_back();
+        }
+        if (closers.empty()) {
+            return;
+        }
+    }
+}
+
+void JsonReader::finish() {
+    skip_whitespace();
+    if (pos_ != input_.size()) {
+        fail("Trailing characters after JSON");
+    }
+}
+
+// ============================================================================
+// JsonWriter
+// ============================================================================
+
+void JsonWriter::append(const char* data, std::size_t size) {
+    if (out_) {
+        out_->append(data, data + size);
+    }
+    size_ += size;
+}
+
+void JsonWriter::separate() {
+    if (needs_comma_) {
+        append(",", 1);
+    }
+}
+
+void JsonWriter::open(char bracket) {
+    separate();
+    append(&bracket, 1);
+    needs_comma_ = false;
+}
+
+void JsonWriter::close(char bracket) {
+    append(&bracket, 1);
+    needs_comma_ = true;
+}
+
+void JsonWriter::key(std::string_view name) {
+    separate();
+    append_escaped(name);
+    append(":", 1);
+    needs_comma_ = false;
+}
+
+void JsonWriter::string(std::string_view value) {
+    separate();
+    append_escaped(value);
+    needs_comma_ = true;
+}
+
+void JsonWriter::boolean(bool value) {
+    separate();
+    if (value) {
+        append("true", 4);
+    } else {
+        append("false", 5);
+    }
+    needs_comma_ = true;
+}
+
+void JsonWriter::null() {
+    separate();
+    append("null", 4);
+    needs_comma_ = true;
+}
+
+void JsonWriter::raw(std::string_view json) {
+    separate();
+    append(json.data(), json.size());
+    needs_comma_ = true;
+}
+
+void JsonWriter::append_escaped(std::string_view value) {
+    if (!out_) {
+        size_ += value.size() + 2;  // Escapes are rare; the buffer grows if needed
+        return;
+    }
+
+    append("\"", 1);
+    escape_json_to(value, [this](const char* data, std::size_t size) { append(data, size); });
+    append("\"", 1);
+}
+
+} // namespace openai
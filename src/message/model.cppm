@@ -4,6 +4,7 @@
 export module openai.types.model;
 
 import std;
+import openai.types.json;
 
 export namespace openai {
 
@@ -28,5 +29,34 @@ struct ModelListResponse {
 // Model list alias (for compatibility)
 using ModelList = ModelListResponse;
 
+// JSON decoding
+void read_json(JsonReader& reader, Model& out);
+void read_json(JsonReader& reader, ModelListResponse& out);
+
 } // namespace openai
 
+// ============================================================================
+// Implementation
+// ============================================================================
+
+namespace openai {
+
+void read_json(JsonReader& reader, Model& out) {
+    reader.object([&](std::string_view key) {
+        if (key == "id") reader.read(out.id);
+        else if (key == "object") reader.read(out.object);
+        else if (key == "created") reader.read(out.created);
+        else if (key == "owned_by") reader.read(out.owned_by);
+        else reader.skip();
+    });
+}
+
+void read_json(JsonReader& reader, ModelListResponse& out) {
+    reader.object([&](std::string_view key) {
+        if (key == "object") reader.read(out.object);
+        else if (key == "data") reader.read(out.data);
+        else reader.skip();
+    });
+}
+
+} // namespace openai
@@ -6,6 +6,7 @@ export module openai.types.moderation;
 import std;
 import fmt;
 import openai.types.common;
+import openai.types.json;
 
 export namespace openai {
 
@@ -56,6 +57,7 @@ struct ModerationRequest {
     std::optional<std::string> model{"text-moderation-latest"};
     
     std::string to_json() const;
+    void write_json(JsonWriter& json) const;
 };
 
 // Moderation response
@@ -65,6 +67,12 @@ struct ModerationResponse {
     std::vector<ModerationResult> results;
 };
 
+// JSON decoding
+void read_json(JsonReader& reader, ModerationCategories& out);
+void read_json(JsonReader& reader, ModerationCategoryScores& out);
+void read_json(JsonReader& reader, ModerationResult& out);
+void read_json(JsonReader& reader, ModerationResponse& out);
+
 } // namespace openai
 
 // ============================================================================
@@ -75,14 +83,67 @@ namespace openai {
 
 // ModerationRequest::to_json implementation
 std::string ModerationRequest::to_json() const {
-    std::ostringstream json;
-    json << "{";
-    json << fmt::format(R"("input":"{}")", escape_json(input));
-    if (model) {
-        json << fmt::format(R"(,"model":"{}")", *model);
-    }
-    json << "}";
-    return json.str();
+    return to_json_string(*this);
+}
+
+// ModerationRequest::write_json implementation
+void ModerationRequest::write_json(JsonWriter& json) const {
+    json.begin_object();
+    json.field("input", input);
+    json.field("model", model);
+    json.end_object();
+}
+
+
+// Categories and scores share their key set
+template <typename Fields, typename T>
+void read_moderation_fields(JsonReader& reader, Fields& out) {
+    reader.object([&](std::string_view key) {
+        T* field = nullptr;
+        if (key == "hate") field = &out.hate;
+        else if (key == "hate/threatening") field = &out.hate_threatening;
+        else if (key == "harassment") field = &out.harassment;
+        else if (key == "harassment/threatening") field = &out.harassment_threatening;
+        else if (key == "self-harm") field = &out.self_harm;
+        else if (key == "self-harm/intent") field = &out.self_harm_intent;
+        else if (key == "self-harm/instructions") field = &out.self_harm_instructions;
+        else if (key == "sexual") field = &out.sexual;
+        else if (key == "sexual/minors") field = &out.sexual_minors;
+        else if (key == "violence") field = &out.violence;
+        else if (key == "violence/graphic") field = &out.violence_graphic;
+        
+        if (field) {
+            reader.read(*field);
+        } else {
+            reader.skip();
+        }
+    });
+}
+
+void read_json(JsonReader& reader, ModerationCategories& out) {
+    read_moderation_fields<ModerationCategories, bool>(reader, out);
+}
+
+void read_json(JsonReader& reader, ModerationCategoryScores& out) {
+    read_moderation_fields<ModerationCategoryScores, double>(reader, out);
+}
+
+void read_json(JsonReader& reader, ModerationResult& out) {
+    reader.object([&](std::string_view key) {
+        if (key == "flagged") reader.read(out.flagged);
+        else if (key == "categories") reader.read(out.categories);
+        else if (key == "category_scores") reader.read(out.category_scores);
+        else reader.skip();
+    });
+}
+
+void read_json(JsonReader& reader, ModerationResponse& out) {
+    reader.object([&](std::string_view key) {
+        if (key == "id") reader.read(out.id);
+        else if (key == "model") reader.read(out.model);
+        else if (key == "results") reader.read(out.results);
+        else reader.skip();
+    });
 }
 
 } // namespace openai
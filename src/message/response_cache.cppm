@@ -0,0 +1,305 @@
+// Response Cache Module
+// LRU + TTL cache of API response bodies, optionally persisted to disk
+
+export module openai.types.response_cache;
+
+import std;
+import openai.types.common;
+
+export namespace openai {
+
+// ============================================================================
+// RESPONSE CACHE - Deterministic request body -> response body
+// ============================================================================
+
+// How a single call uses the client's response cache
+enum class CachePolicy {
+    Default,  // Answer from the cache when possible, store fresh responses
+    Bypass,   // Neither read nor write the cache
+    Refresh   // Always call the API, then replace the cached response
+};
+
+struct ResponseCacheOptions {
+    std::size_t max_bytes{64 * 1024 * 1024};  // Budget for cached bodies
+    std::chrono::seconds ttl{std::chrono::hours(24)};  // Zero: entries never expire
+    std::string path;  // Persist entries here; empty keeps the cache in memory only
+};
+
+// Cache counters (safe to read while requests are in flight)
+struct ResponseCacheMetrics {
+    std::atomic<std::uint64_t> hits{0};
+    std::atomic<std::uint64_t> misses{0};
+    std::atomic<std::uint64_t> shared{0};     // Misses that joined an identical in-flight call
+    std::atomic<std::uint64_t> bypassed{0};
+    std::atomic<std::uint64_t> stores{0};
+    std::atomic<std::uint64_t> evictions{0};  // Dropped for space
+    std::atomic<std::uint64_t> expirations{0};
+    std::atomic<std::uint64_t> bytes{0};      // Body bytes currently held
+
+    double hit_rate() const {
+        auto lookups = hits.load() + misses.load();
+        return lookups == 0 ? 0.0 : static_cast<double>(hits.load()) / lookups;
+    }
+};
+
+// Response bodies keyed by SHA-256 of (endpoint, serialized request). Request
+// serialization is deterministic, so identical requests (same model, messages
+// and parameters) share a key. Only enable it for calls whose answers may be
+// reused, e.g. temperature 0 templates. With a path set, stores are appended
+// to a log that is reloaded (and compacted) when the cache is opened; one
+// process should own a log at a time. All methods are thread-safe.
+class ResponseCache {
+public:
+    using Key = std::array<std::uint8_t, 32>;
+
+    explicit ResponseCache(ResponseCacheOptions options = {});
+    ~ResponseCache();
+
+    ResponseCache(const ResponseCache&) = delete;
+    ResponseCache& operator=(const ResponseCache&) = delete;
+
+    static Key make_key(std::string_view endpoint, std::string_view request_body);
+
+    // Cached body, or nullopt if missing or expired
+    std::optional<std::string> find(const Key& key);
+
+    void insert(const Key& key, std::string body);
+    void erase(const Key& key);
+    void clear();
+
+    // Push appended entries to the log file
+    void flush();
+
+    std::size_t size() const;
+    const ResponseCacheOptions& options() const { return options_; }
+
+    ResponseCacheMetrics& metrics() { return metrics_; }
+    const ResponseCacheMetrics& metrics() const { return metrics_; }
+
+private:
+    using Clock = std::chrono::system_clock;
+
+    struct Entry {
+        std::string body;
+        Clock::time_point expires;  // time_point::max() when there is no TTL
+        std::list<Key>::iterator position;
+    };
+
+    void store(const Key& key, std::string body, Clock::time_point expires);
+    void remove(std::map<Key, Entry>::iterator it);
+    void append(const Key& key, std::string_view body, Clock::time_point expires);
+    void load();
+
+    ResponseCacheOptions options_;
+    mutable std::mutex mutex_;
+    std::list<Key> order_;  // Most recently used first
+    std::map<Key, Entry> entries_;
+    std::size_t bytes_{0};
+    std::ofstream log_;
+    ResponseCacheMetrics metrics_;
+};
+
+} // namespace openai
+
+// ============================================================================
+// Implementation
+// ============================================================================
+
+namespace openai {
+
+namespace {
+
+// Log layout, native byte order:
+//   header  magic (8 bytes), version (u32), reserved (u32)
+//   record  key (32 bytes), expiry in Unix seconds or 0 (i64), size (u32), reserved (u32), body
+constexpr std::array<char, 8> log_magic = {'O', 'A', 'I', 'R', 'E', 'S', 'P', '1'};
+constexpr std::uint32_t log_version = 1;
+constexpr std::size_t log_header_size = 16;
+constexpr std::size_t log_record_header_size = 48;
+
+} // namespace
+
+ResponseCache::ResponseCache(ResponseCacheOptions options)
+    : options_(std::move(options)) {
+    if (!options_.path.empty()) {
+        load();
+    }
+}
+
+ResponseCache::~ResponseCache() {
+    if (log_.is_open()) {
+        log_.flush();
+    }
+}
+
+ResponseCache::Key ResponseCache::make_key(std::string_view endpoint, std::string_view request_body) {
+    return hash_fields({endpoint, request_body});
+}
+
+std::optional<std::string> ResponseCache::find(const Key& key) {
+    std::lock_guard lock(mutex_);
+    auto it = entries_.find(key);
+    if (it != entries_.end() && it->second.expires <= Clock::now()) {
+        remove(it);
+        ++metrics_.expirations;
+        it = entries_.end();
+    }
+    if (it == entries_.end()) {
+        ++metrics_.misses;
+        return std::nullopt;
+    }
+    order_.splice(order_.begin(), order_, it->second.position);
+    ++metrics_.hits;
+    return it->second.body;
+}
+
+void ResponseCache::insert(const Key& key, std::string body) {
+    auto expires = options_.ttl.count() > 0 ? Clock::now() + options_.ttl : Clock::time_point::max();
+    std::lock_guard lock(mutex_);
+    if (log_.is_open()) {
+        append(key, body, expires);
+    }
+    store(key, std::move(body), expires);
+    ++metrics_.stores;
+}
+
+void ResponseCache::erase(const Key& key) {
+    std::lock_guard lock(mutex_);
+    auto it = entries_.find(key);
+    if (it != entries_.end()) {
+        remove(it);
+    }
+    if (log_.is_open()) {
+        append(key, {}, Clock::time_point(std::chrono::seconds(1)));  // Already-expired tombstone
+    }
+}
+
+void ResponseCache::clear() {
+    std::lock_guard lock(mutex_);
+    entries_.clear();
+    order_.clear();
+    bytes_ = 0;
+    metrics_.bytes = 0;
+    if (log_.is_open()) {
+        log_.close();
+        std::filesystem::remove(options_.path);
+        load();
+    }
+}
+
+void ResponseCache::flush() {
+    std::lock_guard lock(mutex_);
+    if (log_.is_open()) {
+        log_.flush();
+    }
+}
+
+std::size_t ResponseCache::size() const {
+    std::lock_guard lock(mutex_);
+    return entries_.size();
+}
+
+// Insert or replace, then evict least recently used entries over budget.
+// Caller holds mutex_.
+void ResponseCache::store(const Key& key, std::string body, Clock::time_point expires) {
+    if (auto it = entries_.find(key); it != entries_.end()) {
+        remove(it);
+    }
+    if (body.size() > options_.max_bytes) {
+        return;
+    }
+    bytes_ += body.size();
+    metrics_.bytes = bytes_;
+    order_.push_front(key);
+    entries_.emplace(key, Entry{std::move(body), expires, order_.begin()});
+
+    while (bytes_ > options_.max_bytes) {
+        remove(entries_.find(order_.back()));
+        ++metrics_.evictions;
+    }
+}
+
+void ResponseCache::remove(std::map<Key, Entry>::iterator it) {
+    bytes_ -= it->second.body.size();
+    metrics_.bytes = bytes_;
+    order_.erase(it->second.position);
+    entries_.erase(it);
+}
+
+void ResponseCache::append(const Key& key, std::string_view body, Clock::time_point expires) {
+    std::int64_t expiry = expires == Clock::time_point::max()
+        ? 0
+        : std::chrono::duration_cast<std::chrono::seconds>(expires.time_since_epoch()).count();
+    std::array<std::uint32_t, 2> sizes = {static_cast<std::uint32_t>(body.size()), 0};
+    log_.write(reinterpret_cast<const char*>(key.data()), static_cast<std::streamsize>(key.size()));
+    log_.write(reinterpret_cast<const char*>(&expiry), sizeof(expiry));
+    log_.write(reinterpret_cast<const char*>(sizes.data()), sizeof(sizes));
+    log_.write(body.data(), static_cast<std::streamsize>(body.size()));
+    if (!log_) {
+        throw std::runtime_error("Failed to append to response cache: " + options_.path);
+    }
+}
+
+// Replay the log (later records win, expired ones are dropped), then rewrite
+// it with only the live entries and reopen it for appending
+void ResponseCache::load() {
+    const auto& path = options_.path;
+    if (std::filesystem::exists(path)) {
+        std::ifstream in(path, std::ios::binary);
+        std::string data((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+        if (data.size() < log_header_size || std::memcmp(data.data(), log_magic.data(), log_magic.size()) != 0) {
+            throw std::runtime_error("Not a response cache file: " + path);
+        }
+        std::uint32_t version;
+        std::memcpy(&version, data.data() + log_magic.size(), sizeof(version));
+        if (version != log_version) {
+            throw std::runtime_error("Unsupported response cache version: " + path);
+        }
+
+        const auto now = Clock::now();
+        std::size_t pos = log_header_size;
+        while (pos + log_record_header_size <= data.size()) {
+            Key key;
+            std::int64_t expiry;
+            std::uint32_t size;
+            std::memcpy(key.data(), data.data() + pos, key.size());
+            std::memcpy(&expiry, data.data() + pos + 32, sizeof(expiry));
+            std::memcpy(&size, data.data() + pos + 40, sizeof(size));
+            auto body_pos = pos + log_record_header_size;
+            if (body_pos + size > data.size()) {
+                break;  // Torn final record
+            }
+            pos = body_pos + size;
+
+            auto expires = expiry == 0 ? Clock::time_point::max() : Clock::time_point(std::chrono::seconds(expiry));
+            if (expires <= now) {
+                if (auto it = entries_.find(key); it != entries_.end()) {
+                    remove(it);
+                }
+                continue;
+            }
+            store(key, data.substr(body_pos, size), expires);
+        }
+    }
+
+    // Compact: most recently used last, so replaying restores the LRU order
+    auto temp = path + ".tmp";
+    log_.open(temp, std::ios::binary | std::ios::trunc);
+    std::array<char, log_header_size> header{};
+    std::memcpy(header.data(), log_magic.data(), log_magic.size());
+    std::memcpy(header.data() + log_magic.size(), &log_version, sizeof(log_version));
+    log_.write(header.data(), header.size());
+    for (auto it = order_.rbegin(); it != order_.rend(); ++it) {
+        const auto& entry = entries_.at(*it);
+        append(*it, entry.body, entry.expires);
+    }
+    log_.close();
+    std::filesystem::rename(temp, path);
+
+    log_.open(path, std::ios::binary | std::ios::app);
+    if (!log_) {
+        throw std::runtime_error("Failed to open response cache: " + path);
+    }
+}
+
+} // namespace openai
@@ -5,6 +5,7 @@ export module openai.types.run;
 
 import std;
 import openai.types.assistant;
+import openai.types.json;
 
 export namespace openai {
 
@@ -44,9 +45,9 @@ struct Run {
     std::int64_t created_at{0};
     std::string thread_id;
     std::string assistant_id;
-    RunStatus status;
-    std::optional<std::string> required_action;
-    std::optional<std::string> last_error;
+    RunStatus status{RunStatus::Queued};
+    std::optional<std::string> required_action;  // Raw JSON object
+    std::optional<std::string> last_error;       // Raw JSON object
     std::optional<std::int64_t> expires_at;
     std::optional<std::int64_t> started_at;
     std::optional<std::int64_t> cancelled_at;
@@ -68,6 +69,7 @@ struct CreateRunRequest {
     std::optional<std::map<std::string, std::string>> metadata;
     
     std::string to_json() const;
+    void write_json(JsonWriter& json) const;
 };
 
 // Modify run request
@@ -75,12 +77,15 @@ struct ModifyRunRequest {
     std::optional<std::map<std::string, std::string>> metadata;
     
     std::string to_json() const;
+    void write_json(JsonWriter& json) const;
 };
 
 // Tool output for submit
 struct ToolOutput {
     std::string tool_call_id;
     std::string output;
+    
+    void write_json(JsonWriter& json) const;
 };
 
 // Submit tool outputs request
@@ -88,6 +93,7 @@ struct SubmitToolOutputsRequest {
     std::vector<ToolOutput> tool_outputs;
     
     std::string to_json() const;
+    void write_json(JsonWriter& json) const;
 };
 
 // Run list response
@@ -112,8 +118,8 @@ struct RunStep {
     std::optional<std::int64_t> completed_at;
     std::optional<std::int64_t> cancelled_at;
     std::optional<std::int64_t> failed_at;
-    std::optional<std::string> last_error;
-    std::map<std::string, std::string> step_details;
+    std::optional<std::string> last_error;            // Raw JSON object
+    std::map<std::string, std::string> step_details;  // Nested objects as raw JSON
 };
 
 // Run step list response
@@ -125,6 +131,12 @@ struct RunStepListResponse {
     bool has_more{false};
 };
 
+// JSON decoding
+void read_json(JsonReader& reader, Run& out);
+void read_json(JsonReader& reader, RunListResponse& out);
+void read_json(JsonReader& reader, RunStep& out);
+void read_json(JsonReader& reader, RunStepListResponse& out);
+
 } // namespace openai
 
 // ============================================================================
@@ -135,41 +147,155 @@ namespace openai {
 
 // CreateRunRequest::to_json implementation
 std::string CreateRunRequest::to_json() const {
-    std::ostringstream json;
-    json << "{";
-    json << "\"assistant_id\":\"" << assistant_id << "\"";
-    
-    if (model) {
-        json << ",\"model\":\"" << *model << "\"";
-    }
-    if (instructions) {
-        json << ",\"instructions\":\"" << *instructions << "\"";
-    }
-    
-    json << "}";
-    return json.str();
+    return to_json_string(*this);
+}
+
+// CreateRunRequest::write_json implementation
+void CreateRunRequest::write_json(JsonWriter& json) const {
+    json.begin_object();
+    json.field("assistant_id", assistant_id);
+    json.field("model", model);
+    json.field("instructions", instructions);
+    json.field("tools", tools);
+    json.field("metadata", metadata);
+    json.end_object();
 }
 
 // ModifyRunRequest::to_json implementation
 std::string ModifyRunRequest::to_json() const {
-    return "{}";  // Empty object for now
+    return to_json_string(*this);
+}
+
+// ModifyRunRequest::write_json implementation
+void ModifyRunRequest::write_json(JsonWriter& json) const {
+    json.begin_object();
+    json.field("metadata", metadata);
+    json.end_object();
+}
+
+// ToolOutput::write_json implementation
+void ToolOutput::write_json(JsonWriter& json) const {
+    json.begin_object();
+    json.field("tool_call_id", tool_call_id);
+    json.field("output", output);
+    json.end_object();
 }
 
 // SubmitToolOutputsRequest::to_json implementation
 std::string SubmitToolOutputsRequest::to_json() const {
-    std::ostringstream json;
-    json << "{\"tool_outputs\":[";
-    
-    for (std::size_t i = 0; i < tool_outputs.size(); ++i) {
-        if (i > 0) json << ",";
-        json << "{";
-        json << "\"tool_call_id\":\"" << tool_outputs[i].tool_call_id << "\",";
-        json << "\"output\":\"" << tool_outputs[i].output << "\"";
-        json << "}";
+    return to_json_string(*this);
+}
+
+// SubmitToolOutputsRequest::write_json implementation
+void SubmitToolOutputsRequest::write_json(JsonWriter& json) const {
+    json.begin_object();
+    json.field("tool_outputs", tool_outputs);
+    json.end_object();
+}
+
+
+// ============================================================================
+// JSON Decoding
+// ============================================================================
+
+namespace {
+
+// Object-valued fields kept as raw JSON
+void read_raw(JsonReader& reader, std::optional<std::string>& out) {
+    if (reader.null()) {
+        out.reset();
+    } else {
+        out = std::string(reader.raw());
     }
-    
-    json << "]}";
-    return json.str();
 }
 
-} // namespace openai
\ No newline at end of file
+} // namespace
+
+void read_json(JsonReader& reader, Run& out) {
+    reader.object([&](std::string_view key) {
+        if (key == "id") {
+            reader.read(out.id);
+        } else if (key == "object") {
+            reader.read(out.object);
+        } else if (key == "created_at") {
+            reader.read(out.created_at);
+        } else if (key == "thread_id") {
+            reader.read(out.thread_id);
+        } else if (key == "assistant_id") {
+            reader.read(out.assistant_id);
+        } else if (key == "status") {
+            std::string status;
+            reader.read(status);
+            out.status = string_to_run_status(status);
+        } else if (key == "required_action") {
+            read_raw(reader, out.required_action);
+        } else if (key == "last_error") {
+            read_raw(reader, out.last_error);
+        } else if (key == "expires_at") {
+            reader.read(out.expires_at);
+        } else if (key == "started_at") {
+            reader.read(out.started_at);
+        } else if (key == "cancelled_at") {
+            reader.read(out.cancelled_at);
+        } else if (key == "failed_at") {
+            reader.read(out.failed_at);
+        } else if (key == "completed_at") {
+            reader.read(out.completed_at);
+        } else if (key == "model") {
+            reader.read(out.model);
+        } else if (key == "instructions") {
+            reader.read(out.instructions);
+        } else if (key == "tools") {
+            reader.read(out.tools);
+        } else if (key == "file_ids") {
+            reader.read(out.file_ids);
+        } else if (key == "metadata") {
+            reader.read(out.metadata);
+        } else {
+            reader.skip();
+        }
+    });
+}
+
+void read_json(JsonReader& reader, RunListResponse& out) {
+    reader.object([&](std::string_view key) {
+        if (key == "object") reader.read(out.object);
+        else if (key == "data") reader.read(out.data);
+        else if (key == "first_id") reader.read(out.first_id);
+        else if (key == "last_id") reader.read(out.last_id);
+        else if (key == "has_more") reader.read(out.has_more);
+        else reader.skip();
+    });
+}
+
+void read_json(JsonReader& reader, RunStep& out) {
+    reader.object([&](std::string_view key) {
+        if (key == "id") reader.read(out.id);
+        else if (key == "object") reader.read(out.object);
+        else if (key == "created_at") reader.read(out.created_at);
+        else if (key == "run_id") reader.read(out.run_id);
+        else if (key == "assistant_id") reader.read(out.assistant_id);
+        else if (key == "thread_id") reader.read(out.thread_id);
+        else if (key == "type") reader.read(out.type);
+        else if (key == "status") reader.read(out.status);
+        else if (key == "completed_at") reader.read(out.completed_at);
+        else if (key == "cancelled_at") reader.read(out.cancelled_at);
+        else if (key == "failed_at") reader.read(out.failed_at);
+        else if (key == "last_error") read_raw(reader, out.last_error);
+        else if (key == "step_details") reader.read(out.step_details);
+        else reader.skip();
+    });
+}
+
+void read_json(JsonReader& reader, RunStepListResponse& out) {
+    reader.object([&](std::string_view key) {
+        if (key == "object") reader.read(out.object);
+        else if (key == "data") reader.read(out.data);
+        else if (key == "first_id") reader.read(out.first_id);
+        else if (key == "last_id") reader.read(out.last_id);
+        else if (key == "has_more") reader.read(out.has_more);
+        else reader.skip();
+    });
+}
+
+} // namespace openai
@@ -4,6 +4,7 @@
 export module openai.types.thread;
 
 import std;
+import openai.types.json;
 
 export namespace openai {
 
@@ -17,6 +18,11 @@ enum class ThreadMessageRole {
     Assistant
 };
 
+// Helper function to convert ThreadMessageRole to string
+inline std::string_view to_string(ThreadMessageRole role) {
+    return role == ThreadMessageRole::Assistant ? "assistant" : "user";
+}
+
 // Helper function to convert string to ThreadMessageRole
 inline ThreadMessageRole string_to_thread_message_role(const std::string& role_str) {
     if (role_str == "assistant") {
@@ -29,6 +35,8 @@ inline ThreadMessageRole string_to_thread_message_role(const std::string& role_s
 struct MessageContent {
     std::string type{"text"};
     std::string text;
+    
+    void write_json(JsonWriter& json) const;
 };
 
 // Thread message
@@ -37,12 +45,15 @@ struct ThreadMessage {
     std::string object{"thread.message"};
     std::int64_t created_at{0};
     std::string thread_id;
-    ThreadMessageRole role;
+    ThreadMessageRole role{ThreadMessageRole::User};
     std::vector<MessageContent> content;
     std::vector<std::string> file_ids;
     std::optional<std::string> assistant_id;
     std::optional<std::string> run_id;
     std::map<std::string, std::string> metadata;
+    
+    // Serialized as a message to create (role, content, file_ids, metadata)
+    void write_json(JsonWriter& json) const;
 };
 
 // Thread object
@@ -59,6 +70,7 @@ struct CreateThreadRequest {
     std::optional<std::map<std::string, std::string>> metadata;
     
     std::string to_json() const;
+    void write_json(JsonWriter& json) const;
 };
 
 // Create message request
@@ -69,6 +81,7 @@ struct CreateMessageRequest {
     std::optional<std::map<std::string, std::string>> metadata;
     
     std::string to_json() const;
+    void write_json(JsonWriter& json) const;
 };
 
 // Modify thread request
@@ -76,6 +89,7 @@ struct ModifyThreadRequest {
     std::optional<std::map<std::string, std::string>> metadata;
     
     std::string to_json() const;
+    void write_json(JsonWriter& json) const;
 };
 
 // Modify message request
@@ -83,6 +97,7 @@ struct ModifyMessageRequest {
     std::optional<std::map<std::string, std::string>> metadata;
     
     std::string to_json() const;
+    void write_json(JsonWriter& json) const;
 };
 
 // Thread message list response
@@ -101,6 +116,13 @@ struct DeleteThreadResponse {
     bool deleted{false};
 };
 
+// JSON decoding
+void read_json(JsonReader& reader, MessageContent& out);
+void read_json(JsonReader& reader, ThreadMessage& out);
+void read_json(JsonReader& reader, Thread& out);
+void read_json(JsonReader& reader, ThreadMessageListResponse& out);
+void read_json(JsonReader& reader, DeleteThreadResponse& out);
+
 } // namespace openai
 
 // ============================================================================
@@ -109,30 +131,163 @@ struct DeleteThreadResponse {
 
 namespace openai {
 
+// MessageContent::write_json implementation
+void MessageContent::write_json(JsonWriter& json) const {
+    json.begin_object();
+    json.field("type", type);
+    json.field("text", text);
+    json.end_object();
+}
+
+// ThreadMessage::write_json implementation
+void ThreadMessage::write_json(JsonWriter& json) const {
+    json.begin_object();
+    json.field("role", to_string(role));
+    json.field("content", content);
+    if (!file_ids.empty()) {
+        json.field("file_ids", file_ids);
+    }
+    if (!metadata.empty()) {
+        json.field("metadata", metadata);
+    }
+    json.end_object();
+}
+
 // CreateThreadRequest::to_json implementation
 std::string CreateThreadRequest::to_json() const {
-    return "{}";  // Empty object for now
+    return to_json_string(*this);
+}
+
+// CreateThreadRequest::write_json implementation
+void CreateThreadRequest::write_json(JsonWriter& json) const {
+    json.begin_object();
+    json.field("messages", messages);
+    json.field("metadata", metadata);
+    json.end_object();
 }
 
 // CreateMessageRequest::to_json implementation
 std::string CreateMessageRequest::to_json() const {
-    std::ostringstream json;
-    json << "{";
-    json << "\"role\":\"" << (role == ThreadMessageRole::User ? "user" : "assistant") << "\",";
-    json << "\"content\":\"" << content << "\"";
-    json << "}";
-    return json.str();
+    return to_json_string(*this);
+}
+
+// CreateMessageRequest::write_json implementation
+void CreateMessageRequest::write_json(JsonWriter& json) const {
+    json.begin_object();
+    json.field("role", to_string(role));
+    json.field("content", content);
+    json.field("file_ids", file_ids);
+    json.field("metadata", metadata);
+    json.end_object();
 }
 
 // ModifyThreadRequest::to_json implementation
 std::string ModifyThreadRequest::to_json() const {
-    return "{}";  // Empty object for now
+    return to_json_string(*this);
+}
+
+// ModifyThreadRequest::write_json implementation
+void ModifyThreadRequest::write_json(JsonWriter& json) const {
+    json.begin_object();
+    json.field("metadata", metadata);
+    json.end_object();
 }
 
 // ModifyMessageRequest::to_json implementation
 std::string ModifyMessageRequest::to_json() const {
-    return "{}";  // Empty object for now
+    return to_json_string(*this);
+}
+
+// ModifyMessageRequest::write_json implementation
+void ModifyMessageRequest::write_json(JsonWriter& json) const {
+    json.begin_object();
+    json.field("metadata", metadata);
+    json.end_object();
 }
 
-} // namespace openai
 
+// ============================================================================
+// JSON Decoding
+// ============================================================================
+
+void read_json(JsonReader& reader, MessageContent& out) {
+    reader.object([&](std::string_view key) {
+        if (key == "type") {
+            reader.read(out.type);
+        } else if (key == "text") {
+            // {"value": "...", "annotations": [...]}
+            if (reader.peek() == JsonType::Object) {
+                reader.object([&](std::string_view field) {
+                    if (field == "value") reader.read(out.text);
+                    else reader.skip();
+                });
+            } else {
+                reader.read(out.text);
+            }
+        } else {
+            reader.skip();
+        }
+    });
+}
+
+void read_json(JsonReader& reader, ThreadMessage& out) {
+    reader.object([&](std::string_view key) {
+        if (key == "id") {
+            reader.read(out.id);
+        } else if (key == "object") {
+            reader.read(out.object);
+        } else if (key == "created_at") {
+            reader.read(out.created_at);
+        } else if (key == "thread_id") {
+            reader.read(out.thread_id);
+        } else if (key == "role") {
+            std::string role;
+            reader.read(role);
+            out.role = string_to_thread_message_role(role);
+        } else if (key == "content") {
+            reader.read(out.content);
+        } else if (key == "file_ids") {
+            reader.read(out.file_ids);
+        } else if (key == "assistant_id") {
+            reader.read(out.assistant_id);
+        } else if (key == "run_id") {
+            reader.read(out.run_id);
+        } else if (key == "metadata") {
+            reader.read(out.metadata);
+        } else {
+            reader.skip();
+        }
+    });
+}
+
+void read_json(JsonReader& reader, Thread& out) {
+    reader.object([&](std::string_view key) {
+        if (key == "id") reader.read(out.id);
+        else if (key == "object") reader.read(out.object);
+        else if (key == "created_at") reader.read(out.created_at);
+        else if (key == "metadata") reader.read(out.metadata);
+        else reader.skip();
+    });
+}
+
+void read_json(JsonReader& reader, ThreadMessageListResponse& out) {
+    reader.object([&](std::string_view key) {
+        if (key == "object") reader.read(out.object);
+        else if (key == "data") reader.read(out.data);
+        else if (key == "first_id") reader.read(out.first_id);
+        else if (key == "last_id") reader.read(out.last_id);
+        else if (key == "has_more") reader.read(out.has_more);
+        else reader.skip();
+    });
+}
+
+void read_json(JsonReader& reader, DeleteThreadResponse& out) {
+    reader.object([&](std::string_view key) {
+        if (key == "id") reader.read(out.id);
+        else if (key == "object") reader.read(out.object);
+        else if (key == "deleted") reader.read(out.deleted);
+        else reader.skip();
+    });
+}
+
+} // namespace openai
@@ -0,0 +1,1233 @@
+// HTTP/2 Module - Implementation
+
+module openai.http2;
+
+import asio;
+import fmt;
+import std;
+
+namespace openai::http2 {
+
+namespace {
+
+// Frame types (RFC 9113 section 6)
+constexpr std::uint8_t frame_data = 0x0;
+constexpr std::uint8_t frame_headers = 0x1;
+constexpr std::uint8_t frame_priority = 0x2;
+constexpr std::uint8_t frame_rst_stream = 0x3;
+constexpr std::uint8_t frame_settings = 0x4;
+constexpr std::uint8_t frame_push_promise = 0x5;
+constexpr std::uint8_t frame_ping = 0x6;
+constexpr std::uint8_t frame_goaway = 0x7;
+constexpr std::uint8_t frame_window_update = 0x8;
+constexpr std::uint8_t frame_continuation = 0x9;
+
+// Frame flags
+constexpr std::uint8_t flag_end_stream = 0x1;
+constexpr std::uint8_t flag_ack = 0x1;
+constexpr std::uint8_t flag_end_headers = 0x4;
+constexpr std::uint8_t flag_padded = 0x8;
+constexpr std::uint8_t flag_priority = 0x20;
+
+// Error codes (RFC 9113 section 7)
+constexpr std::uint32_t error_none = 0x0;
+constexpr std::uint32_t error_protocol = 0x1;
+constexpr std::uint32_t error_flow_control = 0x3;
+constexpr std::uint32_t error_frame_size = 0x6;
+constexpr std::uint32_t error_refused_stream = 0x7;
+constexpr std::uint32_t error_cancel = 0x8;
+constexpr std::uint32_t error_compression = 0x9;
+
+// Settings identifiers
+constexpr std::uint16_t setting_header_table_size = 0x1;
+constexpr std::uint16_t setting_enable_push = 0x2;
+constexpr std::uint16_t setting_max_concurrent_streams = 0x3;
+constexpr std::uint16_t setting_initial_window_size = 0x4;
+constexpr std::uint16_t setting_max_frame_size = 0x5;
+constexpr std::uint16_t setting_max_header_list_size = 0x6;
+
+constexpr std::uint32_t max_window_size = 0x7fffffff;
+constexpr std::uint32_t default_window_size = 65535;
+constexpr std::size_t frame_header_size = 9;
+constexpr std::size_t body_piece_size = 64 * 1024;  // Pulled from a body source at a time
+constexpr std::string_view connection_preface = "PRI * HTTP/2.0\r\n\r\nSM\r\n\r\n";
+
+// Connection error: reported to the peer with GOAWAY, then the connection is closed
+struct ProtocolError : std::runtime_error {
+    ProtocolError(std::uint32_t error_code, const std::string& message)
+        : std::runtime_error(message), code(error_code) {}
+
+    std::uint32_t code;
+};
+
+void put_u16(std::string& out, std::uint16_t value) {
+    out.push_back(static_cast<char>(value >> 8));
+    out.push_back(static_cast<char>(value));
+}
+
+void put_u32(std::string& out, std::uint32_t value) {
+    out.push_back(static_cast<char>(value >> 24));
+    out.push_back(static_cast<char>(value >> 16));
+    out.push_back(static_cast<char>(value >> 8));
+    out.push_back(static_cast<char>(value));
+}
+
+std::uint32_t get_u32(std::string_view data, std::size_t offset) {
+    auto byte = [&](std::size_t i) { return static_cast<std::uint32_t>(static_cast<unsigned char>(data[offset + i])); };
+    return (byte(0) << 24) | (byte(1) << 16) | (byte(2) << 8) | byte(3);
+}
+
+std::string window_update_payload(std::uint32_t increment) {
+    std::string payload;
+    put_u32(payload, increment);
+    return payload;
+}
+
+std::string rst_stream_payload(std::uint32_t error_code) {
+    std::string payload;
+    put_u32(payload, error_code);
+    return payload;
+}
+
+// Remove the pad length byte and trailing padding of a PADDED frame
+std::string_view strip_padding(std::uint8_t flags, std::string_view payload) {
+    if (!(flags & flag_padded)) {
+        return payload;
+    }
+    if (payload.empty()) {
+        throw ProtocolError(error_protocol, "padded frame without pad length");
+    }
+    const std::size_t pad = static_cast<unsigned char>(payload[0]);
+    if (pad >= payload.size()) {
+        throw ProtocolError(error_protocol, "padding exceeds frame payload");
+    }
+    return payload.substr(1, payload.size() - 1 - pad);
+}
+
+// ----------------------------------------------------------------------------
+// HPACK primitives
+// ----------------------------------------------------------------------------
+
+const std::array<Header, 61>& static_table() {
+    static const std::array<Header, 61> table{{
+        {":authority", ""},
+        {":method", "GET"},
+        {":method", "POST"},
+        {":path", "/"},
+        {":path", "/index.html"},
+        {":scheme", "http"},
+        {":scheme", "https"},
+        {":status", "200"},
+        {":status", "204"},
+        {":status", "206"},
+        {":status", "304"},
+        {":status", "400"},
+        {":status", "404"},
+        {":status", "500"},
+        {"accept-charset", ""},
+        {"accept-encoding", "gzip, deflate"},
+        {"accept-language", ""},
+        {"accept-ranges", ""},
+        {"accept", ""},
+        {"access-control-allow-origin", ""},
+        {"age", ""},
+        {"allow", ""},
+        {"authorization", ""},
+        {"cache-control", ""},
+        {"content-disposition", ""},
+        {"content-encoding", ""},
+        {"content-language", ""},
+        {"content-length", ""},
+        {"content-location", ""},
+        {"content-range", ""},
+        {"content-type", ""},
+        {"cookie", ""},
+        {"date", ""},
+        {"etag", ""},
+        {"expect", ""},
+        {"expires", ""},
+        {"from", ""},
+        {"host", ""},
+        {"if-match", ""},
+        {"if-modified-since", ""},
+        {"if-none-match", ""},
+        {"if-range", ""},
+        {"if-unmodified-since", ""},
+        {"last-modified", ""},
+        {"link", ""},
+        {"location", ""},
+        {"max-forwards", ""},
+        {"proxy-authenticate", ""},
+        {"proxy-authorization", ""},
+        {"range", ""},
+        {"referer", ""},
+        {"refresh", ""},
+        {"retry-after", ""},
+        {"server", ""},
+        {"set-cookie", ""},
+        {"strict-transport-security", ""},
+        {"transfer-encoding", ""},
+        {"user-agent", ""},
+        {"vary", ""},
+        {"via", ""},
+        {"www-authenticate", ""},
+    }};
+    return table;
+}
+
+struct HuffmanCode {
+    std::uint32_t code;
+    std::uint8_t length;
+};
+
+// RFC 7541 Appendix B, symbols 0-255 (EOS is 0x3fffffff, 30 bits)
+constexpr std::array<HuffmanCode, 256> huffman_codes{{
+    {0x1ff8, 13}, {0x7fffd8, 23}, {0xfffffe2, 28}, {0xfffffe3, 28}, {0xfffffe4, 28}, {0xfffffe5, 28}, {0xfffffe6, 28}, {0xfffffe7, 28},
+    {0xfffffe8, 28}, {0xffffea, 24}, {0x3ffffffc, 30}, {0xfffffe9, 28}, {0xfffffea, 28}, {0x3ffffffd, 30}, {0xfffffeb, 28}, {0xfffffec, 28},
+    {0xfffffed, 28}, {0xfffffee, 28}, {0xfffffef, 28}, {0xffffff0, 28}, {0xffffff1, 28}, {0xffffff2, 28}, {0x3ffffffe, 30}, {0xffffff3, 28},
+    {0xffffff4, 28}, {0xffffff5, 28}, {0xffffff6, 28}, {0xffffff7, 28}, {0xffffff8, 28}, {0xffffff9, 28}, {0xffffffa, 28}, {0xffffffb, 28},
+    {0x14, 6}, {0x3f8, 10}, {0x3f9, 10}, {0xffa, 12}, {0x1ff9, 13}, {0x15, 6}, {0xf8, 8}, {0x7fa, 11},
+    {0x3fa, 10}, {0x3fb, 10}, {0xf9, 8}, {0x7fb, 11}, {0xfa, 8}, {0x16, 6}, {0x17, 6}, {0x18, 6},
+    {0x0, 5}, {0x1, 5}, {0x2, 5}, {0x19, 6}, {0x1a, 6}, {0x1b, 6}, {0x1c, 6}, {0x1d, 6},
+    {0x1e, 6}, {0x1f, 6}, {0x5c, 7}, {0xfb, 8}, {0x7ffc, 15}, {0x20, 6}, {0xffb, 12}, {0x3fc, 10},
+    {0x1ffa, 13}, {0x21, 6}, {0x5d, 7}, {0x5e, 7}, {0x5f, 7}, {0x60, 7}, {0x61, 7}, {0x62, 7},
+    {0x63, 7}, {0x64, 7}, {0x65, 7}, {0x66, 7}, {0x67, 7}, {0x68, 7}, {0x69, 7}, {0x6a, 7},
+    {0x6b, 7}, {0x6c, 7}, {0x6d, 7}, {0x6e, 7}, {0x6f, 7}, {0x70, 7}, {0x71, 7}, {0x72, 7},
+    {0xfc, 8}, {0x73, 7}, {0xfd, 8}, {0x1ffb, 13}, {0x7fff0, 19}, {0x1ffc, 13}, {0x3ffc, 14}, {0x22, 6},
+    {0x7ffd, 15}, {0x3, 5}, {0x23, 6}, {0x4, 5}, {0x24, 6}, {0x5, 5}, {0x25, 6}, {0x26, 6},
+    {0x27, 6}, {0x6, 5}, {0x74, 7}, {0x75, 7}, {0x28, 6}, {0x29, 6}, {0x2a, 6}, {0x7, 5},
+    {0x2b, 6}, {0x76, 7}, {0x2c, 6}, {0x8, 5}, {0x9, 5}, {0x2d, 6}, {0x77, 7}, {0x78, 7},
+    {0x79, 7}, {0x7a, 7}, {0x7b, 7}, {0x7ffe, 15}, {0x7fc, 11}, {0x3ffd, 14}, {0x1ffd, 13}, {0xffffffc, 28},
+    {0xfffe6, 20}, {0x3fffd2, 22}, {0xfffe7, 20}, {0xfffe8, 20}, {0x3fffd3, 22}, {0x3fffd4, 22}, {0x3fffd5, 22}, {0x7fffd9, 23},
+    {0x3fffd6, 22}, {0x7fffda, 23}, {0x7fffdb, 23}, {0x7fffdc, 23}, {0x7fffdd, 23}, {0x7fffde, 23}, {0xffffeb, 24}, {0x7fffdf, 23},
+    {0xffffec, 24}, {0xffffed, 24}, {0x3fffd7, 22}, {0x7fffe0, 23}, {0xffffee, 24}, {0x7fffe1, 23}, {0x7fffe2, 23}, {0x7fffe3, 23},
+    {0x7fffe4, 23}, {0x1fffdc, 21}, {0x3fffd8, 22}, {0x7fffe5, 23}, {0x3fffd9, 22}, {0x7fffe6, 23}, {0x7fffe7, 23}, {0xffffef, 24},
+    {0x3fffda, 22}, {0x1fffdd, 21}, {0xfffe9, 20}, {0x3fffdb, 22}, {0x3fffdc, 22}, {0x7fffe8, 23}, {0x7fffe9, 23}, {0x1fffde, 21},
+    {0x7fffea, 23}, {0x3fffdd, 22}, {0x3fffde, 22}, {0xfffff0, 24}, {0x1fffdf, 21}, {0x3fffdf, 22}, {0x7fffeb, 23}, {0x7fffec, 23},
+    {0x1fffe0, 21}, {0x1fffe1, 21}, {0x3fffe0, 22}, {0x1fffe2, 21}, {0x7fffed, 23}, {0x3fffe1, 22}, {0x7fffee, 23}, {0x7fffef, 23},
+    {0xfffea, 20}, {0x3fffe2, 22}, {0x3fffe3, 22}, {0x3fffe4, 22}, {0x7ffff0, 23}, {0x3fffe5, 22}, {0x3fffe6, 22}, {0x7ffff1, 23},
+    {0x3ffffe0, 26}, {0x3ffffe1, 26}, {0xfffeb, 20}, {0x7fff1, 19}, {0x3fffe7, 22}, {0x7ffff2, 23}, {0x3fffe8, 22}, {0x1ffffec, 25},
+    {0x3ffffe2, 26}, {0x3ffffe3, 26}, {0x3ffffe4, 26}, {0x7ffffde, 27}, {0x7ffffdf, 27}, {0x3ffffe5, 26}, {0xfffff1, 24}, {0x1ffffed, 25},
+    {0x7fff2, 19}, {0x1fffe3, 21}, {0x3ffffe6, 26}, {0x7ffffe0, 27}, {0x7ffffe1, 27}, {0x3ffffe7, 26}, {0x7ffffe2, 27}, {0xfffff2, 24},
+    {0x1fffe4, 21}, {0x1fffe5, 21}, {0x3ffffe8, 26}, {0x3ffffe9, 26}, {0xffffffd, 28}, {0x7ffffe3, 27}, {0x7ffffe4, 27}, {0x7ffffe5, 27},
+    {0xfffec, 20}, {0xfffff3, 24}, {0xfffed, 20}, {0x1fffe6, 21}, {0x3fffe9, 22}, {0x1fffe7, 21}, {0x1fffe8, 21}, {0x7ffff3, 23},
+    {0x3fffea, 22}, {0x3fffeb, 22}, {0x1ffffee, 25}, {0x1ffffef, 25}, {0xfffff4, 24}, {0xfffff5, 24}, {0x3ffffea, 26}, {0x7ffff4, 23},
+    {0x3ffffeb, 26}, {0x7ffffe6, 27}, {0x3ffffec, 26}, {0x3ffffed, 26}, {0x7ffffe7, 27}, {0x7ffffe8, 27}, {0x7ffffe9, 27}, {0x7ffffea, 27},
+    {0x7ffffeb, 27}, {0xffffffe, 28}, {0x7ffffec, 27}, {0x7ffffed, 27}, {0x7ffffee, 27}, {0x7ffffef, 27}, {0x7fffff0, 27}, {0x3ffffee, 26},
+}};
+
+// The HPACK code is canonical, so decoding only needs the first code and the
+// symbol run of each code length
+struct HuffmanDecodeTable {
+    std::array<std::uint32_t, 31> first_code{};
+    std::array<std::uint16_t, 31> count{};
+    std::array<std::uint16_t, 31> offset{};
+    std::array<std::uint16_t, 257> symbols{};
+
+    HuffmanDecodeTable() {
+        std::array<std::uint8_t, 257> lengths{};
+        for (std::size_t i = 0; i < 256; ++i) {
+            lengths[i] = huffman_codes[i].length;
+        }
+        lengths[256] = 30;
+
+        for (auto length : lengths) {
+            ++count[length];
+        }
+        std::uint32_t code = 0;
+        std::uint16_t index = 0;
+        for (std::size_t length = 1; length <= 30; ++length) {
+            first_code[length] = code;
+            offset[length] = index;
+            index = static_cast<std::uint16_t>(index + count[length]);
+            code = (code + count[length]) << 1;
+        }
+
+        auto next = offset;
+        for (std::uint16_t symbol = 0; symbol <= 256; ++symbol) {
+            symbols[next[lengths[symbol]]++] = symbol;
+        }
+    }
+};
+
+const HuffmanDecodeTable& huffman_decode_table() {
+    static const HuffmanDecodeTable table;
+    return table;
+}
+
+void encode_integer(std::string& out, std::uint8_t flags, int prefix_bits, std::uint64_t value) {
+    const std::uint64_t max_prefix = (1u << prefix_bits) - 1;
+    if (value < max_prefix) {
+        out.push_back(static_cast<char>(flags | value));
+        return;
+    }
+    out.push_back(static_cast<char>(flags | max_prefix));
+    value -= max_prefix;
+    while (value >= 0x80) {
+        out.push_back(static_cast<char>((value & 0x7f) | 0x80));
+        value >>= 7;
+    }
+    out.push_back(static_cast<char>(value));
+}
+
+std::uint64_t decode_integer(std::string_view& in, int prefix_bits) {
+    if (in.empty()) {
+        throw std::runtime_error("HPACK: truncated integer");
+    }
+    const std::uint64_t max_prefix = (1u << prefix_bits) - 1;
+    std::uint64_t value = static_cast<unsigned char>(in[0]) & max_prefix;
+    in.remove_prefix(1);
+    if (value < max_prefix) {
+        return value;
+    }
+    for (int shift = 0; ; shift += 7) {
+        if (in.empty()) {
+            throw std::runtime_error("HPACK: truncated integer");
+        }
+        if (shift > 28) {
+            throw std::runtime_error("HPACK: integer overflow");
+        }
+        const auto byte = static_cast<unsigned char>(in[0]);
+        in.remove_prefix(1);
+        value += static_cast<std::uint64_t>(byte & 0x7f) << shift;
+        if (!(byte & 0x80)) {
+            return value;
+        }
+    }
+}
+
+void encode_string(std::string& out, std::string_view value) {
+    const auto huffman_size = huffman_encoded_size(value);
+    if (huffman_size < value.size()) {
+        encode_integer(out, 0x80, 7, huffman_size);
+        huffman_encode(value, out);
+    } else {
+        encode_integer(out, 0x00, 7, value.size());
+        out.append(value);
+    }
+}
+
+std::string decode_string(std::string_view& in) {
+    if (in.empty()) {
+        throw std::runtime_error("HPACK: truncated string");
+    }
+    const bool huffman = static_cast<unsigned char>(in[0]) & 0x80;
+    const auto length = decode_integer(in, 7);
+    if (length > in.size()) {
+        throw std::runtime_error("HPACK: truncated string");
+    }
+    auto data = in.substr(0, length);
+    in.remove_prefix(length);
+    return huffman ? huffman_decode(data) : std::string(data);
+}
+
+std::size_t entry_size(std::string_view name, std::string_view value) {
+    return name.size() + value.size() + 32;
+}
+
+// Headers never added to the dynamic table: credentials, and values that
+// change on every request and would only churn the table
+bool is_sensitive(std::string_view name) {
+    return name == "authorization" || name == "proxy-authorization" || name == "cookie";
+}
+
+bool is_volatile(std::string_view name) {
+    return name == ":path" || name == "content-length" || name == "idempotency-key";
+}
+
+} // namespace
+
+// ============================================================================
+// Huffman coding
+// ============================================================================
+
+std::size_t huffman_encoded_size(std::string_view input) {
+    std::size_t bits = 0;
+    for (unsigned char c : input) {
+        bits += huffman_codes[c].length;
+    }
+    return (bits + 7) / 8;
+}
+
+void huffman_encode(std::string_view input, std::string& out) {
+    std::uint64_t buffer = 0;
+    int pending = 0;
+    for (unsigned char c : input) {
+        const auto& code = huffman_codes[c];
+        buffer = (buffer << code.length) | code.code;
+        pending += code.length;
+        while (pending >= 8) {
+            pending -= 8;
+            out.push_back(static_cast<char>(buffer >> pending));
+        }
+        buffer &= (std::uint64_t{1} << pending) - 1;
+    }
+    if (pending > 0) {
+        // Pad with the most significant bits of EOS (all ones)
+        out.push_back(static_cast<char>((buffer << (8 - pending)) | (0xff >> pending)));
+    }
+}
+
+std::string huffman_decode(std::string_view input) {
+    const auto& table = huffman_decode_table();
+    std::string out;
+    out.reserve(input.size() * 8 / 5);
+
+    std::uint64_t buffer = 0;
+    int pending = 0;
+    for (unsigned char c : input) {
+        buffer = (buffer << 8) | c;
+        pending += 8;
+
+        while (pending >= 5) {
+            bool matched = false;
+            for (int length = 5; length <= std::min(pending, 30); ++length) {
+                const auto code = static_cast<std::uint32_t>(buffer >> (pending - length)) & ((1u << length) - 1);
+                if (code - table.first_code[length] < table.count[length]) {
+                    const auto symbol = table.symbols[table.offset[length] + (code - table.first_code[length])];
+                    if (symbol == 256) {
+                        throw std::runtime_error("HPACK: EOS in Huffman string");
+                    }
+                    out.push_back(static_cast<char>(symbol));
+                    pending -= length;
+                    buffer &= (std::uint64_t{1} << pending) - 1;
+                    matched = true;
+                    break;
+                }
+            }
+            if (!matched) {
+                if (pending >= 30) {
+                    throw std::runtime_error("HPACK: invalid Huffman code");
+                }
+                break;
+            }
+        }
+    }
+
+    // At most 7 bits of padding, all ones
+    if (pending > 7 || buffer != (std::uint64_t{1} << pending) - 1) {
+        throw std::runtime_error("HPACK: invalid Huffman padding");
+    }
+    return out;
+}
+
+// ============================================================================
+// HeaderTable
+// ============================================================================
+
+const Header* HeaderTable::at(std::size_t index) const {
+    const auto& fixed = static_table();
+    if (index >= 1 && index <= fixed.size()) {
+        return &fixed[index - 1];
+    }
+    const auto dynamic_index = index - fixed.size() - 1;
+    if (index > fixed.size() && dynamic_index < entries_.size()) {
+        return &entries_[dynamic_index];
+    }
+    return nullptr;
+}
+
+std::pair<std::size_t, std::size_t> HeaderTable::find(std::string_view name, std::string_view value) const {
+    const auto& fixed = static_table();
+    std::size_t name_index = 0;
+
+    for (std::size_t i = 0; i < fixed.size(); ++i) {
+        if (fixed[i].name == name) {
+            if (fixed[i].value == value) {
+                return {i + 1, i + 1};
+            }
+            if (name_index == 0) {
+                name_index = i + 1;
+            }
+        }
+    }
+    for (std::size_t i = 0; i < entries_.size(); ++i) {
+        if (entries_[i].name == name) {
+            const auto index = fixed.size() + 1 + i;
+            if (entries_[i].value == value) {
+                return {index, index};
+            }
+            if (name_index == 0) {
+                name_index = index;
+            }
+        }
+    }
+    return {0, name_index};
+}
+
+void HeaderTable::insert(std::string name, std::string value) {
+    const auto size = entry_size(name, value);
+    if (size > max_size_) {
+        // An entry larger than the table empties it (RFC 7541 section 4.4)
+        entries_.clear();
+        size_ = 0;
+        return;
+    }
+    evict_to(max_size_ - size);
+    entries_.push_front(Header{std::move(name), std::move(value)});
+    size_ += size;
+}
+
+void HeaderTable::set_max_size(std::size_t max_size) {
+    max_size_ = max_size;
+    evict_to(max_size);
+}
+
+void HeaderTable::evict_to(std::size_t target) {
+    while (size_ > target && !entries_.empty()) {
+        size_ -= entry_size(entries_.back().name, entries_.back().value);
+        entries_.pop_back();
+    }
+}
+
+// ============================================================================
+// HpackEncoder
+// ============================================================================
+
+void HpackEncoder::set_max_table_size(std::size_t max_size) {
+    max_size = std::min<std::size_t>(max_size, 4096);
+    if (max_size != table_.max_size()) {
+        table_.set_max_size(max_size);
+        pending_size_update_ = max_size;
+    }
+}
+
+void HpackEncoder::encode(const std::vector<Header>& headers, std::string& out) {
+    if (pending_size_update_) {
+        encode_integer(out, 0x20, 5, *pending_size_update_);
+        pending_size_update_.reset();
+    }
+
+    for (const auto& header : headers) {
+        const auto [index, name_index] = table_.find(header.name, header.value);
+        const bool sensitive = is_sensitive(header.name);
+
+        if (index != 0 && !sensitive) {
+            encode_integer(out, 0x80, 7, index);
+            continue;
+        }
+
+        if (sensitive) {
+            // Literal never indexed
+            encode_integer(out, 0x10, 4, name_index);
+        } else if (is_volatile(header.name) || entry_size(header.name, header.value) > table_.max_size() / 2) {
+            // Literal without indexing
+            encode_integer(out, 0x00, 4, name_index);
+        } else {
+            // Literal with incremental indexing
+            encode_integer(out, 0x40, 6, name_index);
+            table_.insert(header.name, header.value);
+        }
+
+        if (name_index == 0) {
+            encode_string(out, header.name);
+        }
+        encode_string(out, header.value);
+    }
+}
+
+// ============================================================================
+// HpackDecoder
+// ============================================================================
+
+std::vector<Header> HpackDecoder::decode(std::string_view block) {
+    std::vector<Header> headers;
+    std::size_t list_size = 0;
+    auto add = [&](Header header) {
+        list_size += header.name.size() + header.value.size() + 32;
+        if (list_size > max_list_size_) {
+            throw std::length_error("HPACK: header list exceeds SETTINGS_MAX_HEADER_LIST_SIZE");
+        }
+        headers.push_back(std::move(header));
+    };
+
+    while (!block.empty()) {
+        const auto first = static_cast<unsigned char>(block[0]);
+
+        if (first & 0x80) {
+            // Indexed header field
+            const auto* entry = table_.at(decode_integer(block, 7));
+            if (!entry) {
+                throw std::runtime_error("HPACK: invalid table index");
+            }
+            add(*entry);
+            continue;
+        }
+
+        if ((first & 0xe0) == 0x20) {
+            // Dynamic table size update
+            const auto size = decode_integer(block, 5);
+            if (size > limit_) {
+                throw std::runtime_error("HPACK: table size update exceeds limit");
+            }
+            table_.set_max_size(size);
+            continue;
+        }
+
+        // Literal with incremental indexing (01), without indexing (0000) or never indexed (0001)
+        const bool indexing = first & 0x40;
+        const auto name_index = decode_integer(block, indexing ? 6 : 4);
+
+        Header header;
+        if (name_index != 0) {
+            const auto* entry = table_.at(name_index);
+            if (!entry) {
+                throw std::runtime_error("HPACK: invalid table index");
+            }
+            header.name = entry->name;
+        } else {
+            header.name = decode_string(block);
+        }
+        header.value = decode_string(block);
+
+        if (indexing) {
+            table_.insert(header.name, header.value);
+        }
+        add(std::move(header));
+    }
+
+    return headers;
+}
+
+// ============================================================================
+// Session
+// ============================================================================
+
+Session::Session(std::unique_ptr<tls_stream> stream, SessionOptions options)
+    : stream_(std::move(stream))
+    , options_(options)
+    , decoder_(4096, options.max_header_list_size)
+    , slot_signal_(stream_->get_executor(), std::chrono::steady_clock::time_point::max())
+    , read_buffer_(std::max<std::size_t>(options.max_frame_size + frame_header_size, 64 * 1024)) {
+}
+
+Session::~Session() {
+    std::error_code ec;
+    stream_->lowest_layer().close(ec);
+}
+
+void Session::start() {
+    outbox_.append(connection_preface);
+
+    std::string settings;
+    put_u16(settings, setting_enable_push);
+    put_u32(settings, 0);
+    put_u16(settings, setting_initial_window_size);
+    put_u32(settings, std::min(options_.stream_window_size, max_window_size));
+    put_u16(settings, setting_max_frame_size);
+    put_u32(settings, options_.max_frame_size);
+    put_u16(settings, setting_max_header_list_size);
+    put_u32(settings, options_.max_header_list_size);
+    queue_frame(frame_settings, 0, 0, settings);
+
+    // The connection window can only be raised with WINDOW_UPDATE
+    if (options_.connection_window_size > default_window_size) {
+        queue_frame(frame_window_update, 0, 0,
+                    window_update_payload(std::min(options_.connection_window_size, max_window_size) - default_window_size));
+    }
+
+    asio::co_spawn(
+        stream_->get_executor(),
+        [self = shared_from_this()]() { return self->read_loop(); },
+        asio::detached
+    );
+}
+
+bool Session::is_usable() const {
+    return !closed_ && !close_after_flush_ && !goaway_received_ && next_stream_id_ <= max_window_size;
+}
+
+void Session::close() {
+    if (closed_) {
+        return;
+    }
+    std::string goaway;
+    put_u32(goaway, 0);
+    put_u32(goaway, error_none);
+    queue_frame(frame_goaway, 0, 0, goaway);
+
+    closed_ = true;
+    close_after_flush_ = true;
+    fail_all("HTTP/2 session closed", false);
+    if (!writing_) {
+        shutdown_socket();
+    }
+}
+
+asio::awaitable<Response> Session::request(std::vector<Header> headers, std::string_view body,
+                                          std::function<void(std::string_view)> on_data,
+                                          std::function<void(std::uint32_t)> on_open,
+                                          std::function<std::string_view(std::size_t)> body_source,
+                                          std::function<void(const Response&)> on_headers) {
+    auto self = shared_from_this();
+
+    // Respect the peer's SETTINGS_MAX_CONCURRENT_STREAMS
+    while (is_usable() && streams_.size() >= peer_max_concurrent_streams_) {
+        std::error_code ec;
+        co_await slot_signal_.async_wait(asio::redirect_error(asio::use_awaitable, ec));
+    }
+    if (!is_usable()) {
+        throw StreamError("HTTP/2 session is no longer usable", true);
+    }
+
+    auto stream = std::make_shared<Stream>(stream_->get_executor());
+    stream->id = next_stream_id_;
+    stream->send_window = peer_initial_window_size_;
+    stream->on_data = std::move(on_data);
+    stream->on_headers = std::move(on_headers);
+    next_stream_id_ += 2;
+    streams_.emplace(stream->id, stream);
+
+    // Encoding and queueing happen without suspending, so header blocks reach
+    // the wire in HPACK state order and stream ids stay increasing
+    std::string block;
+    encoder_.encode(headers, block);
+
+    std::string_view remaining = block;
+    std::uint8_t type = frame_headers;
+    std::uint8_t flags = body.empty() && !body_source ? flag_end_stream : 0;
+    do {
+        const auto fragment = remaining.substr(0, peer_max_frame_size_);
+        remaining.remove_prefix(fragment.size());
+        queue_frame(type, static_cast<std::uint8_t>(flags | (remaining.empty() ? flag_end_headers : 0)), stream->id, fragment);
+        type = frame_continuation;
+        flags = 0;
+    } while (!remaining.empty());
+
+    if (on_open) {
+        on_open(stream->id);
+    }
+
+    try {
+        // Send the body as flow control windows allow
+        bool more = static_cast<bool>(body_source);
+        while ((!body.empty() || more) && !stream->finished) {
+            if (body.empty()) {
+                body = body_source(body_piece_size);
+                if (body.empty()) {
+                    more = false;
+                    queue_frame(frame_data, flag_end_stream, stream->id, {});
+                }
+                continue;
+            }
+            const auto window = std::min(stream->send_window, connection_send_window_);
+            if (window <= 0) {
+                std::error_code ec;
+                co_await stream->signal.async_wait(asio::redirect_error(asio::use_awaitable, ec));
+                continue;
+            }
+            const auto size = std::min({body.size(), static_cast<std::size_t>(window), static_cast<std::size_t>(peer_max_frame_size_)});
+            stream->send_window -= static_cast<std::int64_t>(size);
+            connection_send_window_ -= static_cast<std::int64_t>(size);
+            queue_frame(frame_data, size == body.size() && !more ? flag_end_stream : 0, stream->id, body.substr(0, size));
+            body.remove_prefix(size);
+        }
+
+        // The server may answer before reading the whole body
+        if ((!body.empty() || more) && stream->error.empty()) {
+            queue_frame(frame_rst_stream, 0, stream->id, rst_stream_payload(error_cancel));
+        }
+
+        while (!stream->finished) {
+            std::error_code ec;
+            co_await stream->signal.async_wait(asio::redirect_error(asio::use_awaitable, ec));
+        }
+    } catch (...) {
+        // The awaiting coroutine was cancelled or the body could not be read;
+        // tell the server and free the slot
+        if (!stream->finished && !closed_) {
+            queue_frame(frame_rst_stream, 0, stream->id, rst_stream_payload(error_cancel));
+        }
+        streams_.erase(stream->id);
+        slot_signal_.cancel();
+        throw;
+    }
+
+    streams_.erase(stream->id);
+    slot_signal_.cancel();
+    if (goaway_received_ && streams_.empty()) {
+        close();
+    }
+
+    if (!stream->error.empty()) {
+        throw StreamError(stream->error, stream->retryable);
+    }
+    co_return std::move(stream->response);
+}
+
+void Session::cancel(std::uint32_t stream_id, std::string reason) {
+    auto it = streams_.find(stream_id);
+    if (it == streams_.end() || it->second->finished) {
+        return;
+    }
+    if (!closed_) {
+        queue_frame(frame_rst_stream, 0, stream_id, rst_stream_payload(error_cancel));
+    }
+    finish_stream(*it->second, std::move(reason));
+}
+
+asio::awaitable<void> Session::fill(std::size_t count) {
+    if (read_end_ - read_begin_ >= count) {
+        co_return;
+    }
+    if (read_begin_ > 0) {
+        std::memmove(read_buffer_.data(), read_buffer_.data() + read_begin_, read_end_ - read_begin_);
+        read_end_ -= read_begin_;
+        read_begin_ = 0;
+    }
+    if (read_buffer_.size() < count) {
+        read_buffer_.resize(count);
+    }
+    while (read_end_ < count) {
+        read_end_ += co_await stream_->async_read_some(
+            asio::buffer(read_buffer_.data() + read_end_, read_buffer_.size() - read_end_),
+            asio::use_awaitable
+        );
+    }
+}
+
+asio::awaitable<void> Session::read_loop() {
+    try {
+        while (!closed_) {
+            co_await fill(frame_header_size);
+            const auto* header = reinterpret_cast<const unsigned char*>(read_buffer_.data() + read_begin_);
+            const std::size_t length = (std::size_t{header[0]} << 16) | (std::size_t{header[1]} << 8) | header[2];
+            const auto type = header[3];
+            const auto flags = header[4];
+            const auto stream_id = get_u32({read_buffer_.data() + read_begin_, frame_header_size}, 5) & max_window_size;
+
+            if (length > options_.max_frame_size) {
+                throw ProtocolError(error_frame_size, fmt::format("frame of {} bytes exceeds SETTINGS_MAX_FRAME_SIZE", length));
+            }
+
+            co_await fill(frame_header_size + length);
+            std::string_view payload(read_buffer_.data() + read_begin_ + frame_header_size, length);
+            read_begin_ += frame_header_size + length;
+
+            handle_frame(type, flags, stream_id, payload);
+        }
+    } catch (const ProtocolError& e) {
+        std::string goaway;
+        put_u32(goaway, 0);
+        put_u32(goaway, e.code);
+        queue_frame(frame_goaway, 0, 0, goaway);
+        close_after_flush_ = true;
+        closed_ = true;
+        fail_all(fmt::format("HTTP/2 protocol error: {}", e.what()), false);
+        co_return;
+    } catch (const std::exception& e) {
+        if (!closed_) {
+            fail_all(fmt::format("HTTP/2 connection lost: {}", e.what()), false);
+        }
+    }
+
+    closed_ = true;
+    if (!writing_) {
+        shutdown_socket();
+    }
+}
+
+asio::awaitable<void> Session::write_loop() {
+    auto self = shared_from_this();
+    std::string buffer;
+
+    try {
+        // Frames queued while a write is in flight go out together in the next one
+        while (!outbox_.empty()) {
+            buffer.clear();
+            buffer.swap(outbox_);
+            co_await asio::async_write(*stream_, asio::buffer(buffer), asio::use_awaitable);
+        }
+    } catch (const std::exception& e) {
+        writing_ = false;
+        if (!closed_) {
+            closed_ = true;
+            fail_all(fmt::format("HTTP/2 write failed: {}", e.what()), false);
+        }
+        shutdown_socket();
+        co_return;
+    }
+
+    writing_ = false;
+    if (close_after_flush_) {
+        shutdown_socket();
+    }
+}
+
+void Session::queue_frame(std::uint8_t type, std::uint8_t flags, std::uint32_t stream_id, std::string_view payload) {
+    if (closed_) {
+        return;
+    }
+
+    const auto length = static_cast<std::uint32_t>(payload.size());
+    outbox_.push_back(static_cast<char>(length >> 16));
+    outbox_.push_back(static_cast<char>(length >> 8));
+    outbox_.push_back(static_cast<char>(length));
+    outbox_.push_back(static_cast<char>(type));
+    outbox_.push_back(static_cast<char>(flags));
+    put_u32(outbox_, stream_id);
+    outbox_.append(payload);
+
+    if (!writing_) {
+        writing_ = true;
+        asio::co_spawn(
+            stream_->get_executor(),
+            [self = shared_from_this()]() { return self->write_loop(); },
+            asio::detached
+        );
+    }
+}
+
+void Session::handle_frame(std::uint8_t type, std::uint8_t flags, std::uint32_t stream_id, std::string_view payload) {
+    // A header block must be continued without interleaving (RFC 9113 section 6.10)
+    if (header_stream_id_ != 0 && (type != frame_continuation || stream_id != header_stream_id_)) {
+        throw ProtocolError(error_protocol, "expected CONTINUATION frame");
+    }
+
+    switch (type) {
+    case frame_data:
+        handle_data(flags, stream_id, payload);
+        break;
+    case frame_headers:
+        handle_headers(flags, stream_id, payload);
+        break;
+    case frame_priority:
+        break;
+    case frame_rst_stream:
+        handle_rst_stream(stream_id, payload);
+        break;
+    case frame_settings:
+        if (stream_id != 0) {
+            throw ProtocolError(error_protocol, "SETTINGS on a stream");
+        }
+        handle_settings(flags, payload);
+        break;
+    case frame_push_promise:
+        throw ProtocolError(error_protocol, "PUSH_PROMISE with push disabled");
+    case frame_ping:
+        if (payload.size() != 8) {
+            throw ProtocolError(error_frame_size, "PING payload must be 8 bytes");
+        }
+        if (!(flags & flag_ack)) {
+            queue_frame(frame_ping, flag_ack, 0, payload);
+        }
+        break;
+    case frame_goaway:
+        handle_goaway(payload);
+        break;
+    case frame_window_update:
+        handle_window_update(stream_id, payload);
+        break;
+    case frame_continuation:
+        if (header_stream_id_ == 0) {
+            throw ProtocolError(error_protocol, "unexpected CONTINUATION frame");
+        }
+        header_block_.append(payload);
+        if (header_block_.size() > options_.max_header_list_size) {
+            throw ProtocolError(error_protocol, "header block too large");
+        }
+        if (flags & flag_end_headers) {
+            handle_header_block(header_stream_id_, header_end_stream_);
+        }
+        break;
+    default:
+        // Unknown frame types are ignored (RFC 9113 section 5.5)
+        break;
+    }
+}
+
+void Session::handle_data(std::uint8_t flags, std::uint32_t stream_id, std::string_view payload) {
+    if (stream_id == 0) {
+        throw ProtocolError(error_protocol, "DATA on stream 0");
+    }
+
+    // Padding counts against flow control too
+    const auto flow_length = static_cast<std::uint32_t>(payload.size());
+    const auto data = strip_padding(flags, payload);
+
+    connection_unacked_bytes_ += flow_length;
+    if (connection_unacked_bytes_ >= options_.connection_window_size / 2) {
+        queue_frame(frame_window_update, 0, 0, window_update_payload(connection_unacked_bytes_));
+        connection_unacked_bytes_ = 0;
+    }
+
+    auto it = streams_.find(stream_id);
+    if (it == streams_.end() || it->second->finished) {
+        return;
+    }
+    auto& stream = *it->second;
+
+    if (!stream.headers_received) {
+        queue_frame(frame_rst_stream, 0, stream_id, rst_stream_payload(error_protocol));
+        finish_stream(stream, "HTTP/2 DATA before response headers");
+        return;
+    }
+
+    if (stream.on_data && stream.response.status < 300) {
+        try {
+            stream.on_data(data);
+        } catch (const std::exception& e) {
+            queue_frame(frame_rst_stream, 0, stream_id, rst_stream_payload(error_cancel));
+            finish_stream(stream, e.what());
+            return;
+        }
+    } else {
+        stream.response.body.append(data);
+    }
+
+    if (flags & flag_end_stream) {
+        finish_stream(stream);
+        return;
+    }
+
+    stream.unacked_bytes += flow_length;
+    if (stream.unacked_bytes >= options_.stream_window_size / 2) {
+        queue_frame(frame_window_update, 0, stream_id, window_update_payload(stream.unacked_bytes));
+        stream.unacked_bytes = 0;
+    }
+}
+
+void Session::handle_headers(std::uint8_t flags, std::uint32_t stream_id, std::string_view payload) {
+    if (stream_id == 0) {
+        throw ProtocolError(error_protocol, "HEADERS on stream 0");
+    }
+
+    auto fragment = strip_padding(flags, payload);
+    if (flags & flag_priority) {
+        if (fragment.size() < 5) {
+            throw ProtocolError(error_frame_size, "HEADERS priority block truncated");
+        }
+        fragment.remove_prefix(5);
+    }
+
+    header_block_.assign(fragment);
+    if (flags & flag_end_headers) {
+        handle_header_block(stream_id, flags & flag_end_stream);
+    } else {
+        header_stream_id_ = stream_id;
+        header_end_stream_ = flags & flag_end_stream;
+    }
+}
+
+void Session::handle_header_block(std::uint32_t stream_id, bool end_stream) {
+    header_stream_id_ = 0;
+
+    // Always decode, even for streams we no longer track, to keep HPACK state in sync
+    std::vector<Header> headers;
+    try {
+        headers = decoder_.decode(header_block_);
+    } catch (const std::length_error& e) {
+        throw ProtocolError(error_protocol, e.what());
+    } catch (const std::exception& e) {
+        throw ProtocolError(error_compression, e.what());
+    }
+    header_block_.clear();
+
+    auto it = streams_.find(stream_id);
+    if (it == streams_.end() || it->second->finished) {
+        return;
+    }
+    auto& stream = *it->second;
+
+    const bool final_headers = !stream.headers_received;
+    if (final_headers) {
+        int status = 0;
+        for (const auto& header : headers) {
+            if (header.name == ":status") {
+                std::from_chars(header.value.data(), header.value.data() + header.value.size(), status);
+            }
+        }
+        if (status < 100 || status > 999) {
+            queue_frame(frame_rst_stream, 0, stream_id, rst_stream_payload(error_protocol));
+            finish_stream(stream, "HTTP/2 response without a valid :status");
+            return;
+        }
+        if (status < 200) {
+            // Interim response (e.g. 100 Continue); the final one follows
+            return;
+        }
+        stream.response.status = status;
+        stream.headers_received = true;
+    }
+
+    // Response headers, or trailers after the body
+    for (auto& header : headers) {
+        if (!header.name.starts_with(':')) {
+            stream.response.headers.push_back(std::move(header));
+        }
+    }
+
+    if (final_headers && stream.on_headers) {
+        try {
+            stream.on_headers(stream.response);
+        } catch (const std::exception& e) {
+            queue_frame(frame_rst_stream, 0, stream_id, rst_stream_payload(error_cancel));
+            finish_stream(stream, e.what());
+            return;
+        }
+    }
+
+    if (end_stream) {
+        finish_stream(stream);
+    }
+}
+
+void Session::handle_settings(std::uint8_t flags, std::string_view payload) {
+    if (flags & flag_ack) {
+        return;
+    }
+    if (payload.size() % 6 != 0) {
+        throw ProtocolError(error_frame_size, "SETTINGS payload is not a multiple of 6");
+    }
+
+    for (std::size_t offset = 0; offset < payload.size(); offset += 6) {
+        const auto id = static_cast<std::uint16_t>((static_cast<unsigned char>(payload[offset]) << 8) |
+                                                   static_cast<unsigned char>(payload[offset + 1]));
+        const auto value = get_u32(payload, offset + 2);
+
+        switch (id) {
+        case setting_header_table_size:
+            encoder_.set_max_table_size(value);
+            break;
+        case setting_max_concurrent_streams:
+            peer_max_concurrent_streams_ = value;
+            break;
+        case setting_initial_window_size: {
+            if (value > max_window_size) {
+                throw ProtocolError(error_flow_control, "SETTINGS_INITIAL_WINDOW_SIZE too large");
+            }
+            // Applies retroactively to every open stream (RFC 9113 section 6.9.2)
+            const auto delta = static_cast<std::int64_t>(value) - peer_initial_window_size_;
+            for (auto& [stream_id, stream] : streams_) {
+                stream->send_window += delta;
+                if (stream->send_window > max_window_size) {
+                    throw ProtocolError(error_flow_control, "SETTINGS_INITIAL_WINDOW_SIZE overflows a stream window");
+                }
+            }
+            peer_initial_window_size_ = value;
+            break;
+        }
+        case setting_max_frame_size:
+            if (value < 16384 || value > 16777215) {
+                throw ProtocolError(error_protocol, "invalid SETTINGS_MAX_FRAME_SIZE");
+            }
+            peer_max_frame_size_ = value;
+            break;
+        default:
+            break;
+        }
+    }
+
+    queue_frame(frame_settings, flag_ack, 0, {});
+    notify_all();
+}
+
+void Session::handle_window_update(std::uint32_t stream_id, std::string_view payload) {
+    if (payload.size() != 4) {
+        throw ProtocolError(error_frame_size, "WINDOW_UPDATE payload must be 4 bytes");
+    }
+    const auto increment = get_u32(payload, 0) & max_window_size;
+
+    if (stream_id == 0) {
+        if (increment == 0) {
+            throw ProtocolError(error_protocol, "WINDOW_UPDATE with zero increment");
+        }
+        connection_send_window_ += increment;
+        if (connection_send_window_ > max_window_size) {
+            throw ProtocolError(error_flow_control, "connection window overflow");
+        }
+        notify_all();
+        return;
+    }
+
+    auto it = streams_.find(stream_id);
+    if (it == streams_.end()) {
+        return;
+    }
+    auto& stream = *it->second;
+    if (increment == 0 || stream.send_window + increment > max_window_size) {
+        queue_frame(frame_rst_stream, 0, stream_id, rst_stream_payload(increment == 0 ? error_protocol : error_flow_control));
+        finish_stream(stream, "HTTP/2 invalid stream WINDOW_UPDATE");
+        return;
+    }
+    stream.send_window += increment;
+    stream.signal.cancel();
+}
+
+void Session::handle_rst_stream(std::uint32_t stream_id, std::string_view payload) {
+    if (payload.size() != 4) {
+        throw ProtocolError(error_frame_size, "RST_STREAM payload must be 4 bytes");
+    }
+    if (stream_id == 0) {
+        throw ProtocolError(error_protocol, "RST_STREAM on stream 0");
+    }
+
+    auto it = streams_.find(stream_id);
+    if (it == streams_.end()) {
+        return;
+    }
+    auto& stream = *it->second;
+    const auto code = get_u32(payload, 0);
+
+    // NO_ERROR after the response started means the server needs no more of the
+    // request body; the response itself is complete
+    if (code == error_none && stream.headers_received) {
+        finish_stream(stream);
+    } else {
+        finish_stream(stream, fmt::format("HTTP/2 stream reset by peer (error code {})", code),
+                      code == error_refused_stream);
+    }
+}
+
+void Session::handle_goaway(std::string_view payload) {
+    if (payload.size() < 8) {
+        throw ProtocolError(error_frame_size, "GOAWAY payload truncated");
+    }
+    const auto last_stream_id = get_u32(payload, 0) & max_window_size;
+    const auto code = get_u32(payload, 4);
+    goaway_received_ = true;
+
+    // Streams above last_stream_id were not processed and can be retried elsewhere
+    for (auto& [stream_id, stream] : streams_) {
+        if (stream_id > last_stream_id) {
+            finish_stream(*stream, fmt::format("HTTP/2 GOAWAY (error code {}, {})", code, payload.substr(8)), true);
+        }
+    }
+    slot_signal_.cancel();
+
+    if (streams_.empty()) {
+        close();
+    }
+}
+
+void Session::finish_stream(Stream& stream, std::string error, bool retryable) {
+    if (stream.finished) {
+        return;
+    }
+    stream.finished = true;
+    stream.error = std::move(error);
+    stream.retryable = retryable;
+    stream.signal.cancel();
+}
+
+void Session::fail_all(const std::string& error, bool retryable) {
+    for (auto& [stream_id, stream] : streams_) {
+        finish_stream(*stream, error, retryable);
+    }
+    slot_signal_.cancel();
+}
+
+void Session::notify_all() {
+    for (auto& [stream_id, stream] : streams_) {
+        stream->signal.cancel();
+    }
+    slot_signal_.cancel();
+}
+
+void Session::shutdown_socket() {
+    std::error_code ec;
+    stream_->lowest_layer().shutdown(asio::ip::tcp::socket::shutdown_both, ec);
+    stream_->lowest_layer().close(ec);
+}
+
+} // namespace openai::http2
@@ -0,0 +1,221 @@
+// HTTP/2 Module
+// HPACK header compression and multiplexed HTTP/2 sessions over TLS
+
+export module openai.http2;
+
+import asio;
+import std;
+
+export namespace openai::http2 {
+
+// Header field; names are lowercase on the wire
+struct Header {
+    std::string name;
+    std::string value;
+};
+
+// HPACK dynamic table (RFC 7541 section 2.3.2)
+class HeaderTable {
+public:
+    explicit HeaderTable(std::size_t max_size = 4096) : max_size_(max_size) {}
+
+    // Entry by HPACK index (1-61 static, 62 and up dynamic); nullptr if out of range
+    const Header* at(std::size_t index) const;
+
+    // Full match index, or name-only match index (0 if none)
+    std::pair<std::size_t, std::size_t> find(std::string_view name, std::string_view value) const;
+
+    void insert(std::string name, std::string value);
+    void set_max_size(std::size_t max_size);
+
+    std::size_t size() const { return size_; }
+    std::size_t max_size() const { return max_size_; }
+
+private:
+    void evict_to(std::size_t target);
+
+    std::deque<Header> entries_;  // Newest first
+    std::size_t size_{0};
+    std::size_t max_size_;
+};
+
+// HPACK encoder: static/dynamic table indexing plus Huffman string coding.
+// Credentials are emitted as never-indexed literals.
+class HpackEncoder {
+public:
+    // Cap the dynamic table (peer SETTINGS_HEADER_TABLE_SIZE, at most 4096)
+    void set_max_table_size(std::size_t max_size);
+
+    void encode(const std::vector<Header>& headers, std::string& out);
+
+private:
+    HeaderTable table_;
+    std::optional<std::size_t> pending_size_update_;
+};
+
+// HPACK decoder. Throws std::runtime_error on malformed header blocks, and
+// std::length_error once a block decodes to more than max_list_size bytes
+// (name + value + 32 per field, as SETTINGS_MAX_HEADER_LIST_SIZE counts).
+class HpackDecoder {
+public:
+    explicit HpackDecoder(std::size_t max_table_size = 4096,
+                          std::size_t max_list_size = std::numeric_limits<std::size_t>::max())
+        : table_(max_table_size), limit_(max_table_size), max_list_size_(max_list_size) {}
+
+    std::vector<Header> decode(std::string_view block);
+
+private:
+    HeaderTable table_;
+    std::size_t limit_;
+    std::size_t max_list_size_;
+};
+
+// Huffman coding from RFC 7541 Appendix B
+void huffman_encode(std::string_view input, std::string& out);
+std::size_t huffman_encoded_size(std::string_view input);
+std::string huffman_decode(std::string_view input);
+
+// Local settings advertised to the peer
+struct SessionOptions {
+    std::uint32_t stream_window_size{1u << 24};      // Receive window per stream
+    std::uint32_t connection_window_size{1u << 26};  // Receive window for the whole connection
+    std::uint32_t max_frame_size{1u << 16};          // Largest frame payload we accept
+    std::uint32_t max_header_list_size{1u << 20};
+};
+
+// Final response of one stream
+struct Response {
+    int status{0};
+    std::vector<Header> headers;
+    std::string body;
+};
+
+// Stream failure. Retryable failures are guaranteed to have left the request
+// unprocessed (REFUSED_STREAM, GOAWAY) or hit a connection that died before
+// any response arrived.
+class StreamError : public std::runtime_error {
+public:
+    StreamError(const std::string& message, bool retryable)
+        : std::runtime_error(message), retryable_(retryable) {}
+
+    bool retryable() const { return retryable_; }
+
+private:
+    bool retryable_;
+};
+
+// One HTTP/2 connection carrying many concurrent request streams.
+// The session must be used from the thread running its executor.
+class Session : public std::enable_shared_from_this<Session> {
+public:
+    using tls_stream = asio::ssl::stream<asio::ip::tcp::socket>;
+
+    explicit Session(std::unique_ptr<tls_stream> stream, SessionOptions options = {});
+    ~Session();
+
+    Session(const Session&) = delete;
+    Session& operator=(const Session&) = delete;
+
+    // Send the connection preface and SETTINGS, then start reading frames.
+    // The frame reader keeps the executor busy until the session is closed.
+    void start();
+
+    // Send a request on a new stream and wait for its complete response.
+    // headers must start with the :method, :scheme, :authority and :path
+    // pseudo-headers. A 2xx body is passed to on_data as DATA frames arrive
+    // when it is set; on_open receives the stream id once the headers are
+    // queued. When body_source is set the body is pulled from it instead of
+    // body, in pieces of at most the given size, until it returns an empty
+    // view; each piece must stay valid until the next call. on_headers sees
+    // the status and headers of the final response before its body. Throws
+    // StreamError, also with the message of an exception thrown by on_data
+    // or on_headers, which reset the stream.
+    asio::awaitable<Response> request(std::vector<Header> headers, std::string_view body,
+                                      std::function<void(std::string_view)> on_data = {},
+                                      std::function<void(std::uint32_t)> on_open = {},
+                                      std::function<std::string_view(std::size_t)> body_source = {},
+                                      std::function<void(const Response&)> on_headers = {});
+
+    // Reset a stream opened by request(), which then throws StreamError(reason)
+    void cancel(std::uint32_t stream_id, std::string reason);
+
+    // True while new streams may be opened (not closed, no GOAWAY received)
+    bool is_usable() const;
+
+    std::size_t active_streams() const { return streams_.size(); }
+
+    // Close the connection, failing streams still in flight
+    void close();
+
+private:
+    struct Stream {
+        explicit Stream(asio::any_io_executor executor) : signal(executor, std::chrono::steady_clock::time_point::max()) {}
+
+        std::uint32_t id{0};
+        Response response;
+        std::int64_t send_window{0};
+        std::uint32_t unacked_bytes{0};  // Received DATA not yet returned via WINDOW_UPDATE
+        bool headers_received{false};    // Final (non-1xx) response headers arrived
+        bool finished{false};
+        std::string error;
+        bool retryable{false};
+        std::function<void(std::string_view)> on_data;
+        std::function<void(const Response&)> on_headers;
+        asio::steady_timer signal;       // Cancelled on completion and window updates
+    };
+
+    asio::awaitable<void> read_loop();
+    asio::awaitable<void> write_loop();
+    asio::awaitable<void> fill(std::size_t count);
+
+    void queue_frame(std::uint8_t type, std::uint8_t flags, std::uint32_t stream_id, std::string_view payload);
+    void handle_frame(std::uint8_t type, std::uint8_t flags, std::uint32_t stream_id, std::string_view payload);
+    void handle_data(std::uint8_t flags, std::uint32_t stream_id, std::string_view payload);
+    void handle_headers(std::uint8_t flags, std::uint32_t stream_id, std::string_view payload);
+    void handle_header_block(std::uint32_t stream_id, bool end_stream);
+    void handle_settings(std::uint8_t flags, std::string_view payload);
+    void handle_window_update(std::uint32_t stream_id, std::string_view payload);
+    void handle_rst_stream(std::uint32_t stream_id, std::string_view payload);
+    void handle_goaway(std::string_view payload);
+
+    void finish_stream(Stream& stream, std::string error = {}, bool retryable = false);
+    void fail_all(const std::string& error, bool retryable);
+    void notify_all();
+    void shutdown_socket();
+
+    std::unique_ptr<tls_stream> stream_;
+    SessionOptions options_;
+    HpackEncoder encoder_;
+    HpackDecoder decoder_;
+
+    std::unordered_map<std::uint32_t, std::shared_ptr<Stream>> streams_;
+    std::uint32_t next_stream_id_{1};
+    asio::steady_timer slot_signal_;  // Cancelled when a stream closes or settings change
+
+    // Peer settings
+    std::uint32_t peer_max_concurrent_streams_{100};
+    std::uint32_t peer_initial_window_size_{65535};
+    std::uint32_t peer_max_frame_size_{16384};
+
+    // Flow control
+    std::int64_t connection_send_window_{65535};
+    std::uint32_t connection_unacked_bytes_{0};
+
+    // Frame input
+    std::vector<char> read_buffer_;
+    std::size_t read_begin_{0};
+    std::size_t read_end_{0};
+    std::string header_block_;          // HEADERS + CONTINUATION fragments
+    std::uint32_t header_stream_id_{0}; // Non-zero while a header block is incomplete
+    bool header_end_stream_{false};
+
+    // Frame output
+    std::string outbox_;
+    bool writing_{false};
+    bool close_after_flush_{false};
+
+    bool closed_{false};
+    bool goaway_received_{false};
+};
+
+} // namespace openai::http2
@@ -3,250 +3,2501 @@
 module;  // 全局模块片段
 
 #include <openssl/ssl.h>
+#include <zlib.h>
 
 module openai.http_client;
 
 import asio;
 import fmt;
+import openai.http2;
 import std;
 
 namespace openai::http {
 
-Client::Client(asio::io_context& io_context)
+namespace {
+
+using tls_stream = asio::ssl::stream<asio::ip::tcp::socket>;
+
+constexpr std::size_t max_line_length = 64 * 1024;
+constexpr std::size_t body_piece_size = 64 * 1024;  // Bytes of a BodyStream written at a time
+
+// Content-Length of req's body, if it sends one
+std::optional<std::uint64_t> content_length(const Request& req) {
+    if (req.body_stream) {
+        return req.body_stream->size();
+    }
+    if (!req.body.empty() || req.method == "POST" || req.method == "PUT" || req.method == "PATCH") {
+        return req.body.size();
+    }
+    return std::nullopt;
+}
+
+// Next LF- or CRLF-terminated line of input starting at offset, without its
+// terminator; offset moves past it. nullopt while the line is incomplete.
+std::optional<std::string_view> next_line(std::string_view input, std::size_t& offset) {
+    auto end = input.find('\n', offset);
+    if (end == std::string_view::npos) {
+        return std::nullopt;
+    }
+    auto line = input.substr(offset, end - offset);
+    if (!line.empty() && line.back() == '\r') {
+        line.remove_suffix(1);
+    }
+    offset = end + 1;
+    return line;
+}
+
+std::string_view trim(std::string_view value) {
+    while (!value.empty() && (value.front() == ' ' || value.front() == '\t')) value.remove_prefix(1);
+    while (!value.empty() && (value.back() == ' ' || value.back() == '\t')) value.remove_suffix(1);
+    return value;
+}
+
+bool contains_token(std::string_view value, std::string_view token) {
+    std::string lowered(value);
+    std::ranges::transform(lowered, lowered.begin(), [](unsigned char c) {
+        return static_cast<char>(std::tolower(c));
+    });
+    return lowered.find(token) != std::string::npos;
+}
+
+// Wraps an SSL_SESSION reference we own for storage in TlsSessionCache
+std::shared_ptr<void> adopt_session(SSL_SESSION* session) {
+    return std::shared_ptr<void>(session, [](void* p) {
+        SSL_SESSION_free(static_cast<SSL_SESSION*>(p));
+    });
+}
+
+// SSL_CTX ex_data slot for the owning TlsSessionCache (asio claims app_data)
+int session_cache_index() {
+    static const int index = SSL_CTX_get_ex_new_index(0, nullptr, nullptr, nullptr, nullptr);
+    return index;
+}
+
+// OpenSSL new-session callback. Fires after a TLS 1.2 handshake and for every
+// TLS 1.3 NewSessionTicket, which arrives only after the handshake completes.
+int on_new_session(SSL* ssl, SSL_SESSION* session) {
+    auto* cache = static_cast<TlsSessionCache*>(
+        SSL_CTX_get_ex_data(SSL_get_SSL_CTX(ssl), session_cache_index())
+    );
+    const char* host = SSL_get_servername(ssl, TLSEXT_NAMETYPE_host_name);
+    if (!cache || !host || !SSL_SESSION_is_resumable(session)) {
+        return 0;
+    }
+    cache->put(host, adopt_session(session));
+    return 1;  // We keep the reference
+}
+
+std::string request_port(const Request& req) {
+    return req.port.empty() ? (req.use_ssl ? "443" : "80") : req.port;
+}
+
+// Host header / :authority value: the port is left out when it is the
+// scheme's default (RFC 9110 section 7.2)
+std::string request_authority(const Request& req) {
+    if (req.port.empty() || req.port == (req.use_ssl ? "443" : "80")) {
+        return req.host;
+    }
+    return req.host + ":" + req.port;
+}
+
+std::string connection_key(const Request& req) {
+    return fmt::format("{}://{}:{}", req.use_ssl ? "https" : "http", req.host, request_port(req));
+}
+
+// Value of Accept-Encoding sent when CompressionOptions::accept_encoding is set
+constexpr std::string_view accepted_encodings = "gzip, deflate";
+
+// Account for a decoded response body
+void record_decoding(Metrics& metrics, const ContentDecoder& decoder) {
+    ++metrics.responses_decompressed;
+    metrics.response_bytes_compressed += decoder.bytes_in();
+    metrics.response_bytes_raw += decoder.bytes_out();
+    metrics.decompression_us += static_cast<std::uint64_t>(decoder.busy().count());
+}
+
+// Request headers for an HTTP/2 stream: pseudo-headers first, lowercase names,
+// and no connection-specific fields (RFC 9113 section 8.2.2)
+std::vector<http2::Header> http2_headers(const Request& req, bool accept_encoding) {
+    std::vector<http2::Header> headers;
+    headers.reserve(req.headers.size() + 5);
+
+    headers.push_back({":method", req.method});
+    headers.push_back({":scheme", "https"});
+    headers.push_back({":authority", request_authority(req)});
+    headers.push_back({":path", req.path});
+
+    for (const auto& [key, value] : req.headers) {
+        std::string name = key;
+        std::ranges::transform(name, name.begin(), [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+        if (name == "host" || name == "connection" || name == "keep-alive" || name == "proxy-connection" ||
+            name == "transfer-encoding" || name == "upgrade" || name == "content-length") {
+            continue;
+        }
+        headers.push_back({std::move(name), value});
+    }
+
+    if (accept_encoding && !req.headers.contains("Accept-Encoding")) {
+        headers.push_back({"accept-encoding", std::string(accepted_encodings)});
+    }
+    if (auto length = content_length(req)) {
+        headers.push_back({"content-length", std::to_string(*length)});
+    }
+    return headers;
+}
+
+// Value of a lowercase header among HTTP/2 response headers, empty if absent
+std::string_view header_value(const std::vector<http2::Header>& headers, std::string_view name) {
+    for (const auto& header : headers) {
+        if (header.name == name) {
+            return header.value;
+        }
+    }
+    return {};
+}
+
+// Drop the headers that describe an encoded body once it has been decoded
+void strip_encoding(std::vector<http2::Header>& headers) {
+    std::erase_if(headers, [](const http2::Header& header) {
+        return header.name == "content-encoding" || header.name == "content-length";
+    });
+}
+
+// Content-Length among HTTP/2 response headers, if present and valid
+std::optional<std::uint64_t> content_length(const std::vector<http2::Header>& headers) {
+    for (const auto& header : headers) {
+        if (header.name == "content-length") {
+            std::uint64_t length = 0;
+            const auto* end = header.value.data() + header.value.size();
+            if (auto [ptr, ec] = std::from_chars(header.value.data(), end, length); ec == std::errc{} && ptr == end) {
+                return length;
+            }
+            return std::nullopt;
+        }
+    }
+    return std::nullopt;
+}
+
+// Response of a finished stream, with a gzip or deflate body decoded
+Response to_response(http2::Response&& response, Metrics& metrics) {
+    if (auto decoder = ContentDecoder::create(header_value(response.headers, "content-encoding"))) {
+        std::string body;
+        decoder->feed(response.body, [&body](std::string_view data) { body.append(data); });
+        decoder->finish();
+        response.body = std::move(body);
+        strip_encoding(response.headers);
+        record_decoding(metrics, *decoder);
+    }
+
+    Response result;
+    result.status_code = response.status;
+    result.body = std::move(response.body);
+    for (auto& header : response.headers) {
+        auto [it, inserted] = result.headers.try_emplace(std::move(header.name), header.value);
+        if (!inserted) {
+            it->second += ", ";
+            it->second += header.value;
+        }
+    }
+    return result;
+}
+
+// Order endpoints for connection racing: alternate address families, starting
+// with the family of the first resolved address (RFC 8305 section 4)
+std::vector<asio::ip::tcp::endpoint> interleave_families(const std::vector<asio::ip::tcp::endpoint>& endpoints) {
+    std::vector<asio::ip::tcp::endpoint> preferred;
+    std::vector<asio::ip::tcp::endpoint> other;
+    const bool prefer_v6 = endpoints.front().address().is_v6();
+    for (const auto& endpoint : endpoints) {
+        (endpoint.address().is_v6() == prefer_v6 ? preferred : other).push_back(endpoint);
+    }
+
+    std::vector<asio::ip::tcp::endpoint> ordered;
+    ordered.reserve(endpoints.size());
+    for (std::size_t i = 0; i < std::max(preferred.size(), other.size()); ++i) {
+        if (i < preferred.size()) ordered.push_back(preferred[i]);
+        if (i < other.size()) ordered.push_back(other[i]);
+    }
+    return ordered;
+}
+
+// Shared state of one Happy Eyeballs connection race
+struct ConnectRace {
+    ConnectRace(asio::any_io_executor executor, std::size_t attempts)
+        : done(executor, asio::steady_timer::time_point::max())
+        , sockets(attempts, nullptr)
+        , remaining(attempts) {}
+
+    // Stop the race: close attempts in progress and release those not started
+    void abort() {
+        aborted = true;
+        for (auto* socket : sockets) {
+            if (socket) {
+                std::error_code ec;
+                socket->close(ec);
+            }
+        }
+        for (auto& timer : start_timers) {
+            timer->expires_at(std::chrono::steady_clock::now());
+        }
+    }
+
+    asio::steady_timer done;
+    std::vector<std::unique_ptr<asio::steady_timer>> start_timers;
+    std::vector<asio::ip::tcp::socket*> sockets;  // Attempts currently connecting
+    std::optional<asio::ip::tcp::socket> winner;
+    std::error_code last_error;
+    std::size_t remaining;
+    bool aborted{false};
+};
+
+asio::awaitable<void> connect_attempt(std::shared_ptr<ConnectRace> race, std::size_t index,
+                                      asio::ip::tcp::endpoint endpoint) {
+    std::error_code ec;
+    co_await race->start_timers[index]->async_wait(asio::redirect_error(asio::use_awaitable, ec));
+
+    if (!race->winner && !race->aborted) {
+        asio::ip::tcp::socket socket(co_await asio::this_coro::executor);
+        race->sockets[index] = &socket;
+        co_await socket.async_connect(endpoint, asio::redirect_error(asio::use_awaitable, ec));
+        race->sockets[index] = nullptr;
+
+        if (!ec && !race->winner) {
+            race->winner.emplace(std::move(socket));
+            // Abort the losers and release attempts that have not started yet
+            for (auto* other : race->sockets) {
+                if (other) {
+                    std::error_code close_ec;
+                    other->close(close_ec);
+                }
+            }
+            for (auto& timer : race->start_timers) {
+                timer->expires_at(std::chrono::steady_clock::now());
+            }
+        } else if (ec) {
+            race->last_error = ec;
+            // Start the next attempt now rather than after its full delay
+            if (index + 1 < race->start_timers.size()) {
+                race->start_timers[index + 1]->expires_at(std::chrono::steady_clock::now());
+            }
+        }
+    }
+
+    if (--race->remaining == 0 || race->winner) {
+        race->done.cancel();
+    }
+}
+
+// RFC 8305 style connect: attempts start attempt_delay apart (or as soon as
+// the previous one fails) and the first established connection wins.
+// watch (a Client::Watch) can abort the connect while it is in progress.
+template <typename Watch>
+asio::awaitable<asio::ip::tcp::socket> race_connect(const std::vector<asio::ip::tcp::endpoint>& endpoints,
+                                                    std::chrono::milliseconds attempt_delay, Watch& watch) {
+    auto executor = co_await asio::this_coro::executor;
+
+    if (endpoints.size() == 1) {
+        asio::ip::tcp::socket socket(executor);
+        watch.set_abort([&socket] {
+            std::error_code ec;
+            socket.close(ec);
+        });
+        std::error_code ec;
+        co_await socket.async_connect(endpoints.front(), asio::redirect_error(asio::use_awaitable, ec));
+        watch.set_abort({});
+        if (ec) {
+            throw asio::system_error(ec);
+        }
+        co_return socket;
+    }
+
+    auto ordered = interleave_families(endpoints);
+    auto race = std::make_shared<ConnectRace>(executor, ordered.size());
+    auto start = std::chrono::steady_clock::now();
+    for (std::size_t i = 0; i < ordered.size(); ++i) {
+        race->start_timers.push_back(std::make_unique<asio::steady_timer>(
+            executor, start + attempt_delay * static_cast<int>(i)
+        ));
+    }
+    for (std::size_t i = 0; i < ordered.size(); ++i) {
+        asio::co_spawn(executor, connect_attempt(race, i, ordered[i]), asio::detached);
+    }
+
+    watch.set_abort([race] { race->abort(); });
+    try {
+        while (!race->winner && race->remaining > 0) {
+            std::error_code ec;
+            co_await race->done.async_wait(asio::redirect_error(asio::use_awaitable, ec));
+        }
+    } catch (...) {
+        // The caller was cancelled; don't leave attempts running
+        watch.set_abort({});
+        race->abort();
+        throw;
+    }
+    watch.set_abort({});
+
+    if (!race->winner) {
+        throw asio::system_error(race->last_error ? race->last_error
+                                                  : std::error_code(asio::error::host_unreachable));
+    }
+    co_return std::move(*race->winner);
+}
+
+// Resolve through cache without tying the caller to the lookup: the lookup
+// is shared with other requests and cannot be interrupted, so it runs on its
+// own and watch's abort hook only stops this caller waiting for it
+template <typename Watch>
+asio::awaitable<std::vector<asio::ip::tcp::endpoint>> resolve_abortable(std::shared_ptr<ResolverCache> cache,
+                                                                        const std::string& host,
+                                                                        const std::string& port, Watch& watch) {
+    struct Lookup {
+        explicit Lookup(asio::any_io_executor executor)
+            : done(std::move(executor), std::chrono::steady_clock::time_point::max()) {}
+
+        asio::steady_timer done;
+        std::optional<std::vector<asio::ip::tcp::endpoint>> endpoints;
+        std::exception_ptr error;
+        bool finished{false};
+    };
+
+    auto executor = co_await asio::this_coro::executor;
+    auto lookup = std::make_shared<Lookup>(executor);
+    asio::co_spawn(
+        executor,
+        [lookup, cache, host, port]() -> asio::awaitable<void> {
+            try {
+                lookup->endpoints = co_await cache->resolve(host, port);
+            } catch (...) {
+                lookup->error = std::current_exception();
+            }
+            lookup->finished = true;
+            lookup->done.cancel();
+        },
+        asio::detached
+    );
+
+    watch.set_abort([lookup] { lookup->done.cancel(); });
+    while (!lookup->finished && !watch.failed()) {
+        std::error_code ec;
+        co_await lookup->done.async_wait(asio::redirect_error(asio::use_awaitable, ec));
+    }
+    watch.set_abort({});
+    watch.check();
+    if (lookup->error) {
+        std::rethrow_exception(lookup->error);
+    }
+    co_return std::move(*lookup->endpoints);
+}
+
+// Read one HTTP/1.1 response from stream, buffering through input.
+// Sets response_started once any response bytes have arrived, and reusable
+// when the body was framed so the connection can carry another request.
+// Reads are reported to watch for the first-byte and idle-read limits. A
+// gzip or deflate body is decoded as it arrives.
+template <typename Stream, typename Watch>
+asio::awaitable<Response> read_response(Stream& stream, ReadBuffer& input, const Request& req,
+                                        bool& response_started, bool& reusable, Watch& watch, Metrics& metrics) {
+    constexpr std::size_t read_size = 16 * 1024;
+
+    ResponseParser parser(req.method == "HEAD");
+    std::string body;
+    bool sized = false;
+
+    // Chosen from Content-Encoding once the headers are complete
+    std::unique_ptr<ContentDecoder> decoder;
+    bool decoder_checked = false;
+    auto check_decoder = [&] {
+        if (!decoder_checked) {
+            decoder_checked = true;
+            if (auto it = parser.headers().find("Content-Encoding"); it != parser.headers().end()) {
+                decoder = ContentDecoder::create(it->second);
+            }
+        }
+    };
+
+    // Successful bodies go to on_body_chunk as they arrive when it is set
+    auto streaming = [&] {
+        return req.on_body_chunk && parser.status_code() >= 200 && parser.status_code() < 300;
+    };
+    bool body_started = false;
+    auto start_body = [&] {
+        body_started = true;
+        if (req.on_body_start) {
+            // Content-Length counts encoded bytes; the decoded size is unknown
+            req.on_body_start(decoder ? std::nullopt : parser.content_length());
+        }
+    };
+    const std::function<void(std::string_view)> deliver = [&](std::string_view data) {
+        if (streaming()) {
+            if (!body_started) {
+                start_body();
+            }
+            req.on_body_chunk(data);
+        } else {
+            body.append(data);
+        }
+    };
+    const std::function<void(std::string_view)> on_body = [&](std::string_view data) {
+        check_decoder();
+        if (decoder) {
+            decoder->feed(data, deliver);
+        } else {
+            deliver(data);
+        }
+    };
+
+    while (true) {
+        if (input.size() > 0) {
+            input.consume(parser.parse(input.data(), on_body));
+        }
+        if (parser.done()) {
+            break;
+        }
+
+        if (parser.headers_complete() && !sized) {
+            sized = true;
+            check_decoder();
+            if (auto length = parser.content_length(); length && !streaming()) {
+                body.reserve(*length);
+            }
+        }
+
+        // Large framed bodies are read straight into the response body
+        if (input.size() == 0 && parser.body_remaining() >= read_size && !streaming() && !decoder) {
+            auto offset = body.size();
+            body.resize(offset + parser.body_remaining());
+            auto count = co_await stream.async_read_some(
+                asio::buffer(body.data() + offset, body.size() - offset), asio::use_awaitable
+            );
+            body.resize(offset + count);
+            parser.advance_body(count);
+            watch.progress();
+            continue;
+        }
+
+        std::error_code ec;
+        auto count = co_await stream.async_read_some(
+            input.prepare(read_size), asio::redirect_error(asio::use_awaitable, ec)
+        );
+        input.commit(count);
+        if (count > 0 && !response_started) {
+            response_started = true;
+            watch.reading();
+        } else {
+            watch.progress();
+        }
+        if (ec) {
+            // Unframed bodies end when the server closes the connection
+            if ((ec == asio::error::eof || ec == asio::ssl::error::stream_truncated) &&
+                parser.state() == ResponseParser::State::BodyToEof) {
+                input.consume(parser.parse(input.data(), on_body));
+                parser.finish_eof();
+                break;
+            }
+            throw asio::system_error(ec);
+        }
+    }
+
+    if (decoder) {
+        decoder->finish();
+        parser.headers().erase("Content-Encoding");
+        parser.headers().erase("Content-Length");
+        record_decoding(metrics, *decoder);
+    }
+
+    // An empty streamed body still starts
+    if (streaming() && !body_started) {
+        start_body();
+    }
+
+    // Bytes past the end of the response mean the framing cannot be trusted
+    reusable = parser.reusable() && input.size() == 0;
+
+    co_return Response{parser.status_code(), std::move(body), std::move(parser.headers()), false, ""};
+}
+
+// Send request_str over stream and read the response
+template <typename Stream, typename Watch>
+asio::awaitable<Response> exchange(Stream& stream, ReadBuffer& input, const Request& req,
+                                   const std::string& request_str, bool& response_started, bool& reusable,
+                                   Watch& watch, Metrics& metrics) {
+    watch.enter("send", {});
+    if (!req.body_stream) {
+        co_await asio::async_write(
+            stream, asio::buffer(request_str), asio::use_awaitable
+        );
+    } else {
+        // Headers go out with the first piece; later pieces reuse its buffer
+        BodyStream::Reader reader(*req.body_stream);
+        auto piece = reader.next(body_piece_size);
+        co_await asio::async_write(
+            stream, std::array{asio::buffer(request_str), asio::buffer(piece)}, asio::use_awaitable
+        );
+        while (!(piece = reader.next(body_piece_size)).empty()) {
+            co_await asio::async_write(stream, asio::buffer(piece), asio::use_awaitable);
+        }
+    }
+    watch.enter("first byte", watch.timeouts().first_byte);
+    co_return co_await read_response(stream, input, req, response_started, reusable, watch, metrics);
+}
+
+} // namespace
+
+// ============================================================================
+// BodyStream
+// ============================================================================
+
+void BodyStream::append(std::string data) {
+    size_ += data.size();
+    parts_.emplace_back(std::move(data));
+}
+
+void BodyStream::append_view(std::span<const char> data) {
+    size_ += data.size();
+    parts_.emplace_back(data);
+}
+
+void BodyStream::append_file(const std::filesystem::path& path) {
+    const auto size = std::filesystem::file_size(path);  // filesystem_error is a runtime_error
+    size_ += size;
+    parts_.emplace_back(FilePart{path, size});
+}
+
+std::string_view BodyStream::Reader::next(std::size_t max_size) {
+    while (part_ < body_.parts_.size()) {
+        const auto& part = body_.parts_[part_];
+        if (const auto* file = std::get_if<FilePart>(&part)) {
+            if (!file_.is_open()) {
+                file_.open(file->path, std::ios::binary);
+                if (!file_) {
+                    throw std::runtime_error("Failed to open file: " + file->path.string());
+                }
+            }
+            if (offset_ < file->size) {
+                const auto count = static_cast<std::size_t>(std::min<std::uint64_t>(max_size, file->size - offset_));
+                buffer_.resize(count);
+                file_.read(buffer_.data(), static_cast<std::streamsize>(count));
+                if (static_cast<std::size_t>(file_.gcount()) != count) {
+                    throw std::runtime_error("File shrank while sending: " + file->path.string());
+                }
+                offset_ += count;
+                return {buffer_.data(), count};
+            }
+            file_.close();
+        } else {
+            const auto* owned = std::get_if<std::string>(&part);
+            const auto bytes = owned ? std::string_view(*owned)
+                                     : std::string_view(std::get<std::span<const char>>(part).data(),
+                                                        std::get<std::span<const char>>(part).size());
+            if (offset_ < bytes.size()) {
+                const auto piece = bytes.substr(static_cast<std::size_t>(offset_), max_size);
+                offset_ += piece.size();
+                return piece;
+            }
+        }
+        ++part_;
+        offset_ = 0;
+    }
+    return {};
+}
+
+// ============================================================================
+// BodySink
+// ============================================================================
+
+void BodySink::attach(Request& req) {
+    req.on_body_start = [this](std::optional<std::uint64_t> length) {
+        received_ = 0;
+        total_ = length;
+        begin();
+        if (on_progress_) {
+            on_progress_(received_, total_);
+        }
+    };
+    req.on_body_chunk = [this](std::string_view data) {
+        write(data);
+        received_ += data.size();
+        if (on_progress_) {
+            on_progress_(received_, total_);
+        }
+    };
+}
+
+void LineSink::write(std::string_view data) {
+    std::size_t offset = 0;
+    for (auto end = data.find('\n'); end != std::string_view::npos; end = data.find('\n', offset)) {
+        auto piece = data.substr(offset, end - offset);
+        offset = end + 1;
+        // Lines within this chunk are passed in place
+        std::string_view line = piece;
+        if (!partial_.empty()) {
+            partial_.append(piece);
+            line = partial_;
+        }
+        if (!line.empty() && line.back() == '\r') {
+            line.remove_suffix(1);
+        }
+        on_line_(line);
+        partial_.clear();
+    }
+    partial_.append(data.substr(offset));
+}
+
+void LineSink::finish() {
+    std::string_view line = partial_;
+    if (!line.empty() && line.back() == '\r') {
+        line.remove_suffix(1);
+    }
+    if (!line.empty()) {
+        on_line_(line);
+    }
+    partial_.clear();
+}
+
+void FileSink::begin() {
+    file_.close();
+    file_.open(path_, std::ios::binary | std::ios::trunc);
+    if (!file_) {
+        throw std::runtime_error("Failed to open file for writing: " + path_.string());
+    }
+}
+
+void FileSink::write(std::string_view data) {
+    file_.write(data.data(), static_cast<std::streamsize>(data.size()));
+    if (!file_) {
+        throw std::runtime_error("Failed to write file: " + path_.string());
+    }
+}
+
+void FileSink::finish() {
+    if (!file_.is_open()) {
+        begin();  // No body arrived; still leave an empty file
+    }
+    file_.close();
+    if (!file_) {
+        throw std::runtime_error("Failed to write file: " + path_.string());
+    }
+}
+
+// ============================================================================
+// Content coding
+// ============================================================================
+
+struct ContentDecoder::State {
+    z_stream stream{};
+    bool gzip{false};
+    bool initialized{false};  // On the first byte, when a deflate body's wrapping is known
+    bool done{false};  // deflate: the stream ended
+    bool member_ended{false};  // gzip: a member ended; another may follow in later input
+    std::vector<char> buffer;
+};
+
+std::unique_ptr<ContentDecoder> ContentDecoder::create(std::string_view encoding) {
+    std::string coding(trim(encoding));
+    std::ranges::transform(coding, coding.begin(), [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+    if (coding == "gzip" || coding == "x-gzip") {
+        return std::make_unique<ContentDecoder>(true);
+    }
+    if (coding == "deflate") {
+        return std::make_unique<ContentDecoder>(false);
+    }
+    return nullptr;
+}
+
+ContentDecoder::ContentDecoder(bool gzip) : state_(std::make_unique<State>()) {
+    state_->gzip = gzip;
+}
+
+ContentDecoder::~ContentDecoder() {
+    if (state_->initialized) {
+        inflateEnd(&state_->stream);
+    }
+}
+
+void ContentDecoder::feed(std::string_view input, const std::function<void(std::string_view)>& on_output) {
+    using Clock = std::chrono::steady_clock;
+    auto& state = *state_;
+    auto& stream = state.stream;
+
+    // Bytes after the end of the stream are ignored
+    if (input.empty() || state.done) {
+        return;
+    }
+    if (!state.initialized) {
+        // A zlib header starts with compression method 8 and a window of at most 32 KiB
+        int window_bits = 15 + 16;
+        if (!state.gzip) {
+            auto cmf = static_cast<unsigned char>(input.front());
+            window_bits = (cmf & 0x0f) == 8 && (cmf >> 4) <= 7 ? 15 : -15;
+        }
+        if (inflateInit2(&stream, window_bits) != Z_OK) {
+            throw std::runtime_error("Failed to initialize zlib");
+        }
+        state.initialized = true;
+        state.buffer.resize(body_piece_size);
+    }
+
+    while (!input.empty() && !state.done) {
+        // gzip bodies may hold several members back to back
+        if (state.member_ended) {
+            inflateReset(&stream);
+            state.member_ended = false;
+        }
+        auto slice = input.substr(0, std::numeric_limits<uInt>::max());
+        input.remove_prefix(slice.size());
+        bytes_in_ += slice.size();
+        stream.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(slice.data()));
+        stream.avail_in = static_cast<uInt>(slice.size());
+
+        for (;;) {
+            stream.next_out = reinterpret_cast<Bytef*>(state.buffer.data());
+            stream.avail_out = static_cast<uInt>(state.buffer.size());
+            auto start = Clock::now();
+            int result = inflate(&stream, Z_NO_FLUSH);
+            busy_ += Clock::now() - start;
+            if (result != Z_OK && result != Z_STREAM_END && result != Z_BUF_ERROR) {
+                throw std::runtime_error(fmt::format("Invalid {} body: {}", state.gzip ? "gzip" : "deflate",
+                                                     stream.msg ? stream.msg : "corrupt data"));
+            }
+
+            auto produced = state.buffer.size() - stream.avail_out;
+            if (produced > 0) {
+                bytes_out_ += produced;
+                on_output({state.buffer.data(), produced});
+            }
+
+            if (result == Z_STREAM_END) {
+                if (!state.gzip) {
+                    state.done = true;
+                    break;
+                }
+                if (stream.avail_in == 0) {
+                    state.member_ended = true;
+                    break;
+                }
+                inflateReset(&stream);
+                continue;
+            }
+            if ((stream.avail_in == 0 && stream.avail_out != 0) || (result == Z_BUF_ERROR && produced == 0)) {
+                break;
+            }
+        }
+    }
+}
+
+void ContentDecoder::finish() {
+    if (state_->initialized && !state_->done && !state_->member_ended) {
+        throw std::runtime_error(fmt::format("Truncated {} body", state_->gzip ? "gzip" : "deflate"));
+    }
+}
+
+std::string gzip_compress(std::string_view input, int level) {
+    if (input.size() > std::numeric_limits<uInt>::max()) {
+        throw std::runtime_error("Body too large to compress");
+    }
+
+    z_stream stream{};
+    if (deflateInit2(&stream, std::clamp(level, 1, 9), Z_DEFLATED, 15 + 16, 8, Z_DEFAULT_STRATEGY) != Z_OK) {
+        throw std::runtime_error("Failed to initialize zlib");
+    }
+    std::string output(deflateBound(&stream, static_cast<uLong>(input.size())), '\0');
+    stream.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(input.data()));
+    stream.avail_in = static_cast<uInt>(input.size());
+    stream.next_out = reinterpret_cast<Bytef*>(output.data());
+    stream.avail_out = static_cast<uInt>(output.size());
+
+    // deflateBound() leaves room for the whole stream in one call
+    int result = deflate(&stream, Z_FINISH);
+    output.resize(stream.total_out);
+    deflateEnd(&stream);
+    if (result != Z_STREAM_END) {
+        throw std::runtime_error("gzip compression failed");
+    }
+    return output;
+}
+
+// ============================================================================
+// ReadBuffer
+// ============================================================================
+
+void ReadBuffer::consume(std::size_t count) {
+    begin += count;
+    if (begin == end) {
+        begin = end = 0;
+    }
+}
+
+asio::mutable_buffer ReadBuffer::prepare(std::size_t count) {
+    if (storage.size() - end < count && begin > 0) {
+        std::memmove(storage.data(), storage.data() + begin, end - begin);
+        end -= begin;
+        begin = 0;
+    }
+    if (storage.size() - end < count) {
+        storage.resize(std::max(end + count, storage.size() * 2));
+    }
+    return asio::buffer(storage.data() + end, storage.size() - end);
+}
+
+// ============================================================================
+// ResponseParser
+// ============================================================================
+
+std::size_t ResponseParser::parse(std::string_view input, const std::function<void(std::string_view)>& on_body) {
+    std::size_t offset = 0;
+
+    while (state_ != State::Done && offset < input.size()) {
+        switch (state_) {
+        case State::Body:
+        case State::ChunkData: {
+            auto count = std::min(remaining_, input.size() - offset);
+            on_body(input.substr(offset, count));
+            offset += count;
+            advance_body(count);
+            break;
+        }
+        case State::BodyToEof:
+            on_body(input.substr(offset));
+            offset = input.size();
+            break;
+        default: {
+            auto line = next_line(input, offset);
+            if (!line) {
+                if (input.size() - offset > max_line_length) {
+                    throw std::runtime_error("HTTP response line too long");
+                }
+                return offset;
+            }
+
+            if (state_ == State::StatusLine) {
+                parse_status_line(*line);
+            } else if (state_ == State::Headers) {
+                if (line->empty()) {
+                    finish_headers();
+                } else {
+                    parse_header_line(*line);
+                }
+            } else if (state_ == State::ChunkSize) {
+                auto size_text = trim(line->substr(0, line->find(';')));
+                std::size_t size = 0;
+                auto [end, ec] = std::from_chars(size_text.data(), size_text.data() + size_text.size(), size, 16);
+                if (size_text.empty() || ec != std::errc{} || end != size_text.data() + size_text.size()) {
+                    throw std::runtime_error("Invalid chunk size");
+                }
+                remaining_ = size;
+                state_ = size == 0 ? State::Trailers : State::ChunkData;
+            } else if (state_ == State::ChunkDataEnd) {
+                if (!line->empty()) {
+                    throw std::runtime_error("Missing CRLF after chunk data");
+                }
+                state_ = State::ChunkSize;
+            } else if (state_ == State::Trailers && line->empty()) {
+                // Trailer fields are skipped
+                state_ = State::Done;
+            }
+            break;
+        }
+        }
+    }
+
+    return offset;
+}
+
+std::size_t ResponseParser::body_remaining() const {
+    return state_ == State::Body || state_ == State::ChunkData ? remaining_ : 0;
+}
+
+void ResponseParser::advance_body(std::size_t count) {
+    remaining_ -= count;
+    if (remaining_ == 0) {
+        state_ = state_ == State::Body ? State::Done : State::ChunkDataEnd;
+    }
+}
+
+void ResponseParser::finish_eof() {
+    if (state_ != State::BodyToEof) {
+        throw std::runtime_error("Connection closed before the response was complete");
+    }
+    state_ = State::Done;
+}
+
+void ResponseParser::parse_status_line(std::string_view line) {
+    // Tolerate a stray CRLF before the status line
+    if (line.empty()) {
+        return;
+    }
+    if (!line.starts_with("HTTP/")) {
+        throw std::runtime_error("Invalid HTTP status line");
+    }
+
+    auto space = line.find(' ');
+    auto version = line.substr(0, space);
+    auto status = space == std::string_view::npos ? std::string_view{} : line.substr(space + 1, 3);
+    auto [end, ec] = std::from_chars(status.data(), status.data() + status.size(), status_code_);
+    if (status.size() != 3 || ec != std::errc{} || end != status.data() + status.size()) {
+        throw std::runtime_error("Invalid HTTP status code");
+    }
+
+    keep_alive_ = version == "HTTP/1.1";
+    framed_ = true;
+    content_length_.reset();
+    headers_.clear();
+    last_header_.clear();
+    state_ = State::Headers;
+}
+
+void ResponseParser::parse_header_line(std::string_view line) {
+    // Obsolete line folding continues the previous field value
+    if (line.front() == ' ' || line.front() == '\t') {
+        auto it = headers_.find(last_header_);
+        if (it == headers_.end()) {
+            throw std::runtime_error("Malformed HTTP header continuation");
+        }
+        it->second += ' ';
+        it->second += trim(line);
+        return;
+    }
+
+    auto colon = line.find(':');
+    if (colon == std::string_view::npos || colon == 0) {
+        throw std::runtime_error("Malformed HTTP header line");
+    }
+    auto name = line.substr(0, colon);
+    auto value = trim(line.substr(colon + 1));
+
+    auto [it, inserted] = headers_.try_emplace(std::string(name), value);
+    if (!inserted) {
+        it->second += ", ";
+        it->second += value;
+    }
+    last_header_ = it->first;
+}
+
+void ResponseParser::finish_headers() {
+    // Interim responses (e.g. 100 Continue) precede the real one
+    if (status_code_ >= 100 && status_code_ < 200 && status_code_ != 101) {
+        state_ = State::StatusLine;
+        return;
+    }
+
+    if (auto it = headers_.find("Connection"); it != headers_.end()) {
+        if (contains_token(it->second, "close")) {
+            keep_alive_ = false;
+        } else if (contains_token(it->second, "keep-alive")) {
+            keep_alive_ = true;
+        }
+    }
+
+    if (head_request_ || status_code_ < 200 || status_code_ == 204 || status_code_ == 304) {
+        state_ = State::Done;
+        return;
+    }
+
+    if (auto it = headers_.find("Transfer-Encoding"); it != headers_.end() && contains_token(it->second, "chunked")) {
+        state_ = State::ChunkSize;
+        return;
+    }
+
+    if (auto it = headers_.find("Content-Length"); it != headers_.end()) {
+        std::size_t length = 0;
+        const auto& text = it->second;
+        auto [end, ec] = std::from_chars(text.data(), text.data() + text.size(), length);
+        if (text.empty() || ec != std::errc{} || end != text.data() + text.size()) {
+            throw std::runtime_error("Invalid Content-Length");
+        }
+        content_length_ = length;
+        remaining_ = length;
+        state_ = length == 0 ? State::Done : State::Body;
+        return;
+    }
+
+    framed_ = false;
+    state_ = State::BodyToEof;
+}
+
+// ============================================================================
+// Connection
+// ============================================================================
+
+asio::ip::tcp::socket& Connection::socket() {
+    return tls ? tls->next_layer() : *tcp;
+}
+
+bool Connection::is_stale() {
+    auto& sock = socket();
+    if (!sock.is_open()) {
+        return true;
+    }
+
+    // Decrypted bytes already buffered by OpenSSL are unsolicited data
+    if (tls && SSL_pending(tls->native_handle()) > 0) {
+        return true;
+    }
+
+    // An idle keep-alive socket must have nothing to read: readable data is
+    // either an EOF (server closed it) or something we cannot interpret.
+    std::error_code ec;
+    char probe;
+    sock.non_blocking(true, ec);
+    sock.receive(asio::buffer(&probe, 1), asio::socket_base::message_peek, ec);
+    std::error_code restore_ec;
+    sock.non_blocking(false, restore_ec);
+
+    return ec != asio::error::would_block && ec != asio::error::try_again;
+}
+
+void Connection::close() {
+    std::error_code ec;
+    socket().close(ec);
+}
+
+// ============================================================================
+// Event
+// ============================================================================
+
+void Event::set() {
+    std::vector<std::move_only_function<void()>> waiters;
+    {
+        std::lock_guard lock(mutex_);
+        set_ = true;
+        waiters.swap(waiters_);
+    }
+    for (auto& wake : waiters) {
+        wake();
+    }
+}
+
+bool Event::is_set() const {
+    std::lock_guard lock(mutex_);
+    return set_;
+}
+
+asio::awaitable<void> Event::wait() {
+    // The handler is resumed through its own executor, never inline in set()
+    co_await asio::async_initiate<const asio::use_awaitable_t<>&, void()>(
+        [this](auto handler) {
+            auto wake = [handler = std::move(handler)]() mutable {
+                auto executor = asio::get_associated_executor(handler);
+                asio::post(executor, std::move(handler));
+            };
+            std::unique_lock lock(mutex_);
+            if (set_) {
+                lock.unlock();
+                wake();
+                return;
+            }
+            waiters_.emplace_back(std::move(wake));
+        },
+        asio::use_awaitable
+    );
+}
+
+// ============================================================================
+// ResolverCache
+// ============================================================================
+
+asio::awaitable<std::vector<asio::ip::tcp::endpoint>> ResolverCache::resolve(
+    const std::string& host, const std::string& port) {
+    auto executor = co_await asio::this_coro::executor;
+    const auto key = host + ":" + port;
+
+    // Answer from the cache, wait for an in-flight lookup, or start one
+    std::shared_ptr<Event> lookup;
+    while (!lookup) {
+        std::shared_ptr<Event> pending;
+        {
+            std::lock_guard lock(mutex_);
+            auto& entry = entries_[key];
+            if (entry.lookup) {
+                pending = entry.lookup;
+            } else if (std::chrono::steady_clock::now() < entry.expires) {
+                ++hits_;
+                if (entry.error) {
+                    throw asio::system_error(entry.error);
+                }
+                co_return entry.endpoints;
+            } else {
+                entry.lookup = std::make_shared<Event>();
+                lookup = entry.lookup;
+            }
+        }
+        if (pending) {
+            co_await pending->wait();
+        }
+    }
+
+    ++lookups_;
+    asio::ip::tcp::resolver resolver(executor);
+    std::error_code ec;
+    auto results = co_await resolver.async_resolve(
+        host, port, asio::redirect_error(asio::use_awaitable, ec)
+    );
+
+    std::vector<asio::ip::tcp::endpoint> endpoints;
+    if (!ec) {
+        for (const auto& result : results) {
+            endpoints.push_back(result.endpoint());
+        }
+        if (endpoints.empty()) {
+            ec = asio::error::host_not_found;
+        }
+    }
+
+    {
+        std::lock_guard lock(mutex_);
+        auto& entry = entries_[key];
+        entry.endpoints = endpoints;
+        entry.error = ec;
+        // A cancelled lookup says nothing about the name; let the next caller retry
+        entry.expires = ec == asio::error::operation_aborted
+            ? std::chrono::steady_clock::time_point{}
+            : std::chrono::steady_clock::now() + (ec ? options_.negative_ttl : options_.positive_ttl);
+        entry.lookup.reset();
+    }
+    lookup->set();  // Wake callers waiting on this lookup
+
+    if (ec) {
+        throw asio::system_error(ec);
+    }
+    co_return endpoints;
+}
+
+void ResolverCache::invalidate(const std::string& host, const std::string& port) {
+    std::lock_guard lock(mutex_);
+    auto it = entries_.find(host + ":" + port);
+    if (it != entries_.end() && !it->second.lookup) {
+        entries_.erase(it);
+    }
+}
+
+void ResolverCache::clear() {
+    std::lock_guard lock(mutex_);
+    std::erase_if(entries_, [](const auto& item) { return !item.second.lookup; });
+}
+
+// ============================================================================
+// RateLimiter
+// ============================================================================
+
+namespace {
+
+std::optional<double> header_number(const Response& response, std::string_view name) {
+    auto it = response.headers.find(name);
+    if (it == response.headers.end()) {
+        return std::nullopt;
+    }
+    double value = 0;
+    auto text = trim(it->second);
+    auto [end, ec] = std::from_chars(text.data(), text.data() + text.size(), value);
+    if (ec != std::errc{} || end == text.data()) {
+        return std::nullopt;
+    }
+    return value;
+}
+
+double minutes_between(std::chrono::steady_clock::time_point from, std::chrono::steady_clock::time_point to) {
+    return std::chrono::duration<double, std::ratio<60>>(to - from).count();
+}
+
+} // namespace
+
+std::optional<std::chrono::milliseconds> parse_reset_duration(std::string_view text) {
+    text = trim(text);
+    double total_ms = 0;
+    bool any = false;
+    while (!text.empty()) {
+        double value = 0;
+        auto [end, ec] = std::from_chars(text.data(), text.data() + text.size(), value);
+        if (ec != std::errc{}) {
+            return std::nullopt;
+        }
+        text.remove_prefix(static_cast<std::size_t>(end - text.data()));
+        if (text.starts_with("ms")) {
+            total_ms += value;
+            text.remove_prefix(2);
+        } else if (text.starts_with("h")) {
+            total_ms += value * 3600000.0;
+            text.remove_prefix(1);
+        } else if (text.starts_with("m")) {
+            total_ms += value * 60000.0;
+            text.remove_prefix(1);
+        } else if (text.starts_with("s") || text.empty()) {
+            total_ms += value * 1000.0;
+            text.remove_prefix(text.empty() ? 0 : 1);
+        } else {
+            return std::nullopt;
+        }
+        any = true;
+    }
+    if (!any) {
+        return std::nullopt;
+    }
+    return std::chrono::milliseconds(static_cast<std::int64_t>(std::ceil(total_ms)));
+}
+
+std::optional<std::chrono::milliseconds> retry_after(const Response& response) {
+    if (auto ms = header_number(response, "retry-after-ms")) {
+        return std::chrono::milliseconds(static_cast<std::int64_t>(std::max(*ms, 0.0)));
+    }
+    // HTTP-date values are not used by the API and are ignored
+    if (auto seconds = header_number(response, "retry-after")) {
+        return std::chrono::milliseconds(static_cast<std::int64_t>(std::max(*seconds, 0.0) * 1000.0));
+    }
+    return std::nullopt;
+}
+
+void RateLimiter::Limit::refill(double minutes) {
+    if (capacity > 0) {
+        level = std::min(capacity, level + capacity * minutes);
+    }
+}
+
+double RateLimiter::Limit::deficit_minutes(double cost) const {
+    if (capacity <= 0) {
+        return 0;
+    }
+    cost = std::min(cost, capacity);
+    return level >= cost ? 0 : (cost - level) / capacity;
+}
+
+void RateLimiter::Limit::take(double cost) {
+    if (capacity > 0) {
+        level -= std::min(cost, capacity);
+    }
+    in_flight += cost;
+}
+
+// The server's remaining count does not yet include requests still in
+// flight from here, so they are subtracted again
+void RateLimiter::Limit::update(std::optional<double> limit, std::optional<double> remaining) {
+    if (limit && *limit > 0) {
+        if (capacity <= 0) {
+            level = *limit;
+        }
+        capacity = *limit;
+    }
+    if (remaining && capacity > 0) {
+        level = *remaining - in_flight;
+    }
+}
+
+RateLimiter::Bucket& RateLimiter::bucket(const std::string& model, Clock::time_point now) {
+    auto [it, inserted] = buckets_.try_emplace(model);
+    auto& bucket = it->second;
+    if (inserted) {
+        bucket.requests.capacity = bucket.requests.level = static_cast<double>(options_.requests_per_minute);
+        bucket.tokens.capacity = bucket.tokens.level = static_cast<double>(options_.tokens_per_minute);
+        bucket.refilled = now;
+    }
+    auto minutes = minutes_between(bucket.refilled, now);
+    bucket.requests.refill(minutes);
+    bucket.tokens.refill(minutes);
+    bucket.refilled = now;
+    return bucket;
+}
+
+asio::awaitable<void> RateLimiter::acquire(const std::string& model, std::uint64_t tokens) {
+    auto wait = reserve(model, tokens);
+    if (wait > Clock::duration::zero()) {
+        asio::steady_timer timer(co_await asio::this_coro::executor, wait);
+        std::error_code ec;
+        co_await timer.async_wait(asio::redirect_error(asio::use_awaitable, ec));
+    }
+}
+
+RateLimiter::Clock::duration RateLimiter::reserve(const std::string& model, std::uint64_t tokens) {
+    if (!options_.enabled) {
+        return {};
+    }
+
+    // Reserve now; the caller sleeps off the deficit and later callers queue behind it
+    Clock::duration wait{};
+    {
+        std::lock_guard lock(mutex_);
+        auto now = Clock::now();
+        auto& bucket = this->bucket(model, now);
+        auto minutes = std::max(bucket.requests.deficit_minutes(1.0),
+                                bucket.tokens.deficit_minutes(static_cast<double>(tokens)));
+        bucket.requests.take(1.0);
+        bucket.tokens.take(static_cast<double>(tokens));
+        wait = std::max(std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double, std::ratio<60>>(minutes)),
+                        bucket.blocked_until - now);
+    }
+    ++metrics_.admitted;
+
+    if (wait > Clock::duration::zero()) {
+        ++metrics_.delayed;
+        metrics_.wait_ms += static_cast<std::uint64_t>(std::chrono::ceil<std::chrono::milliseconds>(wait).count());
+    }
+    return wait;
+}
+
+void RateLimiter::release(const std::string& model, std::uint64_t tokens, const Response& response) {
+    if (!options_.enabled) {
+        return;
+    }
+    auto limit_requests = header_number(response, "x-ratelimit-limit-requests");
+    auto limit_tokens = header_number(response, "x-ratelimit-limit-tokens");
+    auto remaining_requests = header_number(response, "x-ratelimit-remaining-requests");
+    auto remaining_tokens = header_number(response, "x-ratelimit-remaining-tokens");
+    bool has_headers = limit_requests || limit_tokens || remaining_requests || remaining_tokens;
+
+    std::lock_guard lock(mutex_);
+    auto now = Clock::now();
+    auto& bucket = this->bucket(model, now);
+    bucket.requests.in_flight = std::max(0.0, bucket.requests.in_flight - 1.0);
+    bucket.tokens.in_flight = std::max(0.0, bucket.tokens.in_flight - static_cast<double>(tokens));
+    if (has_headers) {
+        ++metrics_.header_updates;
+        bucket.requests.update(limit_requests, remaining_requests);
+        bucket.tokens.update(limit_tokens, remaining_tokens);
+    }
+
+    if (response.status_code == 429) {
+        ++metrics_.rate_limited;
+        auto pause = retry_after(response);
+        for (auto name : {"x-ratelimit-reset-requests", "x-ratelimit-reset-tokens"}) {
+            if (pause) {
+                break;
+            }
+            if (auto it = response.headers.find(name); it != response.headers.end()) {
+                pause = parse_reset_duration(it->second);
+            }
+        }
+        bucket.blocked_until = std::max(bucket.blocked_until, now + pause.value_or(options_.rate_limited_pause));
+    }
+}
+
+std::pair<double, double> RateLimiter::available(const std::string& model) {
+    std::lock_guard lock(mutex_);
+    auto& bucket = this->bucket(model, Clock::now());
+    return {bucket.requests.level, bucket.tokens.level};
+}
+
+// ============================================================================
+// Hedger
+// ============================================================================
+
+std::chrono::milliseconds Hedger::begin() {
+    ++metrics_.requests;
+    std::lock_guard lock(mutex_);
+    if (samples_.size() < std::max<std::size_t>(options_.min_samples, 1)) {
+        return std::max(options_.initial_delay, options_.min_delay);
+    }
+    auto sorted = samples_;
+    auto rank = static_cast<std::size_t>(std::clamp(options_.percentile, 0.0, 1.0) * static_cast<double>(sorted.size() - 1));
+    std::ranges::nth_element(sorted, sorted.begin() + static_cast<std::ptrdiff_t>(rank));
+    return std::max(sorted[rank], options_.min_delay);
+}
+
+bool Hedger::try_hedge() {
+    // One hedge is allowed up front so a cold client can still hedge
+    auto allowed = 1.0 + options_.max_extra_load * static_cast<double>(metrics_.requests.load());
+    if (static_cast<double>(metrics_.hedges.load() + 1) > allowed) {
+        ++metrics_.denied;
+        return false;
+    }
+    ++metrics_.hedges;
+    return true;
+}
+
+void Hedger::finish(std::chrono::milliseconds latency, bool hedge_won) {
+    if (hedge_won) {
+        ++metrics_.won;
+    }
+    std::lock_guard lock(mutex_);
+    const auto window = std::max<std::size_t>(options_.window, 1);
+    if (samples_.size() < window) {
+        samples_.push_back(latency);
+    } else {
+        samples_[next_sample_] = latency;
+        next_sample_ = (next_sample_ + 1) % window;
+    }
+}
+
+// ============================================================================
+// TlsSessionCache
+// ============================================================================
+
+std::shared_ptr<void> TlsSessionCache::take(const std::string& host) {
+    std::lock_guard lock(mutex_);
+    auto it = sessions_.find(host);
+    if (it == sessions_.end()) {
+        return nullptr;
+    }
+
+    auto session = it->second;
+    if (SSL_SESSION_get_protocol_version(static_cast<SSL_SESSION*>(session.get())) >= TLS1_3_VERSION) {
+        sessions_.erase(it);
+    }
+    return session;
+}
+
+void TlsSessionCache::put(const std::string& host, std::shared_ptr<void> session) {
+    std::lock_guard lock(mutex_);
+    if (sessions_.size() >= max_entries_ && !sessions_.contains(host)) {
+        sessions_.erase(sessions_.begin());
+    }
+    sessions_[host] = std::move(session);
+}
+
+void TlsSessionCache::remove(const std::string& host) {
+    std::lock_guard lock(mutex_);
+    sessions_.erase(host);
+}
+
+void TlsSessionCache::clear() {
+    std::lock_guard lock(mutex_);
+    sessions_.clear();
+}
+
+std::size_t TlsSessionCache::size() const {
+    std::lock_guard lock(mutex_);
+    return sessions_.size();
+}
+
+// ============================================================================
+// ConnectionPool
+// ============================================================================
+
+ConnectionPool::ConnectionPool(asio::any_io_executor executor, PoolOptions options, Metrics& metrics)
+    : executor_(std::move(executor))
+    , options_(options)
+    , metrics_(metrics)
+    , state_(std::make_shared<State>(executor_)) {}
+
+ConnectionPool::~ConnectionPool() {
+    state_->closed = true;
+    state_->sweep_timer.cancel();
+    clear();
+    for (auto& [key, host] : state_->hosts) {
+        if (host.slot_freed) {
+            host.slot_freed->cancel();
+        }
+    }
+}
+
+asio::awaitable<void> ConnectionPool::acquire_slot(const std::string& key, const std::function<bool()>& abandoned) {
+    auto& host = state_->hosts[key];
+    while (host.active >= options_.max_connections_per_host) {
+        if (abandoned && abandoned()) {
+            throw std::runtime_error("Abandoned while waiting for a connection");
+        }
+        if (!host.slot_freed) {
+            host.slot_freed = std::make_unique<asio::steady_timer>(
+                executor_, asio::steady_timer::time_point::max()
+            );
+        }
+        std::error_code ec;
+        co_await host.slot_freed->async_wait(asio::redirect_error(asio::use_awaitable, ec));
+        if (state_->closed) {
+            throw std::runtime_error("Connection pool closed");
+        }
+    }
+    ++host.active;
+}
+
+void ConnectionPool::release_slot(const std::string& key) {
+    auto& host = state_->hosts[key];
+    if (host.active > 0) {
+        --host.active;
+    }
+    if (host.slot_freed) {
+        // Wake every waiter; each re-checks the limit
+        host.slot_freed->cancel();
+    }
+}
+
+void ConnectionPool::wake_waiters() {
+    for (auto& [key, host] : state_->hosts) {
+        if (host.slot_freed) {
+            host.slot_freed->cancel();
+        }
+    }
+}
+
+std::unique_ptr<Connection> ConnectionPool::take_idle(const std::string& key) {
+    auto it = state_->hosts.find(key);
+    if (it == state_->hosts.end()) {
+        return nullptr;
+    }
+
+    auto& idle = it->second.idle;
+    auto now = std::chrono::steady_clock::now();
+    while (!idle.empty()) {
+        auto connection = std::move(idle.back());
+        idle.pop_back();
+
+        if (now - connection->idle_since >= options_.idle_timeout) {
+            connection->close();
+            ++metrics_.idle_evictions;
+            continue;
+        }
+        if (connection->is_stale()) {
+            connection->close();
+            ++metrics_.stale_connections;
+            continue;
+        }
+        return connection;
+    }
+    return nullptr;
+}
+
+void ConnectionPool::put_idle(const std::string& key, std::unique_ptr<Connection> connection) {
+    auto& host = state_->hosts[key];
+    auto now = std::chrono::steady_clock::now();
+    std::erase_if(host.idle, [&](std::unique_ptr<Connection>& idle) {
+        if (now - idle->idle_since >= options_.idle_timeout) {
+            idle->close();
+            ++metrics_.idle_evictions;
+            return true;
+        }
+        return false;
+    });
+
+    connection->idle_since = now;
+    host.idle.push_back(std::move(connection));
+
+    // Over the idle limit: drop the least recently used connections
+    while (host.idle.size() > options_.max_idle_per_host) {
+        host.idle.front()->close();
+        host.idle.pop_front();
+        ++metrics_.idle_evictions;
+    }
+
+    release_slot(key);
+    start_sweeper();
+}
+
+void ConnectionPool::clear() {
+    for (auto& [key, host] : state_->hosts) {
+        for (auto& connection : host.idle) {
+            connection->close();
+        }
+        host.idle.clear();
+    }
+}
+
+std::size_t ConnectionPool::idle_count() const {
+    std::size_t count = 0;
+    for (const auto& [key, host] : state_->hosts) {
+        count += host.idle.size();
+    }
+    return count;
+}
+
+void ConnectionPool::start_sweeper() {
+    if (!options_.background_sweep || state_->sweeping || state_->closed) {
+        return;
+    }
+    state_->sweeping = true;
+    asio::co_spawn(executor_, sweep_idle(state_, options_, &metrics_), asio::detached);
+}
+
+asio::awaitable<void> ConnectionPool::sweep_idle(std::shared_ptr<State> state, PoolOptions options, Metrics* metrics) {
+    auto interval = std::max<std::chrono::milliseconds>(
+        options.idle_timeout / 2, std::chrono::milliseconds(100)
+    );
+
+    while (!state->closed) {
+        state->sweep_timer.expires_after(interval);
+        std::error_code ec;
+        co_await state->sweep_timer.async_wait(asio::redirect_error(asio::use_awaitable, ec));
+        if (state->closed) {
+            co_return;
+        }
+
+        auto now = std::chrono::steady_clock::now();
+        std::size_t remaining = 0;
+        for (auto& [key, host] : state->hosts) {
+            std::erase_if(host.idle, [&](std::unique_ptr<Connection>& connection) {
+                if (now - connection->idle_since >= options.idle_timeout || connection->is_stale()) {
+                    connection->close();
+                    ++metrics->idle_evictions;
+                    return true;
+                }
+                return false;
+            });
+            remaining += host.idle.size();
+        }
+
+        if (remaining == 0) {
+            state->sweeping = false;
+            co_return;
+        }
+    }
+}
+
+// ============================================================================
+// SseParser
+// ============================================================================
+
+void SseParser::feed(std::string_view bytes) {
+    while (!bytes.empty()) {
+        if (skip_lf_) {
+            skip_lf_ = false;
+            if (bytes.front() == '\n') {
+                bytes.remove_prefix(1);
+                continue;
+            }
+        }
+
+        auto end = bytes.find_first_of("\r\n");
+        if (end == std::string_view::npos) {
+            line_.append(bytes);
+            return;
+        }
+
+        std::string_view line = bytes.substr(0, end);
+        if (!line_.empty()) {
+            line_.append(line);
+            line = line_;
+        }
+
+        if (bytes[end] == '\r') {
+            if (end + 1 == bytes.size()) {
+                skip_lf_ = true;
+            } else if (bytes[end + 1] == '\n') {
+                ++end;
+            }
+        }
+        bytes.remove_prefix(end + 1);
+
+        process_line(line);
+        line_.clear();
+    }
+}
+
+void SseParser::process_line(std::string_view line) {
+    // A blank line dispatches the buffered event
+    if (line.empty()) {
+        if (has_data_) {
+            if (event_.data.ends_with('\n')) {
+                event_.data.pop_back();
+            }
+            on_event_(event_);
+        }
+        event_.data.clear();
+        event_.event.clear();
+        has_data_ = false;
+        return;
+    }
+
+    // Comment, e.g. keep-alive pings
+    if (line.front() == ':') {
+        return;
+    }
+
+    auto colon = line.find(':');
+    auto field = line.substr(0, colon);
+    std::string_view value;
+    if (colon != std::string_view::npos) {
+        value = line.substr(colon + 1);
+        if (value.starts_with(' ')) {
+            value.remove_prefix(1);
+        }
+    }
+
+    if (field == "data") {
+        event_.data.append(value);
+        event_.data.push_back('\n');
+        has_data_ = true;
+    } else if (field == "event") {
+        event_.event.assign(value);
+    } else if (field == "id" && value.find('\0') == std::string_view::npos) {
+        event_.id.assign(value);
+    }
+}
+
+// ============================================================================
+// Client::Watch
+// ============================================================================
+
+// Tracks one request against its Timeouts. A watcher coroutine sleeps until
+// the nearest deadline; when one passes, or the request is cancelled, the
+// current phase's abort hook runs (closing the socket, waking a queue wait)
+// so the pending operation fails and the request reports why.
+class Client::Watch {
+public:
+    Watch(Client& client, const Request& req);
+    ~Watch();
+
+    Watch(const Watch&) = delete;
+    Watch& operator=(const Watch&) = delete;
+
+    // Start a phase limited to limit (zero: only the total applies); the
+    // abort hook is kept
+    void enter(std::string_view phase, std::chrono::milliseconds limit);
+
+    // Hook that makes the operation in progress fail; empty when there is
+    // nothing to interrupt
+    void set_abort(std::function<void()> abort);
+
+    // The response started: from now on idle_read bounds the gap between reads
+    void reading();
+
+    // Response data arrived
+    void progress();
+
+    // Throw if the request has timed out or been cancelled
+    void check() const;
+
+    void cancel();
+
+    // Abandon the request in favour of another attempt (not counted as a cancellation)
+    void supersede();
+
+    // Called once when the response starts arriving
+    void on_start(std::function<void()> callback) { state_->on_start = std::move(callback); }
+
+    bool failed() const { return !state_->failure.empty(); }
+    const Timeouts& timeouts() const { return state_->timeouts; }
+
+    // Error response for a request that failed with what, naming the timeout
+    // or cancellation when that was the cause
+    Response failure_response(std::string_view prefix, std::string_view what) const;
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    struct State {
+        explicit State(asio::any_io_executor executor) : timer(std::move(executor)) {}
+
+        Clock::time_point next_deadline() const;
+        void fail(std::string reason);
+
+        asio::steady_timer timer;
+        Timeouts timeouts;
+        Clock::time_point total_deadline{Clock::time_point::max()};
+        Clock::time_point phase_deadline{Clock::time_point::max()};
+        Clock::time_point last_read;
+        bool reading{false};
+        std::string phase;
+        std::chrono::milliseconds phase_limit{0};
+        std::function<void()> abort;
+        std::function<void()> on_start;
+        std::string failure;
+        bool timed_out{false};
+        bool cancelled{false};
+        bool finished{false};
+    };
+
+    static asio::awaitable<void> run(std::shared_ptr<State> state, Metrics& metrics);
+
+    // Wake the watcher if deadline is earlier than the one it sleeps until
+    void reschedule(Clock::time_point deadline);
+
+    Client& client_;
+    std::shared_ptr<State> state_;
+};
+
+Client::Watch::Watch(Client& client, const Request& req)
+    : client_(client)
+    , state_(std::make_shared<State>(client.strand_)) {
+    // Request fields override the client defaults one by one; no_limit
+    // (or any negative value) turns a default off
+    const auto& defaults = client.default_timeouts_;
+    auto pick = [](std::chrono::milliseconds value, std::chrono::milliseconds fallback) {
+        if (value.count() < 0) {
+            return std::chrono::milliseconds{0};
+        }
+        return value.count() > 0 ? value : std::max(fallback, std::chrono::milliseconds{0});
+    };
+    auto& timeouts = state_->timeouts;
+    timeouts.connect = pick(req.timeouts.connect, defaults.connect);
+    timeouts.handshake = pick(req.timeouts.handshake, defaults.handshake);
+    timeouts.first_byte = pick(req.timeouts.first_byte, defaults.first_byte);
+    timeouts.idle_read = pick(req.timeouts.idle_read, defaults.idle_read);
+    timeouts.total = pick(req.timeouts.total, defaults.total);
+
+    if (timeouts.total.count() > 0) {
+        state_->total_deadline = Clock::now() + timeouts.total;
+    }
+    client_.watches_.insert(this);
+
+    const bool limited = timeouts.connect.count() > 0 || timeouts.handshake.count() > 0 ||
+                         timeouts.first_byte.count() > 0 || timeouts.idle_read.count() > 0 ||
+                         timeouts.total.count() > 0;
+    if (limited) {
+        asio::co_spawn(client.strand_, run(state_, client.metrics_), asio::detached);
+    }
+}
+
+Client::Watch::~Watch() {
+    client_.watches_.erase(this);
+    state_->finished = true;
+    state_->abort = {};
+    state_->on_start = {};
+    state_->timer.cancel();
+}
+
+void Client::Watch::enter(std::string_view phase, std::chrono::milliseconds limit) {
+    state_->phase = phase;
+    state_->phase_limit = limit;
+    state_->reading = false;
+    state_->phase_deadline = limit.count() > 0 ? Clock::now() + limit : Clock::time_point::max();
+    reschedule(state_->phase_deadline);
+}
+
+void Client::Watch::set_abort(std::function<void()> abort) {
+    state_->abort = std::move(abort);
+}
+
+void Client::Watch::reading() {
+    state_->phase = "read";
+    state_->phase_deadline = Clock::time_point::max();
+    state_->reading = true;
+    state_->last_read = Clock::now();
+    if (state_->timeouts.idle_read.count() > 0) {
+        reschedule(state_->last_read + state_->timeouts.idle_read);
+    }
+    if (auto callback = std::move(state_->on_start)) {
+        state_->on_start = {};
+        callback();
+    }
+}
+
+void Client::Watch::progress() {
+    state_->last_read = Clock::now();
+}
+
+void Client::Watch::check() const {
+    if (failed()) {
+        throw std::runtime_error(state_->failure);
+    }
+}
+
+void Client::Watch::cancel() {
+    if (failed() || state_->finished) {
+        return;
+    }
+    state_->cancelled = true;
+    ++client_.metrics_.cancellations;
+    state_->fail("request cancelled");
+    state_->timer.cancel();
+}
+
+void Client::Watch::supersede() {
+    if (failed() || state_->finished) {
+        return;
+    }
+    state_->fail("superseded by a hedged request");
+    state_->timer.cancel();
+}
+
+Response Client::Watch::failure_response(std::string_view prefix, std::string_view what) const {
+    Response response{0, "", {}, true, fmt::format("{}: {}", prefix, failed() ? state_->failure : what)};
+    response.timed_out = state_->timed_out;
+    response.cancelled = state_->cancelled;
+    return response;
+}
+
+void Client::Watch::reschedule(Clock::time_point deadline) {
+    if (deadline < state_->timer.expiry()) {
+        state_->timer.cancel();
+    }
+}
+
+Client::Watch::Clock::time_point Client::Watch::State::next_deadline() const {
+    auto deadline = std::min(total_deadline, phase_deadline);
+    if (reading && timeouts.idle_read.count() > 0) {
+        deadline = std::min(deadline, last_read + timeouts.idle_read);
+    }
+    return deadline;
+}
+
+void Client::Watch::State::fail(std::string reason) {
+    failure = std::move(reason);
+    if (auto hook = std::move(abort)) {
+        abort = {};
+        hook();
+    }
+}
+
+// Deadlines only move later except through enter()/reading(), which wake the
+// timer, so each expiry re-checks which limit (if any) has really passed
+asio::awaitable<void> Client::Watch::run(std::shared_ptr<State> state, Metrics& metrics) {
+    while (!state->finished && state->failure.empty()) {
+        state->timer.expires_at(state->next_deadline());
+        std::error_code ec;
+        co_await state->timer.async_wait(asio::redirect_error(asio::use_awaitable, ec));
+        if (state->finished || !state->failure.empty()) {
+            co_return;
+        }
+
+        const auto now = Clock::now();
+        std::string reason;
+        if (now >= state->total_deadline) {
+            reason = fmt::format("request timed out after {} ms", state->timeouts.total.count());
+        } else if (state->reading && state->timeouts.idle_read.count() > 0 &&
+                   now >= state->last_read + state->timeouts.idle_read) {
+            reason = fmt::format("no response data for {} ms", state->timeouts.idle_read.count());
+        } else if (now >= state->phase_deadline) {
+            reason = fmt::format("{} timed out after {} ms", state->phase, state->phase_limit.count());
+        }
+        if (!reason.empty()) {
+            state->timed_out = true;
+            ++metrics.timeouts;
+            state->fail(std::move(reason));
+        }
+    }
+}
+
+// ============================================================================
+// Client
+// ============================================================================
+
+Client::Client(asio::io_context& io_context, PoolOptions pool_options)
     : io_context_(io_context)
-    , ssl_context_(asio::ssl::context::tlsv12_client) {
-    
+    , strand_(asio::make_strand(io_context))
+    , ssl_context_(asio::ssl::context::tls_client)
+    , resolver_cache_(std::make_shared<ResolverCache>())
+    , pool_(strand_, pool_options, metrics_) {
+
     ssl_context_.set_default_verify_paths();
     ssl_context_.set_verify_mode(asio::ssl::verify_none);
+
+    // TLS 1.2 or 1.3, with client-side session caching handled by session_cache_
+    auto* native = ssl_context_.native_handle();
+    SSL_CTX_set_min_proto_version(native, TLS1_2_VERSION);
+    SSL_CTX_set_session_cache_mode(native, SSL_SESS_CACHE_CLIENT | SSL_SESS_CACHE_NO_INTERNAL_STORE);
+    SSL_CTX_set_ex_data(native, session_cache_index(), &session_cache_);
+    SSL_CTX_sess_set_new_cb(native, &on_new_session);
 }
 
-asio::awaitable<Response> Client::async_request(const Request& req) {
-    if (req.use_ssl) {
-        co_return co_await async_https_request(req);
+Client::~Client() {
+    // Nothing may be running on the strand by now; close sessions directly
+    for (auto& [key, host] : http2_hosts_) {
+        if (host.session) {
+            host.session->close();
+        }
+    }
+}
+
+void Client::set_http_version(HttpVersion version) {
+    // ALPN protocol list in wire format (length-prefixed names)
+    static constexpr unsigned char h2_protocols[] = {2, 'h', '2', 8, 'h', 't', 't', 'p', '/', '1', '.', '1'};
+
+    http_version_ = version;
+    if (version == HttpVersion::Http2) {
+        SSL_CTX_set_alpn_protos(ssl_context_.native_handle(), h2_protocols, sizeof(h2_protocols));
     } else {
-        co_return co_await async_http_request(req);
+        SSL_CTX_set_alpn_protos(ssl_context_.native_handle(), nullptr, 0);
     }
 }
 
-Response Client::request(const Request& req) {
-    Response result;
-    
-    asio::co_spawn(
-        io_context_,
-        [this, req, &result]() -> asio::awaitable<void> {
-            result = co_await async_request(req);
-        },
-        asio::detached
-    );
-    
-    io_context_.run();
-    io_context_.restart();
-    
-    return result;
+void Client::close_http2_sessions() {
+    asio::dispatch(strand_, [this] {
+        for (auto& [key, host] : http2_hosts_) {
+            if (host.session) {
+                host.session->close();
+            }
+        }
+        http2_hosts_.clear();
+    });
 }
 
-asio::awaitable<Response> Client::async_https_request(const Request& req) {
-    try {
-        auto executor = co_await asio::this_coro::executor;
-        asio::ssl::stream<asio::ip::tcp::socket> socket(executor, ssl_context_);
-        
-        SSL_set_tlsext_host_name(socket.native_handle(), req.host.c_str());
-
-        asio::ip::tcp::resolver resolver(executor);
-        auto endpoints = co_await resolver.async_resolve(
-            req.host, "443", asio::use_awaitable
-        );
+asio::awaitable<Response> Client::async_request(const Request& req) {
+    co_return co_await asio::co_spawn(strand_, send(req), asio::use_awaitable);
+}
 
-        co_await asio::async_connect(
-            socket.lowest_layer(), endpoints, asio::use_awaitable
-        );
+asio::awaitable<Response> Client::send(const Request& req) {
+    if (auto compressed = compressed_request(req)) {
+        ++metrics_.requests;
+        Response response;
+        {
+            Watch watch(*this, *compressed);
+            response = co_await dispatch(*compressed, watch);
+        }
+        if (response.status_code != 415) {
+            co_return response;
+        }
+        // The server does not take compressed bodies; send this one as is
+        ++metrics_.compression_rejected;
+        uncompressed_hosts_.insert(connection_key(req));
+    }
 
-        co_await socket.async_handshake(
-            asio::ssl::stream_base::client, asio::use_awaitable
-        );
+    ++metrics_.requests;
+    Watch watch(*this, req);
+    co_return co_await dispatch(req, watch);
+}
 
-        std::string request_str = build_request_string(req);
-        co_await asio::async_write(
-            socket, asio::buffer(request_str), asio::use_awaitable
-        );
+std::optional<Request> Client::compressed_request(const Request& req) {
+    if (!compression_.compress_requests || req.body_stream || req.body.size() < compression_.min_request_size ||
+        req.headers.contains("Content-Encoding") || uncompressed_hosts_.contains(connection_key(req))) {
+        return std::nullopt;
+    }
 
-        asio::streambuf response_buf;
-        co_await asio::async_read_until(
-            socket, response_buf, "\r\n", asio::use_awaitable
-        );
+    const auto start = std::chrono::steady_clock::now();
+    std::string body;
+    try {
+        body = gzip_compress(req.body, compression_.level);
+    } catch (const std::exception&) {
+        return std::nullopt;
+    }
+    metrics_.compression_us += static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now() - start).count());
 
-        std::istream response_stream(&response_buf);
-        std::string http_version;
-        int status_code;
-        std::string status_message;
-        
-        response_stream >> http_version >> status_code;
-        std::getline(response_stream, status_message);
+    // Incompressible bodies go out as they are
+    if (body.size() >= req.body.size()) {
+        return std::nullopt;
+    }
+    ++metrics_.requests_compressed;
+    metrics_.request_bytes_raw += req.body.size();
+    metrics_.request_bytes_compressed += body.size();
 
-        co_await asio::async_read_until(
-            socket, response_buf, "\r\n\r\n", asio::use_awaitable
-        );
-        
-        std::map<std::string, std::string> headers;
-        std::string header_line;
-        while (std::getline(response_stream, header_line) && header_line != "\r") {
-            auto pos = header_line.find(':');
-            if (pos != std::string::npos) {
-                std::string key = header_line.substr(0, pos);
-                std::string value = header_line.substr(pos + 2);
-                if (!value.empty() && value.back() == '\r') {
-                    value.pop_back();
-                }
-                headers[key] = value;
+    Request compressed = req;
+    compressed.body = std::move(body);
+    compressed.headers["Content-Encoding"] = "gzip";
+    return compressed;
+}
+
+asio::awaitable<Response> Client::dispatch(const Request& req, Watch& watch) {
+    if (req.use_ssl && http_version_ == HttpVersion::Http2) {
+        co_return co_await async_http2_request(req, watch);
+    }
+    co_return co_await async_pooled_request(req, watch);
+}
+
+// Shared by async_hedged_request() and its attempts, which may outlive it
+struct Client::HedgeRace {
+    HedgeRace(asio::any_io_executor executor, Request req)
+        : signal(std::move(executor), std::chrono::steady_clock::time_point::max())
+        , request(std::move(req)) {}
+
+    // Abandon the attempts still running
+    void supersede_all() {
+        for (auto* watch : watches) {
+            if (watch) {
+                watch->supersede();
             }
         }
+    }
 
-        std::ostringstream body_stream;
-        if (response_buf.size() > 0) {
-            body_stream << &response_buf;
-        }
+    asio::steady_timer signal;  // Cancelled when an attempt starts answering or finishes
+    Request request;
+    std::array<Watch*, 2> watches{};
+    int running{0};
+    bool started{false};  // The original attempt's response started
+    std::optional<std::chrono::steady_clock::time_point> original_done;  // Started answering or finished
+    std::optional<Response> winner;
+    int winner_index{-1};
+};
 
-        auto content_length_it = headers.find("Content-Length");
-        if (content_length_it != headers.end()) {
-            std::size_t content_length = std::stoull(content_length_it->second);
-            std::size_t remaining = content_length - body_stream.str().size();
-            
-            if (remaining > 0) {
-                std::vector<char> buffer(remaining);
-                co_await asio::async_read(
-                    socket, asio::buffer(buffer), asio::use_awaitable
-                );
-                body_stream.write(buffer.data(), buffer.size());
-            }
-        } else {
-            std::error_code ec;
-            while (true) {
-                std::size_t bytes_transferred = co_await asio::async_read(
-                    socket, response_buf, asio::transfer_at_least(1),
-                    asio::redirect_error(asio::use_awaitable, ec)
-                );
-                
-                if (ec == asio::error::eof) break;
-                if (ec) {
-                    co_return Response{0, "", {}, true, 
-                        fmt::format("Error reading body: {}", ec.message())};
+asio::awaitable<Response> Client::async_hedged_request(const Request& req, std::shared_ptr<Hedger> hedger) {
+    if (!hedger || req.on_body_chunk) {
+        co_return co_await async_request(req);
+    }
+    co_return co_await asio::co_spawn(strand_, send_hedged(req, std::move(hedger)), asio::use_awaitable);
+}
+
+asio::awaitable<Response> Client::send_hedged(const Request& req, std::shared_ptr<Hedger> hedger) {
+    using Clock = std::chrono::steady_clock;
+    const auto start = Clock::now();
+    const auto hedge_at = start + hedger->begin();
+    auto compressed = compressed_request(req);
+    const bool compressing = compressed.has_value();
+    auto race = std::make_shared<HedgeRace>(strand_, compressing ? std::move(*compressed) : req);
+
+    race->running = 1;
+    asio::co_spawn(strand_, hedge_attempt(race, 0), asio::detached);
+
+    bool hedged = false;
+    try {
+        while (!race->winner) {
+            if (!hedged && !race->started && Clock::now() >= hedge_at) {
+                hedged = true;
+                if (hedger->try_hedge()) {
+                    ++race->running;
+                    asio::co_spawn(strand_, hedge_attempt(race, 1), asio::detached);
                 }
-                
-                body_stream << &response_buf;
             }
+            race->signal.expires_at(hedged || race->started ? Clock::time_point::max() : hedge_at);
+            std::error_code ec;
+            co_await race->signal.async_wait(asio::redirect_error(asio::use_awaitable, ec));
         }
+    } catch (...) {
+        race->supersede_all();
+        throw;
+    }
 
-        std::error_code shutdown_ec;
-        co_await socket.async_shutdown(
-            asio::redirect_error(asio::use_awaitable, shutdown_ec)
-        );
+    const auto original_done = race->original_done.value_or(Clock::now());
+    hedger->finish(std::chrono::duration_cast<std::chrono::milliseconds>(original_done - start), race->winner_index == 1);
+
+    // The server does not take compressed bodies; send this one as is
+    if (compressing && race->winner->status_code == 415) {
+        ++metrics_.compression_rejected;
+        uncompressed_hosts_.insert(connection_key(req));
+        co_return co_await send(req);
+    }
+    co_return std::move(*race->winner);
+}
 
-        co_return Response{status_code, body_stream.str(), headers, false, ""};
+// One attempt of a hedged request. A response wins unless it is a transport
+// error and the other attempt is still running; the loser is abandoned.
+asio::awaitable<void> Client::hedge_attempt(std::shared_ptr<HedgeRace> race, int index) {
+    ++metrics_.requests;
+    Watch watch(*this, race->request);
+    race->watches[index] = &watch;
+    if (index == 0) {
+        watch.on_start([race] {
+            race->started = true;
+            race->original_done = std::chrono::steady_clock::now();
+            race->signal.cancel();
+        });
+    }
 
-    } catch (const std::exception& e) {
-        co_return Response{0, "", {}, true, 
-            fmt::format("HTTPS request failed: {}", e.what())};
+    auto response = co_await dispatch(race->request, watch);
+    race->watches[index] = nullptr;
+    --race->running;
+    if (index == 0 && !race->original_done) {
+        race->original_done = std::chrono::steady_clock::now();
     }
+
+    if (!race->winner && (!response.is_error || race->running == 0)) {
+        race->winner = std::move(response);
+        race->winner_index = index;
+        race->supersede_all();
+    }
+    race->signal.cancel();
 }
 
-asio::awaitable<Response> Client::async_http_request(const Request& req) {
-    try {
-        auto executor = co_await asio::this_coro::executor;
-        asio::ip::tcp::socket socket(executor);
+void Client::cancel_all() {
+    ++cancel_generation_;
+    asio::dispatch(strand_, [this] {
+        // cancel() may complete requests, which unregister their watches
+        auto watches = std::vector<Watch*>(watches_.begin(), watches_.end());
+        for (auto* watch : watches) {
+            if (watches_.contains(watch)) {
+                watch->cancel();
+            }
+        }
+    });
+}
 
-        asio::ip::tcp::resolver resolver(executor);
-        auto endpoints = co_await resolver.async_resolve(
-            req.host, "80", asio::use_awaitable
-        );
+Response Client::request(const Request& req) {
+    if (io_context_.get_executor().running_in_this_thread()) {
+        throw std::logic_error("http::Client::request() called from an io_context thread; co_await async_request() instead");
+    }
+    return asio::co_spawn(strand_, send(req), asio::use_future).get();
+}
 
-        co_await asio::async_connect(socket, endpoints, asio::use_awaitable);
+asio::awaitable<std::unique_ptr<Connection>> Client::open_connection(const Request& req, Watch& watch) {
+    auto connection = std::make_unique<Connection>();
+    auto port = request_port(req);
+    auto resolver_cache = resolver_cache_;
 
-        std::string request_str = build_request_string(req);
-        co_await asio::async_write(
-            socket, asio::buffer(request_str), asio::use_awaitable
-        );
+    watch.enter("connect", watch.timeouts().connect);
+    auto endpoints = co_await resolve_abortable(resolver_cache, req.host, port, watch);
 
-        asio::streambuf response_buf;
-        co_await asio::async_read_until(
-            socket, response_buf, "\r\n", asio::use_awaitable
-        );
+    std::optional<asio::ip::tcp::socket> socket;
+    try {
+        socket.emplace(co_await race_connect(endpoints, resolver_cache->options().connect_attempt_delay, watch));
+        watch.check();
+    } catch (const std::exception&) {
+        // Every cached address failed; look the name up again next time
+        if (!watch.failed()) {
+            resolver_cache->invalidate(req.host, port);
+        }
+        throw;
+    }
+
+    if (req.use_ssl) {
+        connection->tls = std::make_unique<tls_stream>(std::move(*socket), ssl_context_);
+        auto* ssl = connection->tls->native_handle();
+        SSL_set_tlsext_host_name(ssl, req.host.c_str());
 
-        std::istream response_stream(&response_buf);
-        std::string http_version;
-        int status_code;
-        std::string status_message;
-        
-        response_stream >> http_version >> status_code;
-        std::getline(response_stream, status_message);
+        // Offer a cached session for an abbreviated handshake
+        if (auto session = session_cache_.take(req.host)) {
+            SSL_set_session(ssl, static_cast<SSL_SESSION*>(session.get()));
+        }
 
-        co_await asio::async_read_until(
-            socket, response_buf, "\r\n\r\n", asio::use_awaitable
+        watch.enter("TLS handshake", watch.timeouts().handshake);
+        watch.set_abort([tls = connection->tls.get()] {
+            std::error_code ec;
+            tls->lowest_layer().close(ec);
+        });
+        co_await connection->tls->async_handshake(
+            asio::ssl::stream_base::client, asio::use_awaitable
         );
-        
-        std::map<std::string, std::string> headers;
-        std::string header_line;
-        while (std::getline(response_stream, header_line) && header_line != "\r") {
-            auto pos = header_line.find(':');
-            if (pos != std::string::npos) {
-                std::string key = header_line.substr(0, pos);
-                std::string value = header_line.substr(pos + 2);
-                if (!value.empty() && value.back() == '\r') {
-                    value.pop_back();
-                }
-                headers[key] = value;
+        watch.set_abort({});
+        watch.check();
+
+        if (SSL_session_reused(ssl)) {
+            ++metrics_.tls_resumed_handshakes;
+        } else {
+            ++metrics_.tls_full_handshakes;
+        }
+
+        // TLS 1.2 sessions are resumable right away; TLS 1.3 tickets are not
+        // and reach the cache later through on_new_session.
+        if (SSL_SESSION* session = SSL_get1_session(ssl)) {
+            if (SSL_SESSION_is_resumable(session)) {
+                session_cache_.put(req.host, adopt_session(session));
+            } else {
+                SSL_SESSION_free(session);
             }
         }
+    } else {
+        connection->tcp = std::make_unique<asio::ip::tcp::socket>(std::move(*socket));
+    }
+
+    ++metrics_.connections_opened;
+    co_return connection;
+}
+
+// Stream-level phases are not tracked on a shared session: HTTP/2 requests
+// honour the connect, handshake and total limits
+asio::awaitable<Response> Client::async_http2_request(const Request& req, Watch& watch) {
+    const auto key = connection_key(req);
+    const auto headers = http2_headers(req, compression_.accept_encoding);
+
+    // A stream the server refused (REFUSED_STREAM, GOAWAY) was not processed;
+    // retry it once on a fresh session
+    for (int attempt = 0; ; ++attempt) {
+        std::shared_ptr<http2::Session> session;
+        try {
+            session = co_await http2_session(req, key, watch);
+        } catch (const std::exception& e) {
+            co_return watch.failure_response("HTTPS request failed", e.what());
+        }
 
-        std::ostringstream body_stream;
-        if (response_buf.size() > 0) {
-            body_stream << &response_buf;
+        if (!session) {
+            co_return co_await async_pooled_request(req, watch);
         }
 
-        std::error_code ec;
-        while (true) {
-            co_await asio::async_read(
-                socket, response_buf, asio::transfer_at_least(1),
-                asio::redirect_error(asio::use_awaitable, ec)
-            );
-            
-            if (ec == asio::error::eof) break;
-            if (ec) {
-                co_return Response{0, "", {}, true, 
-                    fmt::format("Error reading body: {}", ec.message())};
+        ++metrics_.http2_streams;
+        watch.enter("stream", {});
+        std::uint32_t stream_id = 0;
+        auto reset = [session, &stream_id] {
+            if (stream_id != 0) {
+                session->cancel(stream_id, "HTTP/2 stream cancelled");
             }
-            
-            body_stream << &response_buf;
+        };
+        watch.set_abort(reset);
+        auto on_open = [&watch, &stream_id, &reset](std::uint32_t id) {
+            stream_id = id;
+            if (watch.failed()) {
+                reset();  // Failed while waiting for a stream slot
+            }
+        };
+        try {
+            std::optional<BodyStream::Reader> reader;
+            std::function<std::string_view(std::size_t)> body_source;
+            if (req.body_stream) {
+                reader.emplace(*req.body_stream);
+                body_source = [&reader](std::size_t max_size) { return reader->next(max_size); };
+            }
+            // A streamed 2xx body is decoded as DATA frames arrive
+            std::unique_ptr<ContentDecoder> decoder;
+            std::function<void(std::string_view)> on_data;
+            std::function<void(const http2::Response&)> on_headers;
+            if (req.on_body_chunk) {
+                on_headers = [&req, &decoder](const http2::Response& response) {
+                    if (response.status >= 200 && response.status < 300) {
+                        decoder = ContentDecoder::create(header_value(response.headers, "content-encoding"));
+                        if (req.on_body_start) {
+                            req.on_body_start(decoder ? std::nullopt : content_length(response.headers));
+                        }
+                    }
+                };
+                on_data = [&req, &decoder](std::string_view data) {
+                    if (decoder) {
+                        decoder->feed(data, req.on_body_chunk);
+                    } else {
+                        req.on_body_chunk(data);
+                    }
+                };
+            }
+            auto result = co_await session->request(headers, req.body, std::move(on_data), on_open,
+                                                    std::move(body_source), std::move(on_headers));
+            watch.set_abort({});
+            if (decoder) {
+                decoder->finish();
+                strip_encoding(result.headers);
+                record_decoding(metrics_, *decoder);
+            }
+            co_return to_response(std::move(result), metrics_);
+        } catch (const http2::StreamError& e) {
+            watch.set_abort({});
+            if (e.retryable() && attempt == 0 && !watch.failed()) {
+                continue;
+            }
+            co_return watch.failure_response("HTTPS request failed", e.what());
+        } catch (const std::exception& e) {
+            // The streamed body could not be read, or the response not decoded
+            watch.set_abort({});
+            co_return watch.failure_response("HTTPS request failed", e.what());
+        }
+    }
+}
+
+asio::awaitable<std::shared_ptr<http2::Session>> Client::http2_session(const Request& req, const std::string& key,
+                                                                       Watch& watch) {
+    for (;;) {
+        auto& host = http2_hosts_[key];
+        if (host.session && host.session->is_usable()) {
+            co_return host.session;
+        }
+        if (host.http1_only) {
+            co_return nullptr;
+        }
+
+        // Concurrent requests share the session being established
+        if (host.connecting) {
+            auto connecting = host.connecting;
+            watch.set_abort([connecting] { connecting->cancel(); });
+            std::error_code ec;
+            co_await connecting->async_wait(asio::redirect_error(asio::use_awaitable, ec));
+            watch.set_abort({});
+            watch.check();
+            continue;
+        }
+
+        auto connecting = std::make_shared<asio::steady_timer>(strand_, std::chrono::steady_clock::time_point::max());
+        host.connecting = connecting;
+        host.session.reset();
+
+        std::unique_ptr<Connection> connection;
+        std::exception_ptr error;
+        try {
+            connection = co_await open_connection(req, watch);
+        } catch (...) {
+            error = std::current_exception();
         }
 
-        socket.close();
-        co_return Response{status_code, body_stream.str(), headers, false, ""};
+        // Look the entry up again: the map may have rehashed while connecting
+        auto& entry = http2_hosts_[key];
+        entry.connecting.reset();
+        connecting->cancel();
+        if (error) {
+            std::rethrow_exception(error);
+        }
+
+        const unsigned char* protocol = nullptr;
+        unsigned int protocol_length = 0;
+        SSL_get0_alpn_selected(connection->tls->native_handle(), &protocol, &protocol_length);
+        if (protocol_length == 2 && std::memcmp(protocol, "h2", 2) == 0) {
+            entry.session = std::make_shared<http2::Session>(std::move(connection->tls));
+            entry.session->start();
+            ++metrics_.http2_sessions_opened;
+            co_return entry.session;
+        }
+
+        // The server only speaks HTTP/1.1; keep this connection for the fallback
+        entry.http1_only = true;
+        if (pool_.options().keep_alive) {
+            co_await pool_.acquire_slot(key);
+            pool_.put_idle(key, std::move(connection));
+        } else {
+            connection->close();
+        }
+        co_return nullptr;
+    }
+}
 
+asio::awaitable<Response> Client::async_pooled_request(const Request& req, Watch& watch) {
+    const char* failure_prefix = req.use_ssl ? "HTTPS request failed" : "HTTP request failed";
+    const bool keep_alive = pool_.options().keep_alive;
+    const auto key = connection_key(req);
+    const std::string request_str = build_request_string(req);
+
+    watch.enter("queue", {});
+    watch.set_abort([this] { pool_.wake_waiters(); });
+    try {
+        co_await pool_.acquire_slot(key, [&watch] { return watch.failed(); });
+        watch.set_abort({});
     } catch (const std::exception& e) {
-        co_return Response{0, "", {}, true, 
-            fmt::format("HTTP request failed: {}", e.what())};
+        watch.set_abort({});
+        co_return watch.failure_response(failure_prefix, e.what());
+    }
+
+    // A reused connection may have been closed by the server after the stale
+    // check; retry once on a fresh connection if nothing was received.
+    for (int attempt = 0; ; ++attempt) {
+        std::unique_ptr<Connection> connection;
+        bool reused = false;
+        bool response_started = false;
+        bool reusable = false;
+
+        try {
+            if (keep_alive && attempt == 0) {
+                connection = pool_.take_idle(key);
+            }
+            reused = connection != nullptr;
+            if (reused) {
+                ++metrics_.connections_reused;
+            } else {
+                connection = co_await open_connection(req, watch);
+            }
+
+            // Closing the socket fails whatever read or write is pending
+            watch.set_abort([conn = connection.get()] { conn->close(); });
+            Response response;
+            if (connection->tls) {
+                response = co_await exchange(*connection->tls, connection->input, req, request_str, response_started, reusable, watch, metrics_);
+            } else {
+                response = co_await exchange(*connection->tcp, connection->input, req, request_str, response_started, reusable, watch, metrics_);
+            }
+
+            if (keep_alive && reusable && !response.is_error && !watch.failed()) {
+                watch.set_abort({});
+                pool_.put_idle(key, std::move(connection));
+            } else {
+                if (connection->tls) {
+                    std::error_code shutdown_ec;
+                    co_await connection->tls->async_shutdown(
+                        asio::redirect_error(asio::use_awaitable, shutdown_ec)
+                    );
+                }
+                watch.set_abort({});
+                connection->close();
+                pool_.release_slot(key);
+            }
+
+            co_return response;
+
+        } catch (const std::exception& e) {
+            watch.set_abort({});
+            if (connection) {
+                connection->close();
+            }
+            if (reused && !response_started && !watch.failed()) {
+                ++metrics_.stale_connections;
+                continue;
+            }
+            pool_.release_slot(key);
+            co_return watch.failure_response(failure_prefix, e.what());
+        }
     }
 }
 
 std::string Client::build_request_string(const Request& req) const {
     std::ostringstream request;
     request << req.method << " " << req.path << " HTTP/1.1\r\n";
-    request << "Host: " << req.host << "\r\n";
-    
+    request << "Host: " << request_authority(req) << "\r\n";
+
     for (const auto& [key, value] : req.headers) {
         request << key << ": " << value << "\r\n";
     }
-    
-    if (!req.body.empty()) {
-        request << "Content-Length: " << req.body.size() << "\r\n";
+
+    if (compression_.accept_encoding && !req.headers.contains("Accept-Encoding")) {
+        request << "Accept-Encoding: " << accepted_encodings << "\r\n";
+    }
+
+    if (auto length = content_length(req)) {
+        request << "Content-Length: " << *length << "\r\n";
     }
-    
-    request << "Connection: close\r\n\r\n";
-    
-    if (!req.body.empty()) {
+
+    request << (pool_.options().keep_alive ? "Connection: keep-alive\r\n\r\n" : "Connection: close\r\n\r\n");
+
+    // A streamed body is written after this, in pieces
+    if (!req.body_stream && !req.body.empty()) {
         request << req.body;
     }
-    
+
     return request.str();
 }
 
-} // namespace openai::http
\ No newline at end of file
+} // namespace openai::http
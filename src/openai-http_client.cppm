@@ -5,17 +5,91 @@ export module openai.http_client;
 
 import asio;
 import fmt;
+import openai.http2;
 import std;
 
 export namespace openai::http {
 
+// Case-insensitive ordering for header names (RFC 9110 section 5.1)
+struct HeaderNameLess {
+    using is_transparent = void;
+
+    bool operator()(std::string_view a, std::string_view b) const {
+        return std::lexicographical_compare(a.begin(), a.end(), b.begin(), b.end(), [](unsigned char x, unsigned char y) {
+            return std::tolower(x) < std::tolower(y);
+        });
+    }
+};
+
+using HeaderMap = std::map<std::string, std::string, HeaderNameLess>;
+
 // HTTP Response structure
 struct Response {
     int status_code{0};
     std::string body;
-    std::map<std::string, std::string> headers;
+    HeaderMap headers;
     bool is_error{false};
     std::string error_message;
+    bool timed_out{false};  // A Timeouts limit passed before the response completed
+    bool cancelled{false};  // Aborted by Client::cancel_all()
+};
+
+// Per-phase limits for one request; zero means no limit. In
+// Request::timeouts zero means the client default, and no_limit overrides
+// a default with no limit.
+struct Timeouts {
+    std::chrono::milliseconds connect{0};     // DNS lookup and TCP connect
+    std::chrono::milliseconds handshake{0};   // TLS handshake
+    std::chrono::milliseconds first_byte{0};  // Request fully sent until the first response byte
+    std::chrono::milliseconds idle_read{0};   // Longest gap between response reads
+    std::chrono::milliseconds total{0};       // The whole request, including queueing for a connection
+
+    static constexpr std::chrono::milliseconds no_limit{-1};
+};
+
+// Request body sent from its parts instead of held in Request::body: bytes
+// owned here, bytes borrowed from the caller (which must outlive the
+// request), and files read from disk in bounded chunks while sending. The
+// size is known up front for Content-Length; each attempt of a retried or
+// hedged request reads the parts again from the start.
+class BodyStream {
+public:
+    void append(std::string data);
+    void append_view(std::span<const char> data);
+
+    // Throws std::runtime_error when the file's size cannot be read
+    void append_file(const std::filesystem::path& path);
+
+    std::uint64_t size() const { return size_; }
+
+    // One pass over the parts
+    class Reader {
+    public:
+        explicit Reader(const BodyStream& body) : body_(body) {}
+
+        // Next piece of at most max_size bytes, empty at the end. Owned and
+        // borrowed bytes are returned in place; file bytes go through a
+        // buffer reused by the following call. Throws std::runtime_error when
+        // a file cannot be read in full.
+        std::string_view next(std::size_t max_size);
+
+    private:
+        const BodyStream& body_;
+        std::size_t part_{0};
+        std::uint64_t offset_{0};  // Within the current part
+        std::ifstream file_;
+        std::vector<char> buffer_;
+    };
+
+private:
+    struct FilePart {
+        std::filesystem::path path;
+        std::uint64_t size;
+    };
+    using Part = std::variant<std::string, std::span<const char>, FilePart>;
+
+    std::vector<Part> parts_;
+    std::uint64_t size_{0};
 };
 
 // HTTP Request structure
@@ -23,26 +97,697 @@ struct Request {
     std::string method{"GET"};
     std::string path{"/"};
     std::string host;
+    std::string port;  // Empty: 443 for HTTPS, 80 for HTTP
     std::string body;
-    std::map<std::string, std::string> headers;
+    std::shared_ptr<const BodyStream> body_stream;  // When set, sent in place of body
+    HeaderMap headers;
     bool use_ssl{true};
+    Timeouts timeouts;  // Zero fields fall back to the client's default_timeouts()
+
+    // When set, a 2xx response body is passed here piece by piece as it
+    // arrives instead of being collected in Response::body. An exception
+    // thrown here fails the request with its message.
+    std::function<void(std::string_view)> on_body_chunk;
+
+    // With on_body_chunk: called when such a body starts, before its first
+    // chunk, with its Content-Length if the server sent one. A retried
+    // request may start again.
+    std::function<void(std::optional<std::uint64_t>)> on_body_start;
+};
+
+// Bytes of a streamed body received so far, and its size when known
+using ProgressCallback = std::function<void(std::uint64_t received, std::optional<std::uint64_t> total)>;
+
+// Destination for a streamed 2xx response body. Memory use stays bounded by
+// one chunk (one line for LineSink) however large the body is.
+class BodySink {
+public:
+    virtual ~BodySink() = default;
+
+    // Route req's 2xx body here; the sink must outlive the request
+    void attach(Request& req);
+
+    void set_progress(ProgressCallback on_progress) { on_progress_ = std::move(on_progress); }
+
+    std::uint64_t received() const { return received_; }
+    std::optional<std::uint64_t> total() const { return total_; }
+
+    // Call once the request succeeded, to deliver or write out what is left
+    virtual void finish() {}
+
+protected:
+    virtual void begin() {}  // The body (re)starts; drop anything from before
+    virtual void write(std::string_view data) = 0;
+
+private:
+    ProgressCallback on_progress_;
+    std::uint64_t received_{0};
+    std::optional<std::uint64_t> total_;
+};
+
+// Each chunk as it arrives
+class ChunkSink : public BodySink {
+public:
+    explicit ChunkSink(std::function<void(std::string_view)> on_chunk) : on_chunk_(std::move(on_chunk)) {}
+
+protected:
+    void write(std::string_view data) override { on_chunk_(data); }
+
+private:
+    std::function<void(std::string_view)> on_chunk_;
+};
+
+// Each line without its terminator, e.g. the records of a JSONL file. A last
+// line without a newline is delivered by finish().
+class LineSink : public BodySink {
+public:
+    explicit LineSink(std::function<void(std::string_view)> on_line) : on_line_(std::move(on_line)) {}
+
+    void finish() override;
+
+protected:
+    void begin() override { partial_.clear(); }
+    void write(std::string_view data) override;
+
+private:
+    std::function<void(std::string_view)> on_line_;
+    std::string partial_;  // Line still waiting for its newline
+};
+
+// Written to a file, created or truncated when the body starts. Failing to
+// open or write it fails the request; finish() closes it and throws
+// std::runtime_error if that fails.
+class FileSink : public BodySink {
+public:
+    explicit FileSink(std::filesystem::path path) : path_(std::move(path)) {}
+
+    void finish() override;
+
+protected:
+    void begin() override;
+    void write(std::string_view data) override;
+
+private:
+    std::filesystem::path path_;
+    std::ofstream file_;
+};
+
+// Protocol used for HTTPS requests
+enum class HttpVersion {
+    Http1_1,  // One request at a time per pooled keep-alive connection
+    Http2,    // Offer h2 via ALPN and multiplex requests; HTTP/1.1 if the server declines
+};
+
+// Connection pool configuration (HTTP/1.1 keep-alive)
+struct PoolOptions {
+    bool keep_alive{true};                          // Reuse connections between requests
+    std::size_t max_idle_per_host{8};               // Idle connections kept per (scheme, host, port)
+    std::size_t max_connections_per_host{32};       // Connections in use per (scheme, host, port)
+    std::chrono::milliseconds idle_timeout{60000};  // Idle connections are closed after this long
+
+    // Evict idle connections from a background timer instead of only on the
+    // next checkout. The timer keeps io_context::run() busy while connections
+    // are idle, so enable it only when the context runs for the process lifetime.
+    bool background_sweep{false};
+};
+
+// DNS caching and connection racing configuration
+struct ResolverOptions {
+    std::chrono::milliseconds positive_ttl{60000};          // Successful lookups are reused this long
+    std::chrono::milliseconds negative_ttl{5000};           // Failed lookups are reported this long
+    std::chrono::milliseconds connect_attempt_delay{250};   // RFC 8305 Connection Attempt Delay
+};
+
+// Client-side pacing against the x-ratelimit-* response headers
+struct RateLimitOptions {
+    bool enabled{true};
+    std::uint64_t requests_per_minute{0};  // Limits assumed before any headers arrive; 0 = unknown
+    std::uint64_t tokens_per_minute{0};
+    std::chrono::milliseconds rate_limited_pause{1000};  // After a 429 that names no wait time
+};
+
+// Rate limiter counters (safe to read while requests are in flight)
+struct RateLimitMetrics {
+    std::atomic<std::uint64_t> admitted{0};
+    std::atomic<std::uint64_t> delayed{0};         // Admitted after waiting for budget
+    std::atomic<std::uint64_t> wait_ms{0};         // Total time spent waiting
+    std::atomic<std::uint64_t> rate_limited{0};    // 429 responses seen
+    std::atomic<std::uint64_t> header_updates{0};  // Responses that carried limit headers
+};
+
+// Automatic retries of transient failures (connection errors, 408, 429, 5xx)
+struct RetryPolicy {
+    int max_retries{2};                            // Attempts after the first; 0 disables retries
+    std::chrono::milliseconds initial_backoff{500};
+    std::chrono::milliseconds max_backoff{8000};   // Cap on the exponential backoff
+    std::chrono::milliseconds max_retry_after{60000};  // Longest server-requested wait; longer ones are not retried
+    std::chrono::milliseconds deadline{120000};    // No retry starts past this long after the first attempt
+    std::vector<int> retry_statuses{408, 409, 429, 500, 502, 503, 504};
+    bool retry_all_posts{false};  // Also retry POSTs that may not be safe to repeat
+};
+
+// Retry counters (safe to read while requests are in flight)
+struct RetryMetrics {
+    std::atomic<std::uint64_t> attempts{0};          // Requests sent, including retries
+    std::atomic<std::uint64_t> retries{0};
+    std::atomic<std::uint64_t> recovered{0};         // Calls that succeeded after retrying
+    std::atomic<std::uint64_t> exhausted{0};         // Calls that failed after max_retries retries
+    std::atomic<std::uint64_t> deadline_exceeded{0}; // Calls that stopped retrying at the deadline
+    std::atomic<std::uint64_t> backoff_ms{0};        // Total time spent waiting to retry
+};
+
+// Hedged requests: when no response has started within a latency
+// percentile of recent requests, a duplicate is sent and the first
+// complete response wins
+struct HedgeOptions {
+    double percentile{0.95};                        // Hedge requests slower than this share of recent ones
+    std::chrono::milliseconds min_delay{50};        // Never hedge sooner than this
+    std::chrono::milliseconds initial_delay{2000};  // Delay until min_samples latencies are known
+    std::size_t window{512};                        // Recent latencies the percentile is taken over
+    std::size_t min_samples{20};
+    double max_extra_load{0.05};                    // Hedges allowed per hedgeable request
+};
+
+// Hedging counters (safe to read while requests are in flight)
+struct HedgeMetrics {
+    std::atomic<std::uint64_t> requests{0};  // Hedgeable requests sent
+    std::atomic<std::uint64_t> hedges{0};    // Duplicates issued
+    std::atomic<std::uint64_t> won{0};       // Duplicates that answered first
+    std::atomic<std::uint64_t> denied{0};    // Hedges skipped to stay within max_extra_load
+};
+
+// Content coding (RFC 9110 section 8.4). Responses in gzip or deflate are
+// always decoded; these options make the client ask for them and compress
+// large request bodies.
+struct CompressionOptions {
+    bool accept_encoding{false};         // Send Accept-Encoding: gzip, deflate
+    bool compress_requests{false};       // gzip in-memory bodies of at least min_request_size
+    std::size_t min_request_size{8192};
+    int level{6};                        // zlib level: 1 (fastest) to 9 (smallest)
+};
+
+// Transport counters (safe to read while requests are in flight)
+struct Metrics {
+    std::atomic<std::uint64_t> requests{0};
+    std::atomic<std::uint64_t> connections_opened{0};
+    std::atomic<std::uint64_t> connections_reused{0};
+    std::atomic<std::uint64_t> stale_connections{0};
+    std::atomic<std::uint64_t> idle_evictions{0};
+    std::atomic<std::uint64_t> tls_full_handshakes{0};
+    std::atomic<std::uint64_t> tls_resumed_handshakes{0};
+    std::atomic<std::uint64_t> http2_sessions_opened{0};
+    std::atomic<std::uint64_t> http2_streams{0};
+    std::atomic<std::uint64_t> timeouts{0};
+    std::atomic<std::uint64_t> cancellations{0};
+
+    // Content coding; bytes saved are the raw minus the compressed counts
+    std::atomic<std::uint64_t> requests_compressed{0};
+    std::atomic<std::uint64_t> request_bytes_raw{0};
+    std::atomic<std::uint64_t> request_bytes_compressed{0};
+    std::atomic<std::uint64_t> compression_us{0};
+    std::atomic<std::uint64_t> compression_rejected{0};  // 415 answers, resent uncompressed
+    std::atomic<std::uint64_t> responses_decompressed{0};
+    std::atomic<std::uint64_t> response_bytes_compressed{0};
+    std::atomic<std::uint64_t> response_bytes_raw{0};
+    std::atomic<std::uint64_t> decompression_us{0};
+};
+
+// Client-side TLS session cache keyed by SNI host.
+// Sessions are opaque SSL_SESSION handles; each entry owns one reference.
+class TlsSessionCache {
+public:
+    explicit TlsSessionCache(std::size_t max_entries = 256) : max_entries_(max_entries) {}
+
+    // Session to offer when connecting to host (nullptr if none).
+    // TLS 1.3 tickets are single-use and are removed once taken.
+    std::shared_ptr<void> take(const std::string& host);
+
+    // Store a resumable session for host, replacing any previous one
+    void put(const std::string& host, std::shared_ptr<void> session);
+
+    void remove(const std::string& host);
+    void clear();
+    std::size_t size() const;
+
+private:
+    mutable std::mutex mutex_;
+    std::unordered_map<std::string, std::shared_ptr<void>> sessions_;
+    std::size_t max_entries_;
+};
+
+// Growable input buffer; a connection keeps one for all of its responses
+struct ReadBuffer {
+    std::string_view data() const { return {storage.data() + begin, end - begin}; }
+    std::size_t size() const { return end - begin; }
+    void consume(std::size_t count);
+
+    // Writable space for at least count bytes, compacting or growing as needed
+    asio::mutable_buffer prepare(std::size_t count);
+    void commit(std::size_t count) { end += count; }
+
+    std::vector<char> storage;
+    std::size_t begin{0};
+    std::size_t end{0};
+};
+
+// Incremental HTTP/1.1 response parser. Input is parsed in place: the status
+// line and headers are read through string_views, and body bytes are handed to
+// a callback without intermediate copies. Interim 1xx responses are skipped.
+class ResponseParser {
+public:
+    enum class State {
+        StatusLine,
+        Headers,
+        Body,          // Content-Length framed
+        ChunkSize,
+        ChunkData,
+        ChunkDataEnd,
+        Trailers,
+        BodyToEof,     // Unframed: ends when the server closes the connection
+        Done
+    };
+
+    explicit ResponseParser(bool head_request = false) : head_request_(head_request) {}
+
+    // Parse as much of input as possible, passing body bytes to on_body.
+    // Returns the number of bytes consumed; throws std::runtime_error on
+    // malformed input.
+    std::size_t parse(std::string_view input, const std::function<void(std::string_view)>& on_body);
+
+    // Body bytes the caller may read straight into its destination and report
+    // with advance_body(); 0 unless inside a framed body or chunk
+    std::size_t body_remaining() const;
+    void advance_body(std::size_t count);
+
+    // The server closed the connection; completes a read-to-EOF body
+    void finish_eof();
+
+    State state() const { return state_; }
+    bool headers_complete() const { return state_ != State::StatusLine && state_ != State::Headers; }
+    bool done() const { return state_ == State::Done; }
+
+    int status_code() const { return status_code_; }
+    std::optional<std::size_t> content_length() const { return content_length_; }
+    HeaderMap& headers() { return headers_; }
+
+    // The connection can carry another request once this response is done
+    bool reusable() const { return keep_alive_ && framed_; }
+
+private:
+    void parse_status_line(std::string_view line);
+    void parse_header_line(std::string_view line);
+    void finish_headers();
+
+    bool head_request_;
+    State state_{State::StatusLine};
+    int status_code_{0};
+    bool keep_alive_{false};
+    bool framed_{true};
+    std::optional<std::size_t> content_length_;
+    std::size_t remaining_{0};
+    std::string last_header_;  // For obsolete line folding
+    HeaderMap headers_;
 };
 
-// Coroutine-based HTTPS Client using Asio
+// A single HTTP/1.1 connection, either TLS or plain TCP
+struct Connection {
+    std::unique_ptr<asio::ssl::stream<asio::ip::tcp::socket>> tls;
+    std::unique_ptr<asio::ip::tcp::socket> tcp;
+    std::chrono::steady_clock::time_point idle_since;
+    ReadBuffer input;
+
+    asio::ip::tcp::socket& socket();
+
+    // True if the peer closed the connection or sent unsolicited data while idle
+    bool is_stale();
+    void close();
+};
+
+// One-shot event that coroutines on any executor or thread can wait for
+class Event {
+public:
+    // Wake current waiters and let later ones through immediately
+    void set();
+    bool is_set() const;
+
+    // Completes on the waiter's own executor once set() has been called
+    asio::awaitable<void> wait();
+
+private:
+    mutable std::mutex mutex_;
+    bool set_{false};
+    std::vector<std::move_only_function<void()>> waiters_;
+};
+
+// Shared DNS cache. Safe to share between clients on different executors
+// and threads.
+class ResolverCache {
+public:
+    explicit ResolverCache(ResolverOptions options = {}) : options_(options) {}
+
+    // Resolve host:port, answering from the cache while the entry is fresh.
+    // Throws asio::system_error for failed (or negatively cached) lookups.
+    asio::awaitable<std::vector<asio::ip::tcp::endpoint>> resolve(const std::string& host, const std::string& port);
+
+    // Forget host:port, e.g. after every cached address failed to connect
+    void invalidate(const std::string& host, const std::string& port);
+    void clear();
+
+    const ResolverOptions& options() const { return options_; }
+    std::uint64_t hits() const { return hits_.load(); }
+    std::uint64_t lookups() const { return lookups_.load(); }
+
+private:
+    struct Entry {
+        std::vector<asio::ip::tcp::endpoint> endpoints;
+        std::error_code error;
+        std::chrono::steady_clock::time_point expires;
+        std::shared_ptr<Event> lookup;  // Set while a lookup is in flight
+    };
+
+    ResolverOptions options_;
+    std::mutex mutex_;
+    std::unordered_map<std::string, Entry> entries_;
+    std::atomic<std::uint64_t> hits_{0};
+    std::atomic<std::uint64_t> lookups_{0};
+};
+
+// Per-model request and token buckets, refilled continuously at the
+// per-minute limits and corrected from each response's x-ratelimit-limit-*
+// and x-ratelimit-remaining-* headers. acquire() reserves budget up front
+// and sleeps off any deficit, so queued requests leave in arrival order at
+// the allowed rate; a 429 pauses the model until its reset. Buckets whose
+// limits are still unknown never delay. One instance can be shared by many
+// Clients.
+class RateLimiter {
+public:
+    explicit RateLimiter(RateLimitOptions options = {}) : options_(options) {}
+
+    // Wait until model has budget for one request of about tokens tokens
+    asio::awaitable<void> acquire(const std::string& model, std::uint64_t tokens);
+
+    // Reserve budget as acquire() does, without sleeping; returns how long
+    // the caller must wait before sending (zero when it may send now)
+    std::chrono::steady_clock::duration reserve(const std::string& model, std::uint64_t tokens);
+
+    // Finish a request admitted by acquire() or reserve() and learn from its headers
+    void release(const std::string& model, std::uint64_t tokens, const Response& response);
+
+    // Currently available (possibly negative) request and token budget
+    std::pair<double, double> available(const std::string& model);
+
+    const RateLimitOptions& options() const { return options_; }
+    const RateLimitMetrics& metrics() const { return metrics_; }
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    struct Limit {
+        double capacity{0};   // Per minute; 0 while unknown
+        double level{0};      // Budget left; negative while callers wait
+        double in_flight{0};  // Reserved by requests without a response yet
+
+        void refill(double minutes);
+        double deficit_minutes(double cost) const;
+        void take(double cost);
+        void update(std::optional<double> limit, std::optional<double> remaining);
+    };
+
+    struct Bucket {
+        Limit requests;
+        Limit tokens;
+        Clock::time_point refilled;
+        Clock::time_point blocked_until;  // Set by 429 responses
+    };
+
+    Bucket& bucket(const std::string& model, Clock::time_point now);
+
+    RateLimitOptions options_;
+    std::mutex mutex_;
+    std::unordered_map<std::string, Bucket> buckets_;
+    RateLimitMetrics metrics_;
+};
+
+// Hedging delay and budget, shared by the clients whose requests it hedges.
+// Thread-safe.
+class Hedger {
+public:
+    explicit Hedger(HedgeOptions options = {}) : options_(options) {}
+
+    // How long to wait for a response to start before hedging; counts a request
+    std::chrono::milliseconds begin();
+
+    // Claim budget for one duplicate; false when max_extra_load is used up
+    bool try_hedge();
+
+    // Finish a request: latency of the original attempt (up to when it
+    // started answering, or was abandoned) and whether the duplicate won
+    void finish(std::chrono::milliseconds latency, bool hedge_won);
+
+    const HedgeOptions& options() const { return options_; }
+    const HedgeMetrics& metrics() const { return metrics_; }
+
+private:
+    HedgeOptions options_;
+    std::mutex mutex_;
+    std::vector<std::chrono::milliseconds> samples_;  // Ring buffer of options_.window latencies
+    std::size_t next_sample_{0};
+    HedgeMetrics metrics_;
+};
+
+// Parse an x-ratelimit-reset-* duration such as "20ms", "1s" or "6m0.5s"
+std::optional<std::chrono::milliseconds> parse_reset_duration(std::string_view text);
+
+// Wait requested by a response's retry-after-ms or Retry-After (seconds) header
+std::optional<std::chrono::milliseconds> retry_after(const Response& response);
+
+// Pool of idle keep-alive connections keyed by (scheme, host, port)
+class ConnectionPool {
+public:
+    ConnectionPool(asio::any_io_executor executor, PoolOptions options, Metrics& metrics);
+    ~ConnectionPool();
+
+    ConnectionPool(const ConnectionPool&) = delete;
+    ConnectionPool& operator=(const ConnectionPool&) = delete;
+
+    // Wait until a connection slot for key is free and claim it. Throws once
+    // abandoned() returns true (checked whenever a slot is released).
+    asio::awaitable<void> acquire_slot(const std::string& key, const std::function<bool()>& abandoned = {});
+
+    // Make waiters in acquire_slot() re-check abandoned()
+    void wake_waiters();
+
+    // Give a claimed slot back without returning a connection
+    void release_slot(const std::string& key);
+
+    // Take the most recently used live idle connection, or nullptr
+    std::unique_ptr<Connection> take_idle(const std::string& key);
+
+    // Return a reusable connection and its slot to the pool
+    void put_idle(const std::string& key, std::unique_ptr<Connection> connection);
+
+    // Close all idle connections
+    void clear();
+
+    std::size_t idle_count() const;
+    const PoolOptions& options() const { return options_; }
+
+private:
+    struct HostPool {
+        std::deque<std::unique_ptr<Connection>> idle;
+        std::size_t active{0};
+        std::unique_ptr<asio::steady_timer> slot_freed;
+    };
+
+    // State shared with the idle eviction sweeper, which may outlive a pool call
+    struct State {
+        explicit State(asio::any_io_executor executor) : sweep_timer(executor) {}
+
+        std::unordered_map<std::string, HostPool> hosts;
+        asio::steady_timer sweep_timer;
+        bool sweeping{false};
+        bool closed{false};
+    };
+
+    void start_sweeper();
+    static asio::awaitable<void> sweep_idle(std::shared_ptr<State> state, PoolOptions options, Metrics* metrics);
+
+    asio::any_io_executor executor_;
+    PoolOptions options_;
+    Metrics& metrics_;
+    std::shared_ptr<State> state_;
+};
+
+// One Server-Sent Events message
+struct SseEvent {
+    std::string event;  // Empty for the default "message" type
+    std::string data;   // data: lines joined with '\n'
+    std::string id;     // Last event ID seen on the stream
+};
+
+// Incremental text/event-stream decoder. Feed body bytes as they arrive;
+// lines may be split anywhere and end in LF, CRLF or CR.
+class SseParser {
+public:
+    explicit SseParser(std::function<void(const SseEvent&)> on_event) : on_event_(std::move(on_event)) {}
+
+    void feed(std::string_view bytes);
+
+private:
+    void process_line(std::string_view line);
+
+    std::function<void(const SseEvent&)> on_event_;
+    std::string line_;      // Incomplete line carried over from the previous feed
+    SseEvent event_;
+    bool has_data_{false};
+    bool skip_lf_{false};   // Previous feed ended in CR; a leading LF completes CRLF
+};
+
+// Incremental decoder of a gzip or deflate Content-Encoding. Deflate
+// bodies may be zlib-wrapped (RFC 1950) or, as some servers send them, raw
+// (RFC 1951). Throws std::runtime_error on corrupt input.
+class ContentDecoder {
+public:
+    // Decoder for a Content-Encoding value; nullptr for identity, a coding
+    // this client does not decode, or a list of several codings
+    static std::unique_ptr<ContentDecoder> create(std::string_view encoding);
+
+    explicit ContentDecoder(bool gzip);
+    ~ContentDecoder();
+
+    ContentDecoder(const ContentDecoder&) = delete;
+    ContentDecoder& operator=(const ContentDecoder&) = delete;
+
+    // Decode input, passing decoded bytes to on_output as they are produced
+    void feed(std::string_view input, const std::function<void(std::string_view)>& on_output);
+
+    // The body ended; throws std::runtime_error if the stream is incomplete
+    void finish();
+
+    std::uint64_t bytes_in() const { return bytes_in_; }
+    std::uint64_t bytes_out() const { return bytes_out_; }
+    std::chrono::microseconds busy() const { return std::chrono::duration_cast<std::chrono::microseconds>(busy_); }
+
+private:
+    struct State;
+
+    std::unique_ptr<State> state_;
+    std::uint64_t bytes_in_{0};
+    std::uint64_t bytes_out_{0};
+    std::chrono::nanoseconds busy_{0};
+};
+
+// gzip-compress input at zlib level (1-9). Throws std::runtime_error on failure.
+std::string gzip_compress(std::string_view input, int level = 6);
+
+// Coroutine-based HTTPS Client using Asio. Connection state lives on a
+// strand, so the io_context may be run by any number of threads and requests
+// may be awaited from any executor. Configure the client before sending.
 class Client {
 public:
-    explicit Client(asio::io_context& io_context);
+    explicit Client(asio::io_context& io_context, PoolOptions pool_options = {});
+    ~Client();
 
+    // Send req. Failures, including timeouts and cancellation, are reported
+    // in the Response. Cancelling the awaiting coroutine (e.g. through
+    // asio::experimental::awaitable_operators) abandons the request and
+    // closes its connection.
     asio::awaitable<Response> async_request(const Request& req);
+
+    // Blocking send for threads outside the io_context: the request runs on
+    // the client's strand while this thread waits. Another thread must be
+    // running the io_context; throws std::logic_error when called from one
+    // that is.
     Response request(const Request& req);
 
+    // Strand the client's I/O runs on; on_body_chunk callbacks are invoked here
+    asio::any_io_executor executor() const { return strand_; }
+    asio::io_context& io_context() const { return io_context_; }
+
+    // Send req, and a duplicate on another connection or stream if no
+    // response has started within hedger's delay. The first complete response
+    // wins and the other attempt is abandoned. Only use this for requests
+    // that are safe to send twice; streamed requests are never hedged.
+    asio::awaitable<Response> async_hedged_request(const Request& req, std::shared_ptr<Hedger> hedger);
+
+    // Limits for requests that leave Request::timeouts fields at zero
+    void set_default_timeouts(Timeouts timeouts) { default_timeouts_ = timeouts; }
+    const Timeouts& default_timeouts() const { return default_timeouts_; }
+
+    // Abort every request in flight; each completes with Response::cancelled.
+    // Requests started afterwards are unaffected. Callable from any thread.
+    void cancel_all();
+
+    // Incremented by cancel_all(), so callers can tell a cancellation happened
+    // while they were between requests (e.g. waiting to retry)
+    std::uint64_t cancel_generation() const { return cancel_generation_.load(); }
+
+    const Metrics& metrics() const { return metrics_; }
+
+    // Only touch the pool from executor()
+    ConnectionPool& pool() { return pool_; }
+    TlsSessionCache& session_cache() { return session_cache_; }
+
+    // Share a DNS cache between clients (each client starts with its own)
+    void set_resolver_cache(std::shared_ptr<ResolverCache> cache) { resolver_cache_ = std::move(cache); }
+    const std::shared_ptr<ResolverCache>& resolver_cache() const { return resolver_cache_; }
+
+    // Select the protocol for HTTPS requests made from now on.
+    // Open HTTP/2 sessions keep reading frames, so io_context::run() does not
+    // return until close_http2_sessions() (callable from any thread) is called
+    // or the client is destroyed.
+    void set_http_version(HttpVersion version);
+    HttpVersion http_version() const { return http_version_; }
+    void close_http2_sessions();
+
+    // Content coding for requests made from now on. A host that answers a
+    // compressed request with 415 gets it again uncompressed, and no
+    // compressed requests after that.
+    void set_compression(CompressionOptions options) { compression_ = options; }
+    const CompressionOptions& compression() const { return compression_; }
+
 private:
-    asio::awaitable<Response> async_https_request(const Request& req);
-    asio::awaitable<Response> async_http_request(const Request& req);
+    // Deadline and abort hook of one request in flight (defined in the implementation)
+    class Watch;
+
+    // Attempts of one hedged request
+    struct HedgeRace;
+
+    // Request paths; these run on strand_
+    asio::awaitable<Response> send(const Request& req);
+    asio::awaitable<Response> send_hedged(const Request& req, std::shared_ptr<Hedger> hedger);
+    asio::awaitable<Response> dispatch(const Request& req, Watch& watch);
+    asio::awaitable<void> hedge_attempt(std::shared_ptr<HedgeRace> race, int index);
+
+    struct Http2Host {
+        std::shared_ptr<http2::Session> session;
+        std::shared_ptr<asio::steady_timer> connecting;  // Set while a connection is being opened
+        bool http1_only{false};                          // Server did not select h2 via ALPN
+    };
+
+    asio::awaitable<Response> async_http2_request(const Request& req, Watch& watch);
+    asio::awaitable<std::shared_ptr<http2::Session>> http2_session(const Request& req, const std::string& key, Watch& watch);
+    asio::awaitable<Response> async_pooled_request(const Request& req, Watch& watch);
+    asio::awaitable<std::unique_ptr<Connection>> open_connection(const Request& req, Watch& watch);
     std::string build_request_string(const Request& req) const;
 
+    // Copy of req with its body gzip-compressed, when compression_ applies
+    std::optional<Request> compressed_request(const Request& req);
+
     asio::io_context& io_context_;
+    asio::strand<asio::io_context::executor_type> strand_;
     asio::ssl::context ssl_context_;
+    TlsSessionCache session_cache_;
+    std::shared_ptr<ResolverCache> resolver_cache_;
+    Metrics metrics_;
+    ConnectionPool pool_;
+    HttpVersion http_version_{HttpVersion::Http1_1};
+    std::unordered_map<std::string, Http2Host> http2_hosts_;
+    CompressionOptions compression_;
+    std::unordered_set<std::string> uncompressed_hosts_;  // Answered a compressed body with 415
+    Timeouts default_timeouts_{std::chrono::seconds(10), std::chrono::seconds(10)};
+    std::unordered_set<Watch*> watches_;
+    std::atomic<std::uint64_t> cancel_generation_{0};
 };
 
 } // namespace openai::http
@@ -5,13 +5,19 @@ export module openai.types;
 
 // Re-export all type sub-modules
 export import openai.types.common;
+export import openai.types.json;
 export import openai.types.chat;
 export import openai.types.completion;
 export import openai.types.model;
 export import openai.types.image;
 export import openai.types.embedding;
+export import openai.types.embedding_matrix;
+export import openai.types.embedding_index;
+export import openai.types.embedding_cache;
+export import openai.types.response_cache;
 export import openai.types.file;
 export import openai.types.fine_tuning;
+export import openai.types.batch;
 export import openai.types.audio;
 export import openai.types.moderation;
 export import openai.types.assistant;
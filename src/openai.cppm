@@ -7,24 +7,25 @@
 //   #include <asio.hpp>
 //
 //   int main() {
-//       asio::io_context io_context;
-//       openai::Client client("your-api-key", io_context);
+//       openai::SyncClient client("your-api-key");
 //       
 //       openai::ChatCompletionRequest req;
 //       req.model = "gpt-3.5-turbo";
 //       req.messages.push_back({openai::MessageRole::User, "Hello!"});
 //       
-//       auto response = client.create_chat_completion_sync(req);
+//       auto response = client.create_chat_completion(req);
 //   }
 
 export module openai;
 
 // Re-export all sub-modules
 export import openai.http_client;
+export import openai.http2;
 export import openai.types;
 
 // Import the new modular client architecture
 export import openai.client.unified;
+export import openai.client.sync;
 
 // Re-export commonly used namespaces
 export namespace openai {